@@ -0,0 +1,55 @@
+#pragma once  // 防止头文件重复包含
+#include <chrono>    // 时间和计时支持
+#include <cstdio>    // 格式化输出
+#include <cstdint>   // 定宽整数类型
+
+namespace valve {  // 阀门控制系统命名空间
+namespace bench {  // 基准测试辅助工具
+
+/**
+ * 防止编译器优化掉基准测试结果
+ * @param value 需要保留的计算结果
+ */
+template <typename T>
+inline void keep(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+/**
+ * 重复执行给定操作并返回单次平均耗时
+ * @param iterations 重复次数
+ * @param op 被测操作
+ * @return 单次操作平均耗时(纳秒)
+ */
+template <typename Op>
+inline double measureNs(std::size_t iterations, Op&& op) {
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        op();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+}
+
+/**
+ * 输出一行基准测试结果
+ * @param name 测试项名称
+ * @param ns 单次耗时(纳秒)
+ */
+inline void report(const char* name, double ns) {
+    if (ns >= 1e6) {
+        std::printf("%-40s %12.3f ms\n", name, ns / 1e6);
+    } else if (ns >= 1e3) {
+        std::printf("%-40s %12.3f us\n", name, ns / 1e3);
+    } else {
+        std::printf("%-40s %12.3f ns\n", name, ns);
+    }
+}
+
+} // namespace bench
+} // namespace valve
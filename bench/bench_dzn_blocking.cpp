@@ -0,0 +1,122 @@
+#include <dzn/locator.hh>  // 包含Dezyne服务定位器定义
+#include <dzn/pump.hh>     // 包含Dezyne事件泵定义
+#include <dzn/runtime.hh>  // 包含Dezyne运行时定义
+#include "bench_common.h"  // 基准测试辅助工具
+#include <chrono>          // 时间和计时支持
+#include <memory>          // 智能指针支持
+#include <vector>          // 动态数组支持
+
+namespace {
+
+constexpr std::size_t kEvents = 200000;   // 阻塞状态下处理的事件数
+constexpr std::size_t kCycles = 20000;    // 阻塞状态下的阻塞/释放次数
+constexpr std::size_t kDeferred = 20000;  // 一次积压的延迟事件数
+
+/**
+ * 含若干阻塞协程的系统：每个组件在自己的端口上阻塞一次，
+ * 事件泵上同时存活blocked + 1个协程
+ */
+class BlockedSystem {
+public:
+    explicit BlockedSystem(std::size_t blocked) : components_(blocked + 1), ports_(blocked + 1) {
+        locator_.set(runtime_).set(pump_);
+        for (std::size_t i = 0; i < blocked; ++i) {
+            pump_([this, i] { dzn::port_block(locator_, &components_[i], &ports_[i]); });
+        }
+        dzn::shell(pump_, [] {});
+    }
+
+    ~BlockedSystem() {
+        for (std::size_t i = 0; i + 1 < components_.size(); ++i) {
+            pump_([this, i] { dzn::port_release(locator_, &components_[i], &ports_[i]); });
+        }
+        dzn::shell(pump_, [] {});
+    }
+
+    /**
+     * 生成代码中入事件对运行时的访问：活动标记与当前协程编号
+     * @return 单个事件平均耗时(纳秒)
+     */
+    double events() {
+        std::size_t sum = 0;
+        return elapsed(kEvents, [&] {
+            for (std::size_t i = 0; i < kEvents; ++i) {
+                pump_([this, &sum] {
+                    dzn::scoped_activity activity(runtime_, locator_, 1);
+                    sum += dzn::coroutine_id(locator_);
+                });
+            }
+        });
+    }
+
+    /**
+     * 空闲组件在端口上阻塞后由下一个事件释放：新建协程并两次切换
+     * @return 单次阻塞/释放平均耗时(纳秒)
+     */
+    double cycles() {
+        dzn::component* component = &components_.back();
+        int* port = &ports_.back();
+        return elapsed(kCycles, [&] {
+            for (std::size_t i = 0; i < kCycles; ++i) {
+                pump_([this, component, port] { dzn::port_block(locator_, component, port); });
+                pump_([this, component, port] { dzn::port_release(locator_, component, port); });
+            }
+        });
+    }
+
+    /**
+     * 一个事件积压kDeferred个延迟事件，事件泵逐个取出执行
+     * @return 单个延迟事件平均耗时(纳秒)
+     */
+    double deferred() {
+        std::size_t executed = 0;
+        return elapsed(kDeferred, [&] {
+            pump_([this, &executed] {
+                for (std::size_t i = 0; i < kDeferred; ++i) {
+                    dzn::defer(locator_, [] { return true; }, [&executed](std::size_t) { ++executed; });
+                }
+            });
+        });
+    }
+
+private:
+    /**
+     * 投递事件后等待事件泵处理完，返回单次平均耗时
+     */
+    template <typename Post>
+    double elapsed(std::size_t count, Post&& post) {
+        auto start = std::chrono::steady_clock::now();
+        post();
+        pump_.wait();
+        dzn::shell(pump_, [] {});
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+    }
+
+    dzn::locator locator_;
+    dzn::runtime runtime_;
+    std::vector<dzn::component> components_;
+    std::vector<int> ports_;
+    dzn::pump pump_;
+};
+
+} // namespace
+
+/**
+ * Dezyne阻塞密集模型基准测试
+ * 在事件泵上同时存活不同数量的阻塞协程，测量入事件、阻塞/释放与延迟事件的单次耗时；
+ * 协程簿记为稠密结构时，这些耗时应不随阻塞协程数增长
+ */
+int main() {
+    for (std::size_t blocked : {0, 100, 1000}) {
+        auto system = std::make_unique<BlockedSystem>(blocked);
+        char line[64];
+        std::printf("%zu blocked coroutines\n", blocked);
+        std::snprintf(line, sizeof line, "  event");
+        valve::bench::report(line, system->events());
+        std::snprintf(line, sizeof line, "  block/release cycle");
+        valve::bench::report(line, system->cycles());
+        std::snprintf(line, sizeof line, "  deferred event (%zu pending)", kDeferred);
+        valve::bench::report(line, system->deferred());
+    }
+    return 0;
+}
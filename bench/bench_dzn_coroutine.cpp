@@ -0,0 +1,92 @@
+#include <dzn/coroutine.hh>  // 包含Dezyne协程定义
+#include <dzn/locator.hh>    // 包含Dezyne服务定位器定义
+#include <dzn/pump.hh>       // 包含Dezyne事件泵定义
+#include <dzn/runtime.hh>    // 包含Dezyne运行时定义
+#include "bench_common.h"    // 基准测试辅助工具
+
+namespace {
+
+#if DZN_NATIVE_CONTEXT
+constexpr std::size_t kRounds = 1000000;  // 往返次数
+constexpr std::size_t kBlocks = 20000;    // 阻塞/释放次数
+const char* const kBackend = "native";
+#else
+constexpr std::size_t kRounds = 20000;    // 线程交接很慢，减少次数
+constexpr std::size_t kBlocks = 2000;
+const char* const kBackend = "threads";
+#endif
+
+} // namespace
+
+/**
+ * Dezyne协程切换基准测试
+ * coroutine::call进入协程再由协程yield_to回到调用者为一次调用往返；
+ * 两个协程互相yield_to为一次切换往返；
+ * 经事件泵的一次端口阻塞与释放包含新建协程和两次切换
+ * 同一源文件分别以原生上下文和线程交接编译，便于对比
+ */
+int main() {
+    using valve::bench::measureNs;
+    using valve::bench::report;
+
+    std::printf("dzn::context backend: %s\n", kBackend);
+
+    // 调用往返
+    {
+        dzn::coroutine zero;
+        dzn::coroutine callee(1, [&] {
+            for (;;) callee.yield_to(zero);
+        });
+        callee.call(zero);  // 预热，首次进入协程
+        report("coroutine::call round trip", measureNs(kRounds, [&] { callee.call(zero); }));
+    }
+
+    // 协程之间的切换往返
+    {
+        dzn::coroutine zero;
+        std::size_t remaining = 0;
+        dzn::coroutine* pong = nullptr;
+        dzn::coroutine ping(1, [&] {
+            for (;;) {
+                while (remaining) {
+                    --remaining;
+                    ping.yield_to(*pong);
+                }
+                ping.yield_to(zero);
+            }
+        });
+        dzn::coroutine pongRoutine(2, [&] {
+            for (;;) pongRoutine.yield_to(ping);
+        });
+        pong = &pongRoutine;
+        remaining = 1;
+        ping.call(zero);  // 预热，两个协程都已进入
+        auto start = std::chrono::steady_clock::now();
+        remaining = kRounds;
+        ping.call(zero);
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        report("coroutine::yield_to round trip", ns / kRounds);
+    }
+
+    // 经事件泵的端口阻塞与释放
+    {
+        dzn::locator locator;
+        dzn::runtime runtime;
+        dzn::component component;
+        int port = 0;
+        dzn::pump pump;
+        locator.set(runtime).set(pump);
+        auto cycle = [&] {
+            pump([&] { dzn::port_block(locator, &component, &port); });
+            pump([&] { dzn::port_release(locator, &component, &port); });
+        };
+        for (std::size_t i = 0; i < 100; ++i) cycle();  // 预热
+        dzn::shell(pump, [] {});
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < kBlocks; ++i) cycle();
+        dzn::shell(pump, [] {});
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        report("pump block/release cycle", ns / kBlocks);
+    }
+    return 0;
+}
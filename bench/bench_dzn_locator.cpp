@@ -0,0 +1,158 @@
+#include <dzn/locator.hh>  // 包含Dezyne服务定位器定义
+#include "bench_common.h"  // 基准测试辅助工具
+#include <map>             // 有序映射支持
+#include <string>          // 字符串支持
+#include <vector>          // 动态数组支持
+
+namespace {
+
+constexpr std::size_t kShellEvery = 16;      // 每多少个组件中有一个外壳(克隆定位器并设置自己的运行时与事件泵)
+constexpr std::size_t kLookups = 10000000;   // 事件路径查找次数
+constexpr std::size_t kNamed = 64;           // 具名服务数
+
+// 生成代码中常见的服务类型
+struct Runtime { int id; };
+struct Pump { int id; };
+
+/**
+ * 有序映射基线
+ * 与原定位器相同：以(键字符串, 类型)为键的std::map，每次查找构造键字符串并沿树比较type_info
+ */
+class MapLocator {
+public:
+    MapLocator() {
+        static dzn::illegal_handler ih;
+        set(std::clog).set(ih);
+    }
+
+    MapLocator clone() const { return *this; }
+
+    template <typename T>
+    MapLocator& set(T& t, const std::string& key = std::string()) {
+        services_[std::make_pair(key, TypeInfo(typeid(T)))] = &t;
+        return *this;
+    }
+
+    template <typename T>
+    T* try_get(const std::string& key = std::string()) const {
+        auto it = services_.find(std::make_pair(key, TypeInfo(typeid(T))));
+        if (it != services_.end() && it->second) {
+            return reinterpret_cast<T*>(const_cast<void*>(it->second));
+        }
+        return nullptr;
+    }
+
+    template <typename T>
+    T& get(const std::string& key = std::string()) const {
+        if (T* t = try_get<T>(key)) {
+            return *t;
+        }
+        throw std::runtime_error("not available");
+    }
+
+private:
+    struct TypeInfo {
+        const std::type_info* type;
+        TypeInfo(const std::type_info& t) : type(&t) {}
+        bool operator<(const TypeInfo& that) const { return type->before(*that.type); }
+    };
+    std::map<std::pair<std::string, TypeInfo>, const void*> services_;
+};
+
+/**
+ * 模拟生成代码构造含components个组件的系统：
+ * 每个组件取运行时与非法处理器，每kShellEvery个组件有一个外壳克隆定位器并设置自己的运行时与事件泵
+ * @return 单个组件的平均构造耗时(纳秒)
+ */
+template <typename Locator>
+double construct(std::size_t components) {
+    Runtime runtime{0};
+    Pump pump{0};
+    std::size_t shells = components / kShellEvery;
+    std::vector<Runtime> runtimes(shells);
+    std::vector<Pump> pumps(shells);
+    std::vector<Locator> locators;
+    locators.reserve(shells);
+    std::size_t sum = 0;
+    double ns = valve::bench::measureNs(1, [&] {
+        Locator root;
+        root.set(runtime).set(pump);
+        for (std::size_t i = 0; i < components; ++i) {
+            const Locator* locator = &root;
+            if (i % kShellEvery == 0 && i / kShellEvery < shells) {
+                std::size_t s = i / kShellEvery;
+                locators.push_back(root.clone());
+                locators.back().set(runtimes[s]).set(pumps[s]);
+                locator = &locators.back();
+            }
+            sum += locator->template get<Runtime>().id;
+            valve::bench::keep(locator->template get<dzn::illegal_handler>());
+        }
+    });
+    valve::bench::keep(sum);
+    return ns / components;
+}
+
+/**
+ * 模拟事件路径：查找事件泵(可能缺失)与运行时
+ * @return 单次查找平均耗时(纳秒)
+ */
+template <typename Locator>
+double lookup() {
+    Runtime runtime{1};
+    Locator locator;
+    locator.set(runtime);
+    std::size_t sum = 0;
+    double ns = valve::bench::measureNs(kLookups / 2, [&] {
+        if (locator.template try_get<Pump>()) {
+            ++sum;
+        }
+        sum += locator.template get<Runtime>().id;
+    });
+    valve::bench::keep(sum);
+    return ns / 2;
+}
+
+/**
+ * 具名服务查找：kNamed个同类型服务按名称查找
+ * @return 单次查找平均耗时(纳秒)
+ */
+template <typename Locator>
+double named() {
+    std::vector<Runtime> runtimes(kNamed);
+    std::vector<std::string> keys(kNamed);
+    Locator locator;
+    for (std::size_t i = 0; i < kNamed; ++i) {
+        runtimes[i].id = static_cast<int>(i);
+        keys[i] = "service." + std::to_string(i);
+        locator.set(runtimes[i], keys[i]);
+    }
+    std::size_t sum = 0;
+    std::size_t i = 0;
+    double ns = valve::bench::measureNs(kLookups / 4, [&] {
+        sum += locator.template get<Runtime>(keys[i++ % kNamed]).id;
+    });
+    valve::bench::keep(sum);
+    return ns;
+}
+
+} // namespace
+
+/**
+ * Dezyne服务定位器基准测试
+ * 比较有序映射与按类型槽位/哈希表查找的定位器在系统构造、事件路径查找和具名查找上的耗时
+ */
+int main() {
+    for (std::size_t components : {1000, 10000, 100000}) {
+        char line[64];
+        std::snprintf(line, sizeof line, "std::map construct (%zu)", components);
+        valve::bench::report(line, construct<MapLocator>(components));
+        std::snprintf(line, sizeof line, "locator construct (%zu)", components);
+        valve::bench::report(line, construct<dzn::locator>(components));
+    }
+    valve::bench::report("std::map event lookup", lookup<MapLocator>());
+    valve::bench::report("locator event lookup", lookup<dzn::locator>());
+    valve::bench::report("std::map named lookup", named<MapLocator>());
+    valve::bench::report("locator named lookup", named<dzn::locator>());
+    return 0;
+}
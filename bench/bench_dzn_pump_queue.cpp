@@ -0,0 +1,126 @@
+#include <dzn/pump.hh>       // 包含Dezyne事件泵定义
+#include "bench_common.h"    // 基准测试辅助工具
+#include <condition_variable>  // 条件变量支持
+#include <mutex>               // 互斥锁支持
+#include <queue>               // 队列支持
+#include <thread>              // 线程支持
+#include <vector>              // 动态数组支持
+
+namespace {
+
+constexpr std::size_t kEvents = 400000;  // 每轮投递的事件总数
+
+/**
+ * 互斥锁队列基线
+ * 与原事件泵相同：每次投递加锁入队并通知条件变量，单个消费线程逐个取出执行
+ */
+class LockedQueue {
+public:
+    LockedQueue() : consumer_([this] { run(); }) {}
+    ~LockedQueue() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        condition_.notify_one();
+        consumer_.join();
+    }
+
+    void post(std::function<void()>&& event) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push(std::move(event));
+        condition_.notify_one();
+    }
+
+    /**
+     * 等待队列中的事件全部执行完
+     */
+    void flush() {
+        std::promise<void> done;
+        post([&] { done.set_value(); });
+        done.get_future().wait();
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (running_ || !queue_.empty()) {
+            condition_.wait(lock, [this] { return !queue_.empty() || !running_; });
+            while (!queue_.empty()) {
+                std::function<void()> f(std::move(queue_.front()));
+                queue_.pop();
+                lock.unlock();
+                f();
+                lock.lock();
+            }
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::queue<std::function<void()>> queue_;
+    bool running_ = true;
+    std::thread consumer_;
+};
+
+/**
+ * 吞吐量(百万事件每秒)
+ */
+struct Rate {
+    double posted;    // 生产线程全部投递完
+    double executed;  // 事件全部执行完
+};
+
+/**
+ * 多个生产线程同时投递kEvents个事件，分别计算投递完和执行完时的吞吐量
+ */
+template <typename Post, typename Flush>
+Rate throughput(std::size_t producers, Post&& post, Flush&& flush) {
+    const std::size_t perProducer = kEvents / producers;
+    const double events = static_cast<double>(perProducer * producers);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (std::size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&] {
+            for (std::size_t i = 0; i < perProducer; ++i) post();
+        });
+    }
+    for (auto& t : threads) t.join();
+    double posted = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    flush();
+    double executed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return Rate{events / posted / 1e6, events / executed / 1e6};
+}
+
+} // namespace
+
+/**
+ * Dezyne事件泵投递基准测试
+ * 1到8个生产线程向同一个事件泵投递空事件，对比无锁队列的事件泵与互斥锁队列基线；
+ * 结果受机器核数限制，单核机器上只能看出每次投递的固定开销
+ */
+int main() {
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+    std::printf("Mevents/s      %18s %18s\n", "pump posted/done", "locked posted/done");
+    for (std::size_t producers : {1, 2, 4, 8}) {
+        std::atomic<std::uint64_t> executed{0};
+        Rate pumpRate;
+        {
+            dzn::pump pump;
+            pumpRate = throughput(
+                producers, [&] { pump([&executed] { executed.fetch_add(1, std::memory_order_relaxed); }); },
+                [&] { dzn::shell(pump, [] {}); });
+        }
+        Rate lockedRate;
+        {
+            LockedQueue locked;
+            lockedRate = throughput(
+                producers, [&] { locked.post([&executed] { executed.fetch_add(1, std::memory_order_relaxed); }); },
+                [&] { locked.flush(); });
+        }
+        std::printf("%zu producer(s) %10.2f / %5.2f %10.2f / %5.2f\n", producers, pumpRate.posted, pumpRate.executed,
+                    lockedRate.posted, lockedRate.executed);
+        valve::bench::keep(executed.load());
+    }
+    return 0;
+}
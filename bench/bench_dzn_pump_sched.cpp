@@ -0,0 +1,159 @@
+#include <dzn/pump.hh>         // 包含Dezyne事件泵定义
+#include <dzn/thread-pool.hh>  // 包含Dezyne线程池定义
+#include "bench_common.h"     // 基准测试辅助工具
+#include <algorithm>          // std::max支持
+#include <atomic>             // 原子变量支持
+#include <chrono>             // 时间和计时支持
+#include <cstdlib>            // std::_Exit支持
+#include <fstream>            // 读取/proc文件
+#include <functional>         // std::function支持
+#include <memory>             // 智能指针支持
+#include <string>             // 字符串支持
+#include <thread>             // 线程支持
+#include <vector>             // 动态数组支持
+
+namespace {
+
+constexpr std::size_t kPumps = 1000;      // 事件泵(外壳)数
+constexpr std::size_t kRounds = 10;       // 每个事件泵的同步往返次数
+constexpr std::size_t kEvents = 200;      // 每个事件泵投递的异步事件数
+
+using Executor = std::function<void(dzn::task<void()>&&)>;
+
+/**
+ * 当前进程的线程数，读取/proc/self/status；不可读时返回0
+ */
+std::size_t processThreads() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 8, "Threads:") == 0) {
+            return std::stoul(line.substr(8));
+        }
+    }
+    return 0;
+}
+
+/**
+ * 等待已执行计数到达目标值
+ */
+void await(const std::atomic<std::size_t>& counter, std::size_t target) {
+    while (counter.load() < target) {
+        std::this_thread::yield();
+    }
+}
+
+/**
+ * 创建kPumps个事件泵，测量创建、同步往返、异步吞吐与停止耗时；
+ * executor为空时每个事件泵独占一个线程
+ */
+void run(const char* name, const Executor& executor) {
+    std::printf("%s\n", name);
+    std::size_t before = processThreads();
+    std::vector<std::unique_ptr<dzn::pump>> pumps;
+    pumps.reserve(kPumps);
+
+    valve::bench::report("  create pump", valve::bench::measureNs(1, [&] {
+        for (std::size_t i = 0; i < kPumps; ++i) {
+            pumps.emplace_back(executor ? new dzn::pump(executor) : new dzn::pump);
+        }
+    }) / kPumps);
+
+    // 同步往返：逐个事件泵执行shell并等待返回
+    std::size_t sum = 0;
+    valve::bench::report("  shell round trip", valve::bench::measureNs(1, [&] {
+        for (std::size_t r = 0; r < kRounds; ++r) {
+            for (auto& p : pumps) {
+                sum += dzn::shell(*p, [r] { return r; });
+            }
+        }
+    }) / (kRounds * kPumps));
+    valve::bench::keep(sum);
+    std::printf("%-40s %12zu\n", "  threads after shells", processThreads() - before);
+
+    // 异步吞吐：向全部事件泵交错投递事件，等待全部执行完
+    std::atomic<std::size_t> executed{0};
+    double ns = valve::bench::measureNs(1, [&] {
+        for (std::size_t e = 0; e < kEvents; ++e) {
+            for (auto& p : pumps) {
+                (*p)([&executed] { ++executed; });
+            }
+        }
+        await(executed, kEvents * kPumps);
+    });
+    valve::bench::report("  posted event", ns / (kEvents * kPumps));
+    std::printf("%-40s %12.3f M/s\n", "  event throughput", kEvents * kPumps / ns * 1e3);
+
+    valve::bench::report("  stop pump", valve::bench::measureNs(1, [&] {
+        pumps.clear();
+    }) / kPumps);
+}
+
+/**
+ * 检查独占线程的事件泵数超过std_async线程池上限时仍能全部运行
+ * 以thread-pool.cc构建时，事件泵和线程交接上下文若占用池中线程，
+ * 超出上限的事件泵永远得不到线程，shell会一直等待；超时即判定失败
+ */
+bool checkMorePumpsThanLimit() {
+    constexpr std::size_t kCount = DZN_THREAD_POOL_LIMIT + 2;
+    std::atomic<bool> finished{false};
+    std::thread watchdog([&finished] {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (!finished.load() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        if (!finished.load()) {
+            std::printf("FAILED: %zu dedicated pumps with pool limit %d did not all run\n", kCount,
+                        DZN_THREAD_POOL_LIMIT);
+            std::_Exit(1);  // 事件泵线程卡住，无法正常析构
+        }
+    });
+    std::size_t sum = 0;
+    {
+        std::vector<std::unique_ptr<dzn::pump>> pumps;
+        for (std::size_t i = 0; i < kCount; ++i) {
+            pumps.emplace_back(new dzn::pump);
+        }
+        for (auto& p : pumps) {
+            sum += dzn::shell(*p, [] { return std::size_t(1); });
+        }
+    }
+    finished = true;
+    watchdog.join();
+    std::printf("%zu dedicated pumps, pool limit %d: %s\n", kCount, DZN_THREAD_POOL_LIMIT,
+                sum == kCount ? "all ran" : "missing");
+    return sum == kCount;
+}
+
+} // namespace
+
+/**
+ * Dezyne事件泵调度基准测试
+ * 比较kPumps个事件泵独占线程与共享CPU数线程池(M:N调度)时的
+ * 线程数、创建与停止耗时、同步往返延迟和异步事件吞吐
+ */
+int main() {
+    std::size_t workers = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("%zu pumps, %zu shell rounds, %zu events per pump, %zu workers\n",
+                kPumps, kRounds, kEvents, workers);
+
+    run("dedicated thread per pump", nullptr);
+
+    int failures = 0;
+    {
+        dzn::thread::pool pool(workers);
+        run("scheduled on thread::pool", [&pool](dzn::task<void()>&& work) { pool.async(std::move(work)); });
+        dzn::thread::metrics m = pool.metrics();
+        std::printf("  pool threads %zu, idle %zu, queued %zu, executed %zu, steals %zu\n",
+                    m.threads, m.idle, m.queued, m.executed, m.steals);
+        if (m.threads > workers) {
+            ++failures;
+        }
+    }
+
+    if (failures) {
+        std::printf("FAILED: pool exceeded its thread limit\n");
+        return 1;
+    }
+    return checkMorePumpsThanLimit() ? 0 : 1;
+}
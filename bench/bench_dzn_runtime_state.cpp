@@ -0,0 +1,109 @@
+#include <dzn/runtime.hh>  // 包含Dezyne运行时定义
+#include "bench_common.h"  // 基准测试辅助工具
+#include <map>             // 有序映射支持
+#include <random>          // 随机数支持
+#include <vector>          // 动态数组支持
+
+namespace {
+
+constexpr std::size_t kEvents = 2000000;  // 每种系统规模下处理的事件数
+
+// 生成的组件：端口、成员变量等占据的空间
+struct Component : dzn::component {
+    char body[192];
+};
+
+/**
+ * 有序映射基线
+ * 与原运行时相同：按组件指针在std::map中查找状态，flush每次访问都重新查找
+ */
+struct MapRuntime {
+    std::map<dzn::component*, dzn::runtime::state> states;
+
+    std::size_t& handling(dzn::component* c) { return states[c].handling; }
+    dzn::task<void()>& deferred_flush(dzn::component* c) { return states[c].port_update; }
+    dzn::component*& deferred(dzn::component* c) { return states[c].deferred; }
+    dzn::ring<dzn::task<void()>>& queue(dzn::component* c) { return states[c].queue; }
+    void reset_skip_block(dzn::component* c) { states[c].skip = nullptr; }
+
+    void flush(dzn::component* component, std::size_t coroutine_id, bool sync_p) {
+        dzn::ring<dzn::task<void()>>& q = queue(component);
+        auto& flush = this->deferred_flush(component);
+        handling(component) = coroutine_id;
+        bool flushed = false;
+        while (!q.empty()) {
+            dzn::task<void()> event(std::move(q.front()));
+            q.pop();
+            if (!flushed && !sync_p && flush) {
+                flush();
+                flushed = true;
+            }
+            flush = nullptr;
+            event();
+        }
+        handling(component) = 0;
+        dzn::component* target = deferred(component);
+        if (!sync_p && target) {
+            deferred(component) = nullptr;
+            if (!handling(target)) {
+                this->flush(target, coroutine_id, sync_p);
+            }
+        } else if (!sync_p && this->deferred_flush(nullptr)) {
+            this->deferred_flush(nullptr)();
+            this->deferred_flush(nullptr) = nullptr;
+        }
+    }
+};
+
+/**
+ * 模拟生成代码中一个入事件的运行时访问：
+ * 检查处理状态、清除跳过阻塞标记、设置处理协程、事件入队并执行flush
+ * @return 单个事件平均耗时(纳秒)
+ */
+template <typename Runtime>
+double events(std::size_t components) {
+    Runtime runtime;
+    std::vector<Component> system(components);
+    std::mt19937_64 rng(1);
+    std::uniform_int_distribution<std::size_t> pick(0, components - 1);
+    std::vector<dzn::component*> order(kEvents);
+    for (auto& c : order) {
+        c = &system[pick(rng)];
+    }
+    std::size_t handled = 0;
+    auto event = [&](dzn::component* c) {
+        if (!runtime.handling(c)) {
+            runtime.reset_skip_block(c);
+            runtime.handling(c) = 1;
+            runtime.queue(c).push([&handled] { ++handled; });
+            runtime.handling(c) = 0;
+            runtime.flush(c, 1, false);
+        }
+    };
+    // 每个组件先处理一个事件，建立状态与队列缓冲，与系统运行一段时间后的稳定状态一致
+    for (auto& c : system) {
+        event(&c);
+    }
+    std::size_t i = 0;
+    double ns = valve::bench::measureNs(kEvents, [&] { event(order[i++]); });
+    valve::bench::keep(handled);
+    return ns;
+}
+
+} // namespace
+
+/**
+ * Dezyne运行时组件状态基准测试
+ * 比较按组件指针std::map查找与稠密状态表在不同系统规模下的单事件耗时，
+ * 稠密状态表的查找次数与组件数无关；组件数超出缓存容量后，耗时主要来自访问状态本身的缓存未命中
+ */
+int main() {
+    for (std::size_t components : {10, 1000, 10000, 100000}) {
+        char line[64];
+        std::snprintf(line, sizeof line, "std::map event (%zu components)", components);
+        valve::bench::report(line, events<MapRuntime>(components));
+        std::snprintf(line, sizeof line, "runtime event (%zu components)", components);
+        valve::bench::report(line, events<dzn::runtime>(components));
+    }
+    return 0;
+}
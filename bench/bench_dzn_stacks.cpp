@@ -0,0 +1,169 @@
+#include <dzn/locator.hh>     // 包含Dezyne服务定位器定义
+#include <dzn/pump.hh>        // 包含Dezyne事件泵定义
+#include <dzn/runtime.hh>     // 包含Dezyne运行时定义
+#include <dzn/stack-pool.hh>  // 包含Dezyne协程栈池定义
+#include "bench_common.h"    // 基准测试辅助工具
+#include <atomic>             // 原子变量支持
+#include <cstdlib>            // 内存分配支持
+#include <new>                // operator new支持
+#include <thread>             // 线程支持
+#include <vector>             // 动态数组支持
+
+namespace {
+
+std::atomic<std::uint64_t> allocations{0};  // 事件泵一侧的分配次数
+thread_local bool producer = false;         // 投递事件的主线程不计入：队列节点在主线程分配、在事件泵线程释放
+
+constexpr std::size_t kStacks = 100000;  // 栈分配/释放次数
+constexpr std::size_t kCycles = 20000;   // 阻塞/释放次数
+constexpr std::size_t kParked = 1000;    // 同时阻塞的协程数
+
+/**
+ * 等待事件泵执行完指定数量的事件
+ * 轮询计数而不用shell()，避免promise的分配计入统计
+ */
+void waitFor(const std::atomic<std::uint64_t>& executed, std::uint64_t target) {
+    while (executed.load(std::memory_order_acquire) < target) {
+        std::this_thread::yield();
+    }
+}
+
+void printStats(const dzn::stack_pool::statistics& s) {
+    std::printf("  stack %zu KiB + guard %zu KiB, in use %zu, free %zu (high water %zu), peak %zu\n",
+                s.stack_size / 1024, s.guard_size / 1024, s.in_use, s.free, s.high_water, s.peak);
+    std::printf("  mapped %zu KiB, maps %zu, reuses %zu\n", s.mapped / 1024, s.maps, s.reuses);
+}
+
+/**
+ * 含一个组件与端口的事件泵
+ */
+struct System {
+    System(std::size_t stackSize, std::size_t highWater)
+        : components(kParked + 1), ports(kParked + 1), pump(stackSize, highWater) {
+        locator.set(runtime).set(pump);
+    }
+
+    /**
+     * 组件i在其端口上阻塞，由后一个事件释放；完成后executed加一
+     */
+    void block(std::size_t i) {
+        pump([this, i] { dzn::port_block(locator, &components[i], &ports[i]); ++executed; });
+    }
+    void release(std::size_t i) {
+        pump([this, i] { dzn::port_release(locator, &components[i], &ports[i]); });
+    }
+
+    dzn::locator locator;
+    dzn::runtime runtime;
+    std::vector<dzn::component> components;
+    std::vector<int> ports;
+    std::atomic<std::uint64_t> executed{0};
+    dzn::pump pump;
+};
+
+/**
+ * 阻塞/释放kCycles次，返回单次耗时并统计每次的分配与映射次数
+ */
+void cycles(const char* name, System& system) {
+    std::size_t maps = system.pump.stacks.stats().maps;
+    std::uint64_t target = system.executed.load();
+    std::uint64_t before = allocations.load();
+    double ns = valve::bench::measureNs(1, [&] {
+        for (std::size_t i = 0; i < kCycles; ++i) {
+            system.block(kParked);
+            system.release(kParked);
+        }
+        waitFor(system.executed, target + kCycles);
+    }) / kCycles;
+    std::uint64_t count = allocations.load() - before;
+    valve::bench::report(name, ns);
+    std::printf("  %.3f allocations, %.3f stack maps per cycle\n",
+                static_cast<double>(count) / kCycles,
+                static_cast<double>(system.pump.stacks.stats().maps - maps) / kCycles);
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (!producer) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+/**
+ * Dezyne协程栈池基准测试
+ * 比较每次映射/解除映射与栈池复用的栈分配耗时；
+ * 统计经事件泵阻塞/释放时事件泵一侧每次的分配与映射次数(稳定状态下应为零)；
+ * 报告kParked个协程同时阻塞时的栈内存，并对比较小的栈配置
+ */
+int main() {
+    producer = true;
+    // 单个栈：每次mmap/munmap与栈池复用
+    valve::bench::report("stack mmap/munmap", valve::bench::measureNs(kStacks, [] {
+        std::size_t size;
+        void* stack = dzn::stack_pool::map(DZN_CONTEXT_STACK_SIZE, size);
+        static_cast<char*>(stack)[size - 1] = 1;  // 触及栈顶页
+        dzn::stack_pool::unmap(stack, size);
+    }));
+    {
+        dzn::stack_pool pool;
+        valve::bench::report("stack_pool allocate/deallocate", valve::bench::measureNs(kStacks, [&] {
+            void* stack = pool.allocate();
+            static_cast<char*>(stack)[pool.size() - 1] = 1;
+            pool.deallocate(stack);
+        }));
+    }
+
+    int failures = 0;
+    for (std::size_t stackSize : {std::size_t(DZN_CONTEXT_STACK_SIZE), std::size_t(64 * 1024)}) {
+        System system(stackSize, DZN_STACK_POOL_HIGH_WATER);
+        char line[64];
+        std::snprintf(line, sizeof line, "block/release cycle (%zu KiB stacks)", stackSize / 1024);
+        cycles(line, system);  // 预热：映射栈并建立缓冲
+        cycles(line, system);
+        std::uint64_t before = allocations.load();
+        std::size_t maps = system.pump.stacks.stats().maps;
+        std::uint64_t target = system.executed.load();
+        for (std::size_t i = 0; i < kCycles; ++i) {
+            system.block(kParked);
+            system.release(kParked);
+        }
+        waitFor(system.executed, target + kCycles);
+        if (allocations.load() != before || system.pump.stacks.stats().maps != maps) {
+            ++failures;
+        }
+
+        // kParked个协程同时阻塞
+        for (std::size_t i = 0; i < kParked; ++i) {
+            system.block(i);
+        }
+        dzn::shell(system.pump, [] {});
+        std::printf("%zu parked coroutines\n", kParked);
+        printStats(system.pump.stacks.stats());
+        for (std::size_t i = 0; i < kParked; ++i) {
+            system.release(i);
+        }
+        waitFor(system.executed, target + kCycles + kParked);
+        dzn::shell(system.pump, [] {});
+        std::printf("released\n");
+        printStats(system.pump.stacks.stats());
+    }
+
+    if (failures) {
+        std::printf("FAILED: block/release cycle allocated in steady state\n");
+        return 1;
+    }
+    return 0;
+}
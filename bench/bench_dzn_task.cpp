@@ -0,0 +1,161 @@
+#include <dzn/locator.hh>   // 包含Dezyne服务定位器定义
+#include <dzn/pump.hh>      // 包含Dezyne事件泵定义
+#include <dzn/runtime.hh>   // 包含Dezyne运行时定义
+#include "bench_common.h"   // 基准测试辅助工具
+#include <array>            // 定长数组支持
+#include <atomic>           // 原子变量支持
+#include <cstdlib>          // 内存分配支持
+#include <new>              // operator new支持
+#include <thread>           // 线程支持
+
+namespace {
+
+std::atomic<std::uint64_t> allocations{0};  // 全局分配次数
+
+constexpr std::size_t kEvents = 100000;  // 每项统计的事件数
+constexpr std::size_t kBatch = 1000;     // 每批投递后等待执行完，限制未执行事件数
+
+/**
+ * 统计执行op期间的内存分配次数(含其他线程)
+ */
+template <typename Op>
+std::uint64_t countAllocations(Op&& op) {
+    std::uint64_t before = allocations.load();
+    op();
+    return allocations.load() - before;
+}
+
+/**
+ * 等待事件泵执行完指定数量的事件
+ * 轮询计数而不用shell()，避免promise的分配计入统计
+ */
+void waitFor(const std::atomic<std::uint64_t>& executed, std::uint64_t target) {
+    while (executed.load(std::memory_order_acquire) < target) {
+        std::this_thread::yield();
+    }
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+/**
+ * Dezyne任务对象分配统计
+ * 稳定状态下统计事件泵投递、超大捕获投递、运行时队列和延迟事件每个事件的分配次数，
+ * 并与std::function对照；事件泵投递路径有分配时返回非零
+ */
+int main() {
+    std::atomic<std::uint64_t> executed{0};
+    int failures = 0;
+    auto check = [&](const char* name, std::uint64_t count, bool mustBeZero) {
+        std::printf("%-40s %10.3f allocations/event\n", name, static_cast<double>(count) / kEvents);
+        if (mustBeZero && count) {
+            ++failures;
+        }
+    };
+
+    // 对照：捕获56字节的lambda放入std::function
+    {
+        std::array<void*, 6> capture{};
+        std::uint64_t count = countAllocations([&] {
+            for (std::size_t i = 0; i < kEvents; ++i) {
+                std::function<void()> f([capture, &executed] { executed.fetch_add(capture.size()); });
+                valve::bench::keep(f);
+            }
+        });
+        check("std::function, 56-byte capture", count, false);
+    }
+
+    dzn::locator locator;
+    dzn::runtime runtime;
+    dzn::pump pump;
+    locator.set(runtime).set(pump);
+
+    // 事件泵投递：内联捕获与超出内联容量的捕获，分批投递
+    std::uint64_t target = 0;
+    auto post = [&](auto capture) {
+        for (std::size_t done = 0; done < kEvents; done += kBatch) {
+            for (std::size_t i = 0; i < kBatch; ++i) {
+                pump([capture, &executed] {
+                    valve::bench::keep(capture);
+                    executed.fetch_add(1, std::memory_order_release);
+                });
+            }
+            waitFor(executed, target += kBatch);
+        }
+    };
+    post(std::array<void*, 5>{});  // 预热：填充线程缓存和节点池
+    post(std::array<void*, 16>{});
+    check("pump post, 48-byte capture", countAllocations([&] { post(std::array<void*, 5>{}); }), true);
+    check("pump post, 136-byte capture", countAllocations([&] { post(std::array<void*, 16>{}); }), true);
+
+    // 运行时组件队列：在事件泵线程上入队并清空
+    dzn::component component;
+    auto queueCycle = [&](std::size_t n) {
+        pump([&, n] {
+            for (std::size_t i = 0; i < n; ++i) {
+                runtime.queue(&component).push([&executed] { executed.fetch_add(1, std::memory_order_release); });
+                runtime.flush(&component, 1, true);
+            }
+        });
+    };
+    queueCycle(kEvents);
+    waitFor(executed, target += kEvents);
+    check("runtime queue push/flush", countAllocations([&] {
+        queueCycle(kEvents);
+        waitFor(executed, target += kEvents);
+    }), true);
+
+    // 延迟事件：在事件泵线程上登记，由事件泵执行
+    auto deferCycle = [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            pump([&] {
+                dzn::defer(locator, [] { return true; },
+                           [&executed](std::size_t) { executed.fetch_add(1, std::memory_order_release); });
+            });
+        }
+    };
+    deferCycle(kEvents);
+    waitFor(executed, target += kEvents);
+    check("pump defer", countAllocations([&] {
+        deferCycle(kEvents);
+        waitFor(executed, target += kEvents);
+    }), true);
+
+    // 定时器：设置后立即取消
+    auto timerCycle = [&](std::size_t n) {
+        pump([&, n] {
+            for (std::size_t i = 0; i < n; ++i) {
+                pump.handle(i, 1000, [&executed] { executed.fetch_add(1); });
+                pump.remove(i);
+            }
+            executed.fetch_add(n, std::memory_order_release);
+        });
+    };
+    timerCycle(kEvents);
+    waitFor(executed, target += kEvents);
+    check("pump timer handle/remove", countAllocations([&] {
+        timerCycle(kEvents);
+        waitFor(executed, target += kEvents);
+    }), true);
+
+    if (failures) {
+        std::printf("FAILED: %d event path(s) allocate\n", failures);
+        return 1;
+    }
+    return 0;
+}
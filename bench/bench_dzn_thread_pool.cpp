@@ -0,0 +1,129 @@
+#include <dzn/thread-pool.hh>  // 包含Dezyne线程池定义
+#include "bench_common.h"     // 基准测试辅助工具
+#include <atomic>             // 原子变量支持
+#include <future>             // std::async与std::future支持
+#include <thread>             // 线程支持
+#include <vector>             // 动态数组支持
+
+namespace {
+
+constexpr std::size_t kTasks = 100000;        // 线程池短任务数
+constexpr std::size_t kAsyncTasks = 2000;     // std::async短任务数(每个任务一个线程)
+constexpr std::size_t kHandles = 1000000;     // 完成句柄创建次数
+constexpr std::size_t kBlocking = 1000;       // 阻塞任务数
+constexpr std::size_t kLimit = 8;             // 阻塞任务线程池的线程上限
+constexpr std::size_t kParents = 1000;        // 嵌套提交的父任务数
+constexpr std::size_t kChildren = 16;         // 每个父任务提交的子任务数
+
+void printMetrics(const dzn::thread::metrics& m) {
+    std::printf("  threads %zu, idle %zu, queued %zu, executed %zu, steals %zu\n",
+                m.threads, m.idle, m.queued, m.executed, m.steals);
+}
+
+} // namespace
+
+/**
+ * Dezyne线程池基准测试
+ * 比较完成句柄与std::future的开销、短任务提交执行耗时，
+ * 并验证阻塞任务下线程数受上限约束，嵌套提交时空闲线程窃取任务
+ */
+int main() {
+    // 完成句柄与promise/future：创建、完成、等待
+    valve::bench::report("std::promise/future round trip", valve::bench::measureNs(kHandles, [] {
+        std::promise<void> promise;
+        std::future<void> future = promise.get_future();
+        promise.set_value();
+        future.wait();
+    }));
+    valve::bench::report("dzn::completion round trip", valve::bench::measureNs(kHandles, [] {
+        dzn::completion::state* state;
+        dzn::completion done = dzn::completion::create(state);
+        dzn::completion::finish(state);
+        done.wait();
+    }));
+
+    // 短任务：全部提交后逐个等待
+    std::atomic<std::size_t> counter{0};
+    {
+        std::vector<std::future<void>> futures;
+        futures.reserve(kAsyncTasks);
+        valve::bench::report("std::async task", valve::bench::measureNs(1, [&] {
+            for (std::size_t i = 0; i < kAsyncTasks; ++i) {
+                futures.push_back(std::async(std::launch::async, [&counter] { ++counter; }));
+            }
+            for (auto& f : futures) {
+                f.wait();
+            }
+        }) / kAsyncTasks);
+    }
+    {
+        dzn::thread::pool pool(std::max(1u, std::thread::hardware_concurrency()));
+        std::vector<dzn::completion> handles;
+        handles.reserve(kTasks);
+        valve::bench::report("thread::pool task", valve::bench::measureNs(1, [&] {
+            for (std::size_t i = 0; i < kTasks; ++i) {
+                handles.push_back(pool.async([&counter] { ++counter; }));
+            }
+            for (auto& h : handles) {
+                h.wait();
+            }
+        }) / kTasks);
+        printMetrics(pool.metrics());
+    }
+
+    // 阻塞任务：任务等待闸门打开，线程数不超过上限，其余任务在队列中等待
+    int failures = 0;
+    {
+        dzn::thread::pool pool(kLimit);
+        std::atomic<bool> open{false};
+        std::vector<dzn::completion> handles;
+        for (std::size_t i = 0; i < kBlocking; ++i) {
+            handles.push_back(pool.async([&open] {
+                while (!open.load()) {
+                    std::this_thread::yield();
+                }
+            }));
+        }
+        dzn::thread::metrics blocked = pool.metrics();
+        std::printf("%zu blocking tasks, limit %zu\n", kBlocking, kLimit);
+        printMetrics(blocked);
+        open = true;
+        for (auto& h : handles) {
+            h.wait();
+        }
+        printMetrics(pool.metrics());
+        if (blocked.threads > kLimit || pool.metrics().executed != kBlocking) {
+            ++failures;
+        }
+    }
+
+    // 嵌套提交：父任务向本线程队列提交子任务，空闲线程从队首窃取
+    {
+        dzn::thread::pool pool(4);
+        std::vector<dzn::completion> parents;
+        std::vector<std::vector<dzn::completion>> children(kParents);
+        double ns = valve::bench::measureNs(1, [&] {
+            for (std::size_t i = 0; i < kParents; ++i) {
+                parents.push_back(pool.async([&pool, &children, &counter, i] {
+                    for (std::size_t j = 0; j < kChildren; ++j) {
+                        children[i].push_back(pool.async([&counter] { ++counter; }));
+                    }
+                }));
+            }
+            for (std::size_t i = 0; i < kParents; ++i) {
+                parents[i].wait();
+                for (auto& c : children[i]) {
+                    c.wait();
+                }
+            }
+        });
+        valve::bench::report("nested task", ns / (kParents * (kChildren + 1)));
+        printMetrics(pool.metrics());
+    }
+
+    if (failures) {
+        std::printf("FAILED: thread limit exceeded or work lost\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include <dzn/timer-wheel.hh>  // 包含Dezyne时间轮定义
+#include "bench_common.h"     // 基准测试辅助工具
+#include <functional>         // std::function支持
+#include <map>                // 有序映射支持
+#include <random>             // 随机数支持
+#include <unordered_map>      // 哈希映射支持
+#include <vector>             // 动态数组支持
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t kTimers = 1000000;     // 稳定状态下已设置的定时器数
+constexpr std::size_t kOperations = 2000000; // 稳定状态下的操作次数
+constexpr std::size_t kMaxMs = 60000;        // 定时器超时上限(毫秒)
+constexpr auto kStep = std::chrono::microseconds(30);  // 每次操作推进的模拟时间
+
+/**
+ * 有序映射基线
+ * 与原事件泵相同按(到期时间, 编号)排序；另加编号索引，取消时不再线性查找
+ */
+class MapTimers {
+public:
+    void arm(std::size_t id, Clock::time_point now, std::size_t ms, std::function<void()>&& event) {
+        auto it = timers_.emplace(std::make_pair(now + std::chrono::milliseconds(ms), id), std::move(event)).first;
+        index_.emplace(id, it);
+    }
+
+    bool cancel(std::size_t id) {
+        auto found = index_.find(id);
+        if (found == index_.end()) {
+            return false;
+        }
+        timers_.erase(found->second);
+        index_.erase(found);
+        return true;
+    }
+
+    void expire(Clock::time_point now) {
+        while (!timers_.empty() && timers_.begin()->first.first <= now) {
+            auto event = std::move(timers_.begin()->second);
+            index_.erase(timers_.begin()->first.second);
+            timers_.erase(timers_.begin());
+            event();
+        }
+    }
+
+private:
+    using Key = std::pair<Clock::time_point, std::size_t>;
+    std::map<Key, std::function<void()>> timers_;
+    std::unordered_map<std::size_t, std::map<Key, std::function<void()>>::iterator> index_;
+};
+
+/**
+ * 时间轮适配：推进后逐个取出到期定时器执行
+ */
+class WheelTimers {
+public:
+    void arm(std::size_t id, Clock::time_point now, std::size_t ms, dzn::task<void()>&& event) {
+        wheel_.arm(id, now, ms, std::move(event));
+    }
+
+    bool cancel(std::size_t id) {
+        return wheel_.cancel(id);
+    }
+
+    void expire(Clock::time_point now) {
+        wheel_.advance(now);
+        dzn::task<void()> event;
+        while (wheel_.pop(now, event)) {
+            event();
+        }
+    }
+
+private:
+    dzn::timer_wheel wheel_;
+};
+
+/**
+ * 稳定状态下的单次操作耗时(纳秒)
+ */
+struct Result {
+    double rearm;   // 取消并重新设置一个定时器
+    double expire;  // 推进时间、执行到期定时器并重新设置
+    std::size_t fired;
+};
+
+/**
+ * 设置kTimers个定时器后，交替执行重新设置与时间推进：
+ * 每次操作推进kStep，随机取消并重新设置一个定时器，到期的定时器执行后重新设置，
+ * 已设置的定时器数保持为kTimers
+ */
+template <typename Timers>
+Result steadyState() {
+    Timers timers;
+    std::mt19937_64 rng(1);
+    std::uniform_int_distribution<std::size_t> timeout(1, kMaxMs);
+    std::uniform_int_distribution<std::size_t> pick(0, kTimers - 1);
+    std::vector<std::size_t> fired;
+    fired.reserve(kTimers);
+    Clock::time_point now = Clock::now();
+
+    for (std::size_t id = 0; id < kTimers; ++id) {
+        timers.arm(id, now, timeout(rng), [&fired, id] { fired.push_back(id); });
+    }
+
+    std::vector<std::size_t> ids(kOperations);
+    std::vector<std::size_t> timeouts(kOperations);
+    for (std::size_t i = 0; i < kOperations; ++i) {
+        ids[i] = pick(rng);
+        timeouts[i] = timeout(rng);
+    }
+
+    double rearm = 0;
+    double expire = 0;
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < kOperations; ++i) {
+        now += kStep;
+        auto start = Clock::now();
+        std::size_t id = ids[i];
+        if (timers.cancel(id)) {
+            timers.arm(id, now, timeouts[i], [&fired, id] { fired.push_back(id); });
+        }
+        auto middle = Clock::now();
+        timers.expire(now);
+        for (std::size_t again : fired) {
+            timers.arm(again, now, timeouts[(i + again) % kOperations], [&fired, again] { fired.push_back(again); });
+        }
+        total += fired.size();
+        fired.clear();
+        auto end = Clock::now();
+        rearm += std::chrono::duration<double, std::nano>(middle - start).count();
+        expire += std::chrono::duration<double, std::nano>(end - middle).count();
+    }
+    return {rearm / kOperations, expire / kOperations, total};
+}
+
+void print(const char* name, const Result& result) {
+    char line[64];
+    std::snprintf(line, sizeof line, "%s rearm", name);
+    valve::bench::report(line, result.rearm);
+    std::snprintf(line, sizeof line, "%s advance+expire", name);
+    valve::bench::report(line, result.expire);
+    std::printf("%-40s %12zu\n", "  timers fired", result.fired);
+}
+
+} // namespace
+
+/**
+ * Dezyne事件泵定时器基准测试
+ * 1M个已设置定时器的稳定状态下，比较时间轮与有序映射的重新设置和到期处理耗时；
+ * 模拟时间共推进kOperations * kStep = 60秒，每个定时器平均到期约一次
+ */
+int main() {
+    std::printf("%zu armed timers, %zu operations, %lld us per operation\n",
+                kTimers, kOperations, static_cast<long long>(kStep.count()));
+    print("std::map", steadyState<MapTimers>());
+    print("timer wheel", steadyState<WheelTimers>());
+    return 0;
+}
@@ -0,0 +1,184 @@
+#include "../include/bus_simulator.h"  // 包含总线网关模拟器定义
+#include "../include/fleet_arena.h"    // 包含舰队对象区定义
+#include "bench_common.h"              // 基准测试辅助工具
+#include <algorithm>                   // 洗牌支持
+#include <cstdio>                      // 读取/proc
+#include <memory>                      // 智能指针支持
+#include <random>                      // 随机数支持
+#include <stdexcept>                   // 标准异常
+
+#ifdef __linux__
+#include <linux/perf_event.h>  // 硬件计数器
+#include <malloc.h>            // malloc_trim
+#include <sys/ioctl.h>         // ioctl
+#include <sys/syscall.h>       // syscall
+#include <unistd.h>            // close, sysconf
+#endif
+
+namespace {
+
+constexpr std::size_t kValves = 100000;  // 阀门数量
+constexpr std::size_t kShards = 8;       // 对象区分片数
+
+/**
+ * 当前常驻内存(字节)
+ */
+std::size_t residentBytes() {
+#ifdef __linux__
+    long pages = 0;
+    long resident = 0;
+    std::FILE* f = std::fopen("/proc/self/statm", "r");
+    if (f) {
+        if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2) {
+            resident = 0;
+        }
+        std::fclose(f);
+    }
+    return static_cast<std::size_t>(resident) * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+}
+
+/**
+ * 缓存未命中计数器
+ * 无权限或不支持时available()为false
+ */
+class CacheMissCounter {
+public:
+    CacheMissCounter() {
+#ifdef __linux__
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+    ~CacheMissCounter() {
+#ifdef __linux__
+        if (fd_ >= 0) ::close(fd_);
+#endif
+    }
+    bool available() const { return fd_ >= 0; }
+    void start() {
+#ifdef __linux__
+        if (fd_ >= 0) {
+            ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+    long long stop() {
+        long long value = 0;
+#ifdef __linux__
+        if (fd_ >= 0) {
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            if (::read(fd_, &value, sizeof(value)) != sizeof(value)) {
+                value = 0;
+            }
+        }
+#endif
+        return value;
+    }
+
+private:
+    int fd_ = -1;  // 计数器文件描述符
+};
+
+/**
+ * 对一个布局执行构造、随机顺序命令和销毁，输出各项指标
+ */
+template <typename Build>
+void measure(const char* name, Build&& build) {
+    using namespace valve;
+    std::vector<std::size_t> order(kValves);
+    for (std::size_t i = 0; i < kValves; ++i) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937(11));
+
+    BusSimulator bus(kValves);
+    const std::size_t rssBefore = residentBytes();
+    std::vector<ValveController*> fleet(kValves);
+    auto start = std::chrono::steady_clock::now();
+    auto owner = build(bus, fleet);
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    const std::size_t rssAfter = residentBytes();
+
+    // 随机顺序开关所有阀门，冷启动后第二轮计入
+    auto cycle = [&] {
+        for (std::size_t i : order) fleet[i]->open();
+        for (std::size_t i : order) fleet[i]->close();
+    };
+    cycle();
+    CacheMissCounter misses;
+    misses.start();
+    double ns = bench::measureNs(1, cycle) / (2.0 * kValves);
+    long long missCount = misses.stop();
+
+    start = std::chrono::steady_clock::now();
+    owner.reset();
+    double teardownMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("[%s]\n", name);
+    std::printf("  build %.2f ms, teardown %.2f ms, rss +%.1f MB (%.0f B/valve)\n", buildMs, teardownMs,
+                (rssAfter - rssBefore) / 1048576.0, static_cast<double>(rssAfter - rssBefore) / kValves);
+    std::printf("  command %.1f ns", ns);
+    if (misses.available()) {
+        std::printf(", cache misses %.2f/command\n", static_cast<double>(missCount) / (2.0 * kValves));
+    } else {
+        std::printf(", cache misses n/a (perf counters unavailable)\n");
+    }
+}
+
+} // namespace
+
+/**
+ * 舰队对象区基准测试
+ * 十万个阀门：每个阀门三个独立堆对象的原有布局，
+ * 与硬件抽象层、驱动层、控制器相邻存放在分片对象区中的布局对比
+ */
+int main() {
+    using namespace valve;
+
+    // 先测对象区：整块内存销毁时直接归还系统，不影响后一项的RSS统计
+    measure("arena cells, 8 shards", [](BusSimulator& bus, std::vector<ValveController*>& fleet) {
+        auto arena = std::make_unique<FleetArena<BusChannel>>(kValves, kShards);
+        for (std::size_t i = 0; i < kValves; ++i) {
+            fleet[i] = arena->emplace(i, bus, i);
+        }
+        return arena;
+    });
+#ifdef __linux__
+    malloc_trim(0);
+#endif
+
+    measure("heap objects (unique_ptr x3)", [](BusSimulator& bus, std::vector<ValveController*>& fleet) {
+        auto owned = std::make_unique<std::vector<std::unique_ptr<ValveController>>>();
+        owned->reserve(kValves);
+        for (std::size_t i = 0; i < kValves; ++i) {
+            owned->push_back(std::make_unique<ValveController>(std::make_unique<ValveDriver>(bus.channel(i))));
+            fleet[i] = owned->back().get();
+        }
+        return owned;
+    });
+
+    // 未知硬件类型得到空指针，接管所有权的构造函数拒绝而不是解引用
+    int rejected = 0;
+    try {
+        ValveDriver driver(ValveHALFactory::createHAL("no-such-hal"));
+    } catch (const std::invalid_argument&) {
+        ++rejected;
+    }
+    try {
+        ValveController controller(std::unique_ptr<IValveDriver>{});
+    } catch (const std::invalid_argument&) {
+        ++rejected;
+    }
+    std::printf("null hal/driver rejected: %s\n", rejected == 2 ? "yes" : "no");
+    return rejected == 2 ? 0 : 1;
+}
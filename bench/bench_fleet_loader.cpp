@@ -0,0 +1,114 @@
+#include "../include/fleet_loader.h"   // 包含舰队配置加载器定义
+#include "../include/bus_simulator.h"  // 包含总线网关模拟器定义
+#include "bench_common.h"              // 基准测试辅助工具
+#include <cstdio>                      // 文件读写
+
+namespace {
+
+/**
+ * 检查被拒绝的行空出通道而不移动后续阀门的通道
+ * 中间一行参数无效、一行不以数字开头，各计一次拒绝；
+ * 批量下发、逐个下发和二进制往返后，每个阀门的参数都写在自己的通道上
+ * @return 检查是否全部通过
+ */
+bool checkStableChannels() {
+    using namespace valve;
+    const std::string csvPath = "bench_fleet_loader_holes.csv";
+    const std::string binPath = "bench_fleet_loader_holes.bin";
+    std::FILE* csv = std::fopen(csvPath.c_str(), "w");
+    if (!csv) {
+        return false;
+    }
+    // 数据行0..5，其中行2(行程为0)和行4(x开头)被拒绝
+    std::fprintf(csv, "# comment\nzone,open,close,speed\n"
+                      "1,10,0,1\n"
+                      "  2,20,0,2\r\n"
+                      "3,30,30,3\n"
+                      "\n"
+                      "4,40,0,4\n"
+                      "x,50,0,5\n"
+                      "6,60,0,6\n");
+    std::fclose(csv);
+
+    const std::uint32_t expected[] = {0, 1, 3, 5};
+    bool ok = true;
+    auto check = [&](const char* name, const std::string& path, bool useBulk) {
+        BusSimulator bus(6);
+        LoadReport report;
+        FleetLoader loader(4);  // 多线程切分，段边界落在各行之间
+        std::unique_ptr<LoadedFleet> fleet = loader.load(
+            path, [&bus](std::size_t index) { return bus.channel(index); }, useBulk ? &bus : nullptr, report);
+        bool good = fleet && fleet->fleet.size() == 4 && report.valves == 4 && report.rejected == 2 &&
+                    report.bulkConfigured == useBulk;
+        for (std::size_t i = 0; good && i < 4; ++i) {
+            const std::uint32_t channel = expected[i];
+            good = fleet->channels[i] == channel && fleet->zones[i] == channel + 1 &&
+                   bus.parameters(channel).openPosition == Position(static_cast<int>(channel + 1) * 10);
+        }
+        std::printf("stable channels (%s): %s\n", name, good ? "yes" : "no");
+        ok = ok && good;
+    };
+    check("csv, bulk", csvPath, true);
+    check("csv, per valve", csvPath, false);
+
+    std::vector<FleetEntry> entries;
+    LoadReport parsed;
+    ok = ok && FleetLoader(1).parse(csvPath, entries, parsed) && writeFleetBinary(binPath, entries);
+    check("binary, bulk", binPath, true);
+
+    std::remove(csvPath.c_str());
+    std::remove(binPath.c_str());
+    return ok;
+}
+
+} // namespace
+
+/**
+ * 舰队配置加载基准测试
+ * 生成十万个阀门的CSV描述并转换为二进制格式，
+ * 分别以批量接口和逐个setup加载，输出各阶段耗时
+ */
+int main() {
+    using namespace valve;
+
+    constexpr std::size_t kValves = 100000;  // 阀门数量
+    const std::string csvPath = "bench_fleet_loader.csv";
+    const std::string binPath = "bench_fleet_loader.bin";
+
+    // 生成描述文件：8种阀门类别，256个区域
+    std::FILE* csv = std::fopen(csvPath.c_str(), "w");
+    if (!csv) {
+        return 1;
+    }
+    std::fprintf(csv, "zone,open,close,speed\n");
+    for (std::size_t i = 0; i < kValves; ++i) {
+        std::fprintf(csv, "%zu,%zu.5,0,%zu\n", i % 256, 50 + (i % 8) * 10, 10 + i % 8);
+    }
+    std::fprintf(csv, "# malformed line below is rejected\n7,100,100,10\n");
+    std::fclose(csv);
+
+    FleetLoader loader;
+    std::vector<FleetEntry> entries;
+    LoadReport parsed;
+    loader.parse(csvPath, entries, parsed);
+    writeFleetBinary(binPath, entries);
+
+    bool ok = true;
+    auto run = [&](const char* name, const std::string& path, bool useBulk) {
+        BusSimulator bus(kValves);
+        LoadReport report;
+        std::unique_ptr<LoadedFleet> fleet = loader.load(
+            path, [&bus](std::size_t index) { return bus.channel(index); }, useBulk ? &bus : nullptr, report);
+        std::printf("[%s]\n%s\n  bus parameter transactions: %llu\n", name, report.toString().c_str(),
+                    static_cast<unsigned long long>(bus.parameterTransactions()));
+        ok = ok && fleet && fleet->fleet.size() == kValves && fleet->fleet[3]->profile() &&
+             bus.parameters(3).openPosition == Position::fromRaw(80 * Position::kOne + Position::kOne / 2);
+    };
+    run("csv, bulk configure", csvPath, true);
+    run("binary, bulk configure", binPath, true);
+    run("csv, per-valve setup", csvPath, false);
+
+    std::remove(csvPath.c_str());
+    std::remove(binPath.c_str());
+    return ok && parsed.rejected == 1 && checkStableChannels() ? 0 : 1;
+}
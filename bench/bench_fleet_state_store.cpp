@@ -0,0 +1,66 @@
+#include "../include/fleet_state_store.h"  // 包含舰队状态存储定义
+#include "bench_common.h"                  // 基准测试辅助工具
+#include <random>                          // 随机数生成
+
+/**
+ * 舰队状态存储聚合查询基准测试
+ * 在一百万个阀门上分别以标量、SSE2和AVX2实现执行
+ * 状态直方图、区域过滤和陈旧阀门扫描
+ */
+int main() {
+    using namespace valve;
+
+    constexpr std::size_t kValves = 1000000;  // 阀门数量
+    constexpr std::uint16_t kZones = 64;      // 区域数量
+    constexpr std::size_t kIterations = 200;  // 每项查询重复次数
+
+    FleetStateStore store(kValves);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> statusDist(0, static_cast<int>(FleetStateStore::kStatusCount) - 1);
+    std::uniform_int_distribution<int> zoneDist(0, kZones - 1);
+    std::uniform_int_distribution<int> ageDist(0, 60000);
+
+    const FleetStateStore::Timestamp now = FleetStateStore::now();
+    for (std::size_t i = 0; i < kValves; ++i) {
+        std::uint32_t index = store.add(static_cast<std::uint16_t>(zoneDist(rng)));
+        // 随机分布最后变化时间在过去60秒内
+        store.setStatus(index, static_cast<ValveStatus>(statusDist(rng)),
+                        now - static_cast<FleetStateStore::Timestamp>(ageDist(rng)) * 1000000);
+    }
+
+    const std::uint8_t movingOrError = FleetStateStore::statusBit(ValveStatus::MOVING) |
+                                       FleetStateStore::statusBit(ValveStatus::ERROR);
+    const FleetStateStore::Timestamp maxAge = 30LL * 1000000000LL;  // 30秒未变化视为陈旧
+
+    const struct {
+        FleetStateStore::SimdLevel level;
+        const char* name;
+    } levels[] = {
+        {FleetStateStore::SimdLevel::SCALAR, "scalar"},
+        {FleetStateStore::SimdLevel::SSE2, "sse2"},
+        {FleetStateStore::SimdLevel::AVX2, "avx2"},
+    };
+
+    std::printf("valves: %zu, zones: %u\n", kValves, static_cast<unsigned>(kZones));
+    for (const auto& entry : levels) {
+        store.setSimdLevel(entry.level);
+        if (store.simdLevel() != entry.level) {
+            std::printf("%s: not supported on this CPU, skipped\n", entry.name);
+            continue;
+        }
+
+        char label[64];
+        std::snprintf(label, sizeof(label), "%s histogram", entry.name);
+        bench::report(label, bench::measureNs(kIterations, [&] { bench::keep(store.statusHistogram()); }));
+
+        std::snprintf(label, sizeof(label), "%s zone 7 MOVING|ERROR", entry.name);
+        bench::report(label, bench::measureNs(kIterations, [&] { bench::keep(store.countInZone(7, movingOrError)); }));
+
+        std::snprintf(label, sizeof(label), "%s stale scan", entry.name);
+        bench::report(label, bench::measureNs(kIterations, [&] { bench::keep(store.countStale(now, maxAge)); }));
+
+        std::printf("  -> zone 7 MOVING|ERROR = %zu, stale = %zu\n",
+                    store.countInZone(7, movingOrError), store.countStale(now, maxAge));
+    }
+    return 0;
+}
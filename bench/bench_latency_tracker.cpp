@@ -0,0 +1,115 @@
+#include "../include/bus_simulator.h"    // 包含总线网关模拟器定义
+#include "../include/fleet_arena.h"      // 包含舰队对象区定义
+#include "../include/latency_tracker.h"  // 包含移动耗时统计定义
+#include "bench_common.h"                // 基准测试辅助工具
+#include <string>                        // 字符串支持
+#include <thread>                        // 线程支持
+#include <vector>                        // 动态数组支持
+
+namespace {
+
+constexpr std::size_t kSamples = 10000000;  // 每个线程记录的样本数
+constexpr std::size_t kThreads = 4;         // 并发记录的线程数
+constexpr std::size_t kValves = 10000;      // 阀门数量
+
+/**
+ * 拒绝所有移动的硬件，用于检查失败移动的统计
+ */
+class RejectingHAL : public valve::IValveHAL {
+public:
+    bool setParameters(const valve::ValveParameters&) override { return true; }
+    bool move(valve::ValveMove) override { return false; }
+    valve::ValveStatus getStatus() const override { return valve::ValveStatus::ERROR; }
+};
+
+/**
+ * 检查以ERROR结束的移动只计入error阶段
+ * @return 检查是否通过
+ */
+bool checkErrorsSeparated() {
+    using namespace valve;
+    LatencyTracker tracker;
+    const std::uint16_t faulty = tracker.defineClass("faulty");
+    ValveController controller(std::make_unique<ValveDriver>(std::make_unique<RejectingHAL>()));
+    controller.setLatencyTracker(&tracker, faulty);
+    controller.open();
+    controller.open();
+    bool ok = tracker.snapshot(faulty, ValveCommand::OPEN, LatencyPhase::ERROR).count == 2 &&
+              tracker.snapshot(faulty, ValveCommand::OPEN, LatencyPhase::ACCEPT).count == 0 &&
+              tracker.snapshot(faulty, ValveCommand::OPEN, LatencyPhase::COMPLETION).count == 0;
+    std::printf("\nerror moves kept out of normal phases: %s\n", ok ? "yes" : "no");
+    return ok;
+}
+
+} // namespace
+
+/**
+ * 移动耗时统计基准测试
+ * 单线程和多线程的单样本记录开销、读取合并开销，
+ * 以及接入统计前后控制器单条命令的开销
+ */
+int main() {
+    using namespace valve;
+
+    {
+        LatencyTracker tracker;
+        const std::uint16_t motor = tracker.defineClass("motor/zone-3");
+        std::uint64_t value = 1;
+        double ns = bench::measureNs(kSamples, [&] {
+            value = value * 6364136223846793005ULL + 1442695040888963407ULL;  // 伪随机耗时
+            tracker.record(motor, ValveCommand::OPEN, LatencyPhase::COMPLETION, (value >> 40) & 0xFFFFF);
+        });
+        bench::report("record, 1 thread (per sample)", ns);
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&, t] {
+                std::uint64_t v = t + 1;
+                for (std::size_t i = 0; i < kSamples; ++i) {
+                    v = v * 6364136223846793005ULL + 1442695040888963407ULL;
+                    tracker.record(motor, ValveCommand::OPEN, LatencyPhase::COMPLETION, (v >> 40) & 0xFFFFF);
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        bench::report("record, 4 threads (per sample, wall)", elapsed / (kThreads * kSamples));
+
+        LatencySnapshot snapshot;
+        bench::report("snapshot merge (5 thread shards)", bench::measureNs(100, [&] {
+            snapshot = tracker.snapshot(motor, ValveCommand::OPEN, LatencyPhase::COMPLETION);
+        }));
+        std::printf("  merged %llu samples, p50 %llu ns, p99 %llu ns, max %llu ns\n",
+                    static_cast<unsigned long long>(snapshot.count),
+                    static_cast<unsigned long long>(snapshot.percentile(0.5)),
+                    static_cast<unsigned long long>(snapshot.percentile(0.99)),
+                    static_cast<unsigned long long>(snapshot.max));
+    }
+
+    // 控制器单条命令开销：未接入与接入统计
+    BusSimulator bus(kValves);
+    FleetArena<BusChannel> arena(kValves, 1);
+    std::vector<ValveController*> fleet(kValves);
+    for (std::size_t i = 0; i < kValves; ++i) {
+        fleet[i] = arena.emplace(i, bus, i);
+    }
+    auto cycle = [&] {
+        for (ValveController* c : fleet) c->open();
+        for (ValveController* c : fleet) c->close();
+    };
+    cycle();
+    bench::report("command, no tracker", bench::measureNs(50, cycle) / (2.0 * kValves));
+
+    LatencyTracker tracker;
+    const std::uint16_t classes[] = {tracker.defineClass("motor/zone-3"), tracker.defineClass("solenoid/zone-3")};
+    for (std::size_t i = 0; i < kValves; ++i) {
+        fleet[i]->setLatencyTracker(&tracker, classes[i % 2]);
+    }
+    cycle();
+    bench::report("command, with tracker", bench::measureNs(50, cycle) / (2.0 * kValves));
+
+    std::string text = tracker.exportText();
+    std::printf("\nexport (%zu bytes), first lines:\n%.*s", text.size(), 480, text.c_str());
+    return checkErrorsSeparated() ? 0 : 1;
+}
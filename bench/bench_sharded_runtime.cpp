@@ -0,0 +1,112 @@
+#include "../include/bus_simulator.h"    // 包含总线网关模拟器定义
+#include "../include/fleet_arena.h"      // 包含舰队对象区定义
+#include "../include/sharded_runtime.h"  // 包含分片运行时定义
+#include "bench_common.h"                // 基准测试辅助工具
+#include <algorithm>                     // 最值支持
+#include <random>                        // 随机数支持
+#include <thread>                        // 线程支持
+#include <vector>                        // 动态数组支持
+
+namespace {
+
+constexpr std::size_t kValves = 100000;    // 阀门数量
+constexpr std::size_t kZoneSize = 1000;    // 每个区域的阀门数
+constexpr std::size_t kEvents = 2000000;   // 命令总数
+constexpr unsigned kHotPercent = 90;       // 落在热点区域的命令比例
+constexpr std::uint32_t kHotZones[] = {3, 7};  // 热点区域
+
+/**
+ * 生成突发负载：大部分命令集中在少数区域
+ */
+std::vector<std::uint32_t> burstyValves() {
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<unsigned> percent(0, 99);
+    std::uniform_int_distribution<std::uint32_t> any(0, kValves - 1);
+    std::uniform_int_distribution<std::uint32_t> inZone(0, kZoneSize - 1);
+    std::vector<std::uint32_t> valves(kEvents);
+    for (auto& v : valves) {
+        if (percent(rng) < kHotPercent) {
+            v = kHotZones[rng() % 2] * kZoneSize + inZone(rng);
+        } else {
+            v = any(rng);
+        }
+    }
+    return valves;
+}
+
+} // namespace
+
+/**
+ * 分片运行时基准测试
+ * 十万个阀门、两百万条集中在两个区域的突发命令，
+ * 按工作线程数测量吞吐；每个生产者只负责一部分阀门，
+ * 结束后检查每个阀门的最终状态与其最后一条命令一致，验证单阀门顺序
+ */
+int main() {
+    using namespace valve;
+    const std::vector<std::uint32_t> valves = burstyValves();
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("hardware threads: %u\n", cores);
+
+    std::vector<std::size_t> workerCounts;
+    for (std::size_t w = 1; w <= std::max<std::size_t>(cores, 2); w *= 2) {
+        workerCounts.push_back(w);
+    }
+    if (workerCounts.back() != cores && cores > 2) {
+        workerCounts.push_back(cores);
+    }
+
+    double baseline = 0.0;
+    for (std::size_t workers : workerCounts) {
+        BusSimulator bus(kValves);
+        FleetArena<BusChannel> arena(kValves, 8);
+        std::vector<ValveController*> fleet(kValves);
+        for (std::size_t i = 0; i < kValves; ++i) {
+            fleet[i] = arena.emplace(i, bus, i);
+        }
+
+        RuntimeOptions options;
+        options.workers = workers;
+        ShardedRuntime runtime(fleet, options);
+        runtime.start();
+
+        // 每个生产者按阀门编号取模负责一部分阀门，同一阀门的命令只来自一个生产者
+        const std::size_t producers = workers;
+        std::vector<std::vector<ValveCommand>> last(producers, std::vector<ValveCommand>(kValves, ValveCommand::NONE));
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (std::size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                std::vector<ValveCommand>& mine = last[p];
+                for (std::uint32_t v : valves) {
+                    if (v % producers != p) continue;
+                    ValveCommand c = mine[v] == ValveCommand::OPEN ? ValveCommand::CLOSE : ValveCommand::OPEN;
+                    mine[v] = c;
+                    runtime.command(v, c);
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        runtime.drain();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        RuntimeStats stats = runtime.stats();
+        runtime.stop();
+
+        std::size_t misordered = 0;
+        for (std::size_t v = 0; v < kValves; ++v) {
+            ValveCommand c = last[v % producers][v];
+            if ((c == ValveCommand::OPEN && !fleet[v]->isOpen()) || (c == ValveCommand::CLOSE && !fleet[v]->isClosed())) {
+                ++misordered;
+            }
+        }
+
+        double rate = kEvents / seconds;
+        if (baseline == 0.0) baseline = rate;
+        std::uint64_t busiest = *std::max_element(stats.processed.begin(), stats.processed.end());
+        std::printf("workers %2zu: %8.2f M events/s (x%.2f), batches %llu, steals %llu, busiest worker %.0f%%, "
+                    "misordered %zu\n",
+                    workers, rate / 1e6, rate / baseline, static_cast<unsigned long long>(stats.batches),
+                    static_cast<unsigned long long>(stats.steals), 100.0 * busiest / kEvents, misordered);
+    }
+    return 0;
+}
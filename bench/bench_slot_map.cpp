@@ -0,0 +1,80 @@
+#include "../include/slot_map.h"  // 包含槽位表定义
+#include "bench_common.h"         // 基准测试辅助工具
+#include <algorithm>              // 洗牌支持
+#include <random>                 // 随机数支持
+#include <unordered_map>          // 哈希表对照组
+
+/**
+ * 槽位表基准测试
+ * 一百万个元素的插入、随机查找、随机删除和复用槽位的再插入，
+ * 并与以打包标识为键的哈希表对照
+ */
+int main() {
+    using namespace valve;
+
+    constexpr std::size_t kCount = 1000000;  // 元素数量
+    std::mt19937 rng(42);
+
+    SlotMap<std::uint64_t> map;
+    std::vector<ValveId> ids(kCount);
+    bench::report("slot map insert", bench::measureNs(1, [&] {
+        map.reserve(kCount);
+        for (std::size_t i = 0; i < kCount; ++i) {
+            ids[i] = map.insert(i);
+        }
+    }) / kCount);
+
+    std::vector<ValveId> probes = ids;
+    std::shuffle(probes.begin(), probes.end(), rng);
+    std::uint64_t sum = 0;
+    bench::report("slot map random lookup", bench::measureNs(1, [&] {
+        for (const ValveId& id : probes) {
+            sum += *map.find(id);
+        }
+    }) / kCount);
+    bench::keep(sum);
+
+    bench::report("slot map random erase", bench::measureNs(1, [&] {
+        for (const ValveId& id : probes) {
+            map.erase(id);
+        }
+    }) / kCount);
+
+    std::vector<ValveId> reused(kCount);
+    bench::report("slot map reinsert (reuse slots)", bench::measureNs(1, [&] {
+        for (std::size_t i = 0; i < kCount; ++i) {
+            reused[i] = map.insert(i);
+        }
+    }) / kCount);
+
+    std::size_t stale = 0;
+    bench::report("slot map stale lookup", bench::measureNs(1, [&] {
+        for (const ValveId& id : probes) {
+            stale += map.find(id) == nullptr;
+        }
+    }) / kCount);
+
+    // 对照组：以打包标识为键的哈希表
+    std::unordered_map<std::uint64_t, std::uint64_t> hash;
+    bench::report("unordered_map insert", bench::measureNs(1, [&] {
+        hash.reserve(kCount);
+        for (std::size_t i = 0; i < kCount; ++i) {
+            hash.emplace(ids[i].packed(), i);
+        }
+    }) / kCount);
+    sum = 0;
+    bench::report("unordered_map random lookup", bench::measureNs(1, [&] {
+        for (const ValveId& id : probes) {
+            sum += hash.find(id.packed())->second;
+        }
+    }) / kCount);
+    bench::keep(sum);
+    bench::report("unordered_map random erase", bench::measureNs(1, [&] {
+        for (const ValveId& id : probes) {
+            hash.erase(id.packed());
+        }
+    }) / kCount);
+
+    std::printf("size: %zu, slots: %zu, stale detected: %zu\n", map.size(), map.slotCount(), stale);
+    return (stale == kCount && map.slotCount() == kCount) ? 0 : 1;
+}
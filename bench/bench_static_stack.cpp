@@ -0,0 +1,66 @@
+#include "../include/basic_valve_controller.h"  // 包含静态组合控制器定义
+#include "../include/bus_simulator.h"           // 包含总线网关模拟器定义
+#include "../include/fleet_arena.h"             // 包含舰队对象区定义
+#include "bench_common.h"                       // 基准测试辅助工具
+#include <vector>                               // 动态数组支持
+
+namespace {
+
+constexpr std::size_t kValves = 1024;  // 阀门数量，全部留在缓存中，只比较调用开销
+constexpr std::size_t kRounds = 2000;  // 开关轮数
+
+/**
+ * 对一组控制器反复开关，返回每条命令的平均耗时
+ */
+template <typename Controller>
+double perCommand(std::vector<Controller*>& fleet) {
+    auto cycle = [&] {
+        for (Controller* c : fleet) c->open();
+        for (Controller* c : fleet) c->close();
+    };
+    cycle();  // 预热
+    double ns = valve::bench::measureNs(kRounds, cycle) / (2.0 * kValves);
+    valve::bench::keep(fleet.front()->isClosed());
+    return ns;
+}
+
+} // namespace
+
+/**
+ * 静态组合基准测试
+ * 同一个总线网关通道上，对比三种组合的单条命令开销：
+ * 虚调用组合(ValveController → IValveDriver → IValveHAL，状态对象和回调均为间接调用)、
+ * 经IValveController接口调用的静态组合、直接调用的静态组合
+ */
+int main() {
+    using namespace valve;
+    using StaticController = StaticValveController<BusChannel>;
+
+    BusSimulator bus(kValves);
+    const ValveParameters params{Position(100), Position(0), Speed(10)};
+
+    FleetArena<BusChannel> arena(kValves, 1);
+    std::vector<ValveController*> dynamicFleet(kValves);
+    for (std::size_t i = 0; i < kValves; ++i) {
+        dynamicFleet[i] = arena.emplace(i, bus, i);
+        dynamicFleet[i]->setup(params);
+    }
+
+    std::vector<StaticController> statics;
+    statics.reserve(kValves);
+    for (std::size_t i = 0; i < kValves; ++i) {
+        statics.emplace_back(bus, i);
+        statics.back().setup(params);
+    }
+    std::vector<IValveController*> viaInterface(kValves);
+    std::vector<StaticController*> direct(kValves);
+    for (std::size_t i = 0; i < kValves; ++i) {
+        viaInterface[i] = &statics[i];
+        direct[i] = &statics[i];
+    }
+
+    bench::report("virtual stack (per command)", perCommand(dynamicFleet));
+    bench::report("static stack via interface (per command)", perCommand(viaInterface));
+    bench::report("static stack direct (per command)", perCommand(direct));
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include "../include/valve_controller.h"  // 包含控制器接口定义
+#include "../include/status_notifier.h"   // 包含状态通知分发器定义
+#include "bench_common.h"                 // 基准测试辅助工具
+#include <atomic>                         // 原子变量支持
+#include <memory>                         // 智能指针支持
+#include <thread>                         // 线程支持
+
+namespace {
+
+/**
+ * 立即完成的硬件抽象层
+ * move调用内同步报告最终状态，使测量结果只包含通知开销
+ */
+class InstantHAL : public valve::IValveHAL {
+public:
+    bool setParameters(const valve::ValveParameters&) override { return true; }
+    bool move(valve::ValveMove target) override {
+        status_ = (target == valve::ValveMove::OPEN) ? valve::ValveStatus::OPENED : valve::ValveStatus::CLOSED;
+        if (callback_) {
+            callback_(status_);  // 同步完成
+        }
+        return true;
+    }
+    valve::ValveStatus getStatus() const override { return status_; }
+    bool setCompletionCallback(CompletionCallback callback) override {
+        callback_ = std::move(callback);
+        return true;
+    }
+
+private:
+    valve::ValveStatus status_ = valve::ValveStatus::UNKNOWN;
+    CompletionCallback callback_;
+};
+
+} // namespace
+
+/**
+ * 状态通知基准测试
+ * 一万个阀门同时打开再关闭：对比慢客户端直接挂在同步回调上，
+ * 与同一个慢客户端通过分发器异步批量接收时的命令完成路径耗时
+ */
+int main() {
+    using namespace valve;
+
+    constexpr std::uint32_t kValves = 10000;  // 阀门数量
+
+    std::vector<std::unique_ptr<ValveController>> fleet;
+    for (std::uint32_t i = 0; i < kValves; ++i) {
+        fleet.push_back(std::make_unique<ValveController>(
+            std::make_unique<ValveDriver>(std::make_unique<InstantHAL>())));
+        fleet.back()->setup(ValveParameters{Position(100), Position(0), Speed(10)});
+    }
+    auto cycle = [&] {
+        for (auto& controller : fleet) controller->open();
+        for (auto& controller : fleet) controller->close();
+    };
+    auto slowConsumer = [] {
+        auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(5);
+        while (std::chrono::steady_clock::now() < until) {
+        }
+    };
+
+    // 慢客户端直接挂在同步回调上：每次状态变化都阻塞完成路径
+    for (auto& controller : fleet) {
+        controller->setStatusCallback([&](ValveStatus) { slowConsumer(); });
+    }
+    bench::report("sync slow callback (per valve cycle)", bench::measureNs(1, cycle) / kValves);
+    for (auto& controller : fleet) {
+        controller->setStatusCallback(nullptr);
+    }
+
+    // 经分发器：一个快订阅者，一个每批耗时1ms的慢订阅者
+    StatusNotifier notifier(kValves);
+    std::atomic<std::uint64_t> fastSeen{0};
+    std::size_t fast = notifier.subscribe([&](const std::vector<StatusUpdate>& batch) {
+        fastSeen += batch.size();
+    });
+    SubscriberOptions slowOptions;
+    slowOptions.capacity = 4096;
+    slowOptions.maxBatch = 256;
+    slowOptions.maxLatency = std::chrono::milliseconds(5);
+    std::size_t slow = notifier.subscribe([](const std::vector<StatusUpdate>&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }, slowOptions);
+    for (std::uint32_t i = 0; i < kValves; ++i) {
+        fleet[i]->setNotifier(&notifier, i);
+    }
+    bench::report("notifier publish (per valve cycle)", bench::measureNs(1, cycle) / kValves);
+    double flushNs = bench::measureNs(1, [&] { notifier.flush(); });
+    bench::report("flush both subscribers", flushNs);
+
+    for (std::size_t id : {fast, slow}) {
+        SubscriberStats s = notifier.stats(id);
+        std::printf("%-5s published=%llu delivered=%llu batches=%llu coalesced=%llu dropped=%llu\n",
+                    id == fast ? "fast" : "slow",
+                    static_cast<unsigned long long>(s.published), static_cast<unsigned long long>(s.delivered),
+                    static_cast<unsigned long long>(s.batches), static_cast<unsigned long long>(s.coalesced),
+                    static_cast<unsigned long long>(s.dropped));
+    }
+    SubscriberStats s = notifier.stats(slow);
+    return (s.published == s.delivered + s.coalesced + s.dropped) ? 0 : 1;
+}
@@ -0,0 +1,234 @@
+#include "../include/status_poller.h"     // 包含状态轮询器定义
+#include "../include/valve_controller.h"  // 包含控制器定义
+#include "../include/valve_profile.h"     // 包含阀门参数配置定义
+#include "bench_common.h"                 // 基准测试辅助工具
+#include <algorithm>                      // 最值支持
+#include <atomic>                         // 原子变量支持
+#include <memory>                         // 智能指针支持
+#include <random>                         // 随机数支持
+#include <thread>                         // 线程支持
+#include <vector>                         // 动态数组支持
+
+namespace {
+
+using namespace valve;
+
+constexpr std::size_t kValves = 2000;                        // 阀门数量
+constexpr std::chrono::milliseconds kIssueWindow(200);       // 命令在该时间段内均匀下发
+constexpr std::chrono::microseconds kNaiveInterval(1000);    // 固定间隔轮询的间隔
+
+std::int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * 只能查询状态的总线：每个通道按参数换算的行程时间(带±10%偏差)到达终点，
+ * 没有完成回调；统计读取事务数和读取的通道数
+ */
+class PolledBus : public IBulkValveHAL {
+public:
+    explicit PolledBus(std::size_t channels) : deadline_(channels), target_(channels), travel_(channels) {
+        for (auto& d : deadline_) d = 0;
+        for (auto& t : target_) t = ValveStatus::CLOSED;
+    }
+    std::size_t channelCount() const override { return deadline_.size(); }
+    void readStatus(std::size_t first, std::size_t count, ValveStatus* out) const override {
+        ++transactions;
+        channelsRead += count;
+        const std::int64_t now = nowNs();
+        for (std::size_t i = 0; i < count; ++i) out[i] = statusAt(first + i, now);
+    }
+    ValveStatus statusAt(std::size_t i, std::int64_t now) const {
+        return now >= deadline_[i].load(std::memory_order_acquire) ? target_[i].load() : ValveStatus::MOVING;
+    }
+    void configure(std::size_t i, const ValveParameters& params) {
+        travel_[i] = travelTime(params.closePosition, params.openPosition, params.moveSpeed).count();
+    }
+    bool startMove(std::size_t i, ValveMove target, double jitter) {
+        target_[i] = target == ValveMove::OPEN ? ValveStatus::OPENED : ValveStatus::CLOSED;
+        deadline_[i].store(nowNs() + static_cast<std::int64_t>(travel_[i] * jitter), std::memory_order_release);
+        return true;
+    }
+    std::int64_t deadline(std::size_t i) const { return deadline_[i].load(); }
+
+    mutable std::atomic<std::uint64_t> transactions{0};  // 读取事务数
+    mutable std::atomic<std::uint64_t> channelsRead{0};  // 读取的通道数
+
+private:
+    std::vector<std::atomic<std::int64_t>> deadline_;  // 各通道到达终点的时间
+    std::vector<std::atomic<ValveStatus>> target_;     // 各通道的目标状态
+    std::vector<std::int64_t> travel_;                 // 各通道的行程时间
+};
+
+/**
+ * 总线上的单个通道，不支持完成回调
+ */
+class PolledChannel : public IValveHAL {
+public:
+    PolledChannel(PolledBus& bus, std::size_t index, double jitter) : bus_(bus), index_(index), jitter_(jitter) {}
+    bool setParameters(const ValveParameters& params) override {
+        bus_.configure(index_, params);
+        return true;
+    }
+    bool move(ValveMove target) override { return bus_.startMove(index_, target, jitter_); }
+    ValveStatus getStatus() const override {
+        ++bus_.transactions;
+        ++bus_.channelsRead;
+        return bus_.statusAt(index_, nowNs());
+    }
+
+private:
+    PolledBus& bus_;      // 所属总线
+    std::size_t index_;   // 通道编号
+    double jitter_;       // 实际行程相对预计值的比例
+};
+
+/**
+ * 检查硬件拒绝的命令不登记到轮询器
+ * 拒绝时控制器已进入ERROR，登记后轮询器会等待一次永远不会发生的移动并最终报告超时
+ * @return 检查是否通过
+ */
+bool checkRejectedNotPolled() {
+    PolledBus bus(2);
+    PolledChannel accepting(bus, 0, 1.0);
+    struct Rejecting : PolledChannel {
+        using PolledChannel::PolledChannel;
+        bool move(ValveMove) override { return false; }
+    } rejecting(bus, 1, 1.0);
+
+    StatusPoller poller([](std::uint32_t, ValveStatus) {});  // 不启动，只看登记结果
+    poller.addValve(0, accepting);
+    poller.addValve(1, rejecting);
+    ValveController good(std::make_unique<ValveDriver>(accepting));
+    ValveController bad(std::make_unique<ValveDriver>(rejecting));
+    good.setPoller(&poller, 0);
+    bad.setPoller(&poller, 1);
+    good.open();
+    bad.open();
+    bool ok = poller.inflight() == 1 && !bad.isOpen();
+    std::printf("rejected command not polled: %s\n", ok ? "yes" : "no");
+    return ok;
+}
+
+/**
+ * 一轮测试的结果
+ */
+struct RunResult {
+    std::uint64_t transactions;  // 总线事务数
+    std::uint64_t channelsRead;  // 读取的通道数
+    double meanLatencyMs;        // 平均检测延迟
+    double maxLatencyMs;         // 最大检测延迟
+};
+
+/**
+ * 建立舰队、在时间窗口内下发打开命令并等待全部完成
+ * @param mode 0 固定间隔逐个轮询，1 自适应逐个轮询，2 自适应批量轮询
+ */
+RunResult runMode(int mode) {
+    // 三类执行机构：快速、中速、慢速
+    const std::shared_ptr<const ValveProfile> classes[] = {
+        std::make_shared<ValveProfile>(makeProfile(ValveParameters{Position(100), Position(0), Speed(5000)})),
+        std::make_shared<ValveProfile>(makeProfile(ValveParameters{Position(100), Position(0), Speed(1600)})),
+        std::make_shared<ValveProfile>(makeProfile(ValveParameters{Position(100), Position(0), Speed(700)})),
+    };
+
+    PolledBus bus(kValves);
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<double> jitter(0.9, 1.1);
+    std::vector<std::unique_ptr<PolledChannel>> channels;
+    std::vector<std::unique_ptr<ValveController>> fleet;
+    for (std::size_t i = 0; i < kValves; ++i) {
+        channels.push_back(std::make_unique<PolledChannel>(bus, i, jitter(rng)));
+        fleet.push_back(std::make_unique<ValveController>(std::make_unique<ValveDriver>(*channels.back())));
+        fleet.back()->setup(classes[i % 3]);
+    }
+
+    std::vector<std::int64_t> detected(kValves, 0);
+    std::atomic<std::size_t> done{0};
+    auto onComplete = [&](std::uint32_t valve, ValveStatus status) {
+        detected[valve] = nowNs();
+        fleet[valve]->reconcile(status);
+        ++done;
+    };
+
+    PollerOptions options;
+    StatusPoller poller(onComplete, options);
+    std::vector<std::atomic<bool>> naiveInflight(kValves);
+    std::thread naive;
+    std::atomic<bool> stopNaive{false};
+    if (mode == 0) {
+        // 固定间隔：每个间隔逐个读取所有未完成的阀门
+        naive = std::thread([&] {
+            while (!stopNaive) {
+                for (std::uint32_t v = 0; v < kValves; ++v) {
+                    if (!naiveInflight[v].load()) continue;
+                    ValveStatus s = bus.statusAt(v, nowNs());
+                    ++bus.transactions;
+                    ++bus.channelsRead;
+                    if (s == ValveStatus::OPENED) {
+                        naiveInflight[v] = false;
+                        onComplete(v, s);
+                    }
+                }
+                std::this_thread::sleep_for(kNaiveInterval);
+            }
+        });
+    } else {
+        if (mode == 2) {
+            poller.setBulkSource(bus);
+        }
+        for (std::uint32_t v = 0; v < kValves; ++v) {
+            poller.addValve(v, *channels[v]);
+            fleet[v]->setPoller(&poller, v);
+        }
+        poller.start();
+    }
+
+    // 在时间窗口内按随机顺序下发打开命令
+    std::vector<std::uint32_t> order(kValves);
+    for (std::uint32_t v = 0; v < kValves; ++v) order[v] = v;
+    std::shuffle(order.begin(), order.end(), rng);
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t k = 0; k < kValves; ++k) {
+        std::this_thread::sleep_until(start + kIssueWindow * k / kValves);
+        if (mode == 0) naiveInflight[order[k]] = true;
+        fleet[order[k]]->open();
+    }
+    while (done.load() < kValves) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    stopNaive = true;
+    if (naive.joinable()) naive.join();
+    poller.stop();
+
+    RunResult result{bus.transactions.load(), bus.channelsRead.load(), 0.0, 0.0};
+    for (std::size_t v = 0; v < kValves; ++v) {
+        double ms = (detected[v] - bus.deadline(v)) / 1e6;
+        result.meanLatencyMs += ms / kValves;
+        result.maxLatencyMs = std::max(result.maxLatencyMs, ms);
+        if (!fleet[v]->isOpen()) std::printf("valve %zu not opened\n", v);
+    }
+    return result;
+}
+
+} // namespace
+
+/**
+ * 状态轮询基准测试
+ * 两千个不支持完成回调的阀门(三类执行机构，行程约20/60/140毫秒，实际偏差±10%)，
+ * 对比固定1毫秒间隔逐个轮询与自适应轮询(逐个/批量)的总线事务数和完成检测延迟
+ */
+int main() {
+    const char* names[] = {"fixed 1 ms, per valve", "adaptive, per valve", "adaptive, bulk reads"};
+    RunResult baseline{};
+    for (int mode = 0; mode < 3; ++mode) {
+        RunResult r = runMode(mode);
+        if (mode == 0) baseline = r;
+        std::printf("%-24s transactions %8llu (x%.3f), channels read %8llu, latency mean %.2f ms max %.2f ms\n",
+                    names[mode], static_cast<unsigned long long>(r.transactions),
+                    static_cast<double>(r.transactions) / baseline.transactions,
+                    static_cast<unsigned long long>(r.channelsRead), r.meanLatencyMs, r.maxLatencyMs);
+    }
+    return checkRejectedNotPolled() ? 0 : 1;
+}
@@ -0,0 +1,47 @@
+#include "../include/valve_codec.h"  // 包含紧凑编码定义
+#include "bench_common.h"            // 基准测试辅助工具
+#include <random>                    // 随机数支持
+#include <vector>                    // 动态数组支持
+
+/**
+ * 紧凑编码基准测试
+ * 十万个阀门的状态位图编码、解码和单点读取，并输出与逐字节状态数组的大小对比
+ */
+int main() {
+    using namespace valve;
+
+    constexpr std::size_t kValves = 100000;  // 阀门数量
+    constexpr std::size_t kRuns = 200;       // 重复次数
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> pick(0, 4);
+    std::vector<ValveStatus> status(kValves);
+    for (auto& s : status) {
+        s = static_cast<ValveStatus>(pick(rng));
+    }
+
+    std::vector<std::uint64_t> planes(statusBitmapWords(kValves));
+    bench::report("encode bitmap (100k)", bench::measureNs(kRuns, [&] {
+        encodeStatusBitmap(status.data(), kValves, planes.data());
+        bench::keep(planes);
+    }));
+
+    std::vector<ValveStatus> decoded(kValves);
+    bench::report("decode bitmap (100k)", bench::measureNs(kRuns, [&] {
+        decodeStatusBitmap(planes.data(), kValves, decoded.data());
+        bench::keep(decoded);
+    }));
+
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < kValves; ++i) {
+        mismatches += decoded[i] != status[i];
+        mismatches += statusAt(planes.data(), kValves, i) != status[i];
+    }
+
+    std::uint32_t word = encodeCommand(ValveCommand::CLOSE, 123456789);
+    mismatches += commandOf(word) != ValveCommand::CLOSE || sequenceOf(word) != 123456789;
+
+    std::printf("bitmap bytes: %zu (byte array: %zu, int enum: %zu), mismatches: %zu\n",
+                planes.size() * sizeof(std::uint64_t), kValves, kValves * sizeof(int), mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+#include "../include/valve_interlock.h"  // 包含联锁规则引擎定义
+#include "bench_common.h"                // 基准测试辅助工具
+#include <vector>                        // 动态数组支持
+
+namespace {
+
+/**
+ * 检查位置未确认的阀门按可能打开处理，以及启动时已存在的违反会被通知
+ * @return 检查是否全部通过
+ */
+bool checkFailClosed() {
+    using namespace valve;
+    bool ok = true;
+
+    // A和B互斥打开：B处于UNKNOWN或ERROR时不得打开A，B确认关闭后才允许
+    InterlockEngine exclusive(2);
+    exclusive.addRule(InterlockEngine::RuleKind::EXCLUSIVE_OPEN, 0, 1);
+    exclusive.finalize();
+    ok = ok && !exclusive.authorize(0, ValveMove::OPEN);
+    exclusive.onStatusChange(1, ValveStatus::ERROR);
+    ok = ok && !exclusive.authorize(0, ValveMove::OPEN);
+    exclusive.onStatusChange(1, ValveStatus::CLOSED);
+    ok = ok && exclusive.authorize(0, ValveMove::OPEN);
+    std::printf("exclusive open vetoed while partner unknown/error: %s\n", ok ? "yes" : "no");
+
+    // finalize()前记录的状态已违反规则时，finalize()通知违反
+    InterlockEngine startup(2);
+    startup.addRule(InterlockEngine::RuleKind::EXCLUSIVE_OPEN, 0, 1);
+    startup.onStatusChange(0, ValveStatus::OPENED);
+    startup.onStatusChange(1, ValveStatus::OPENED);
+    std::size_t reported = 0;
+    startup.setViolationHandler([&](std::uint32_t, std::uint32_t) { ++reported; });
+    startup.finalize();
+    bool startupOk = reported == 1 && startup.violatedCount() == 1;
+    std::printf("startup violation reported: %s\n", startupOk ? "yes" : "no");
+    return ok && startupOk;
+}
+
+} // namespace
+
+/**
+ * 联锁规则引擎基准测试
+ * 一万个阀门两两互斥，测量命令检查和状态更新的单次耗时
+ */
+int main() {
+    using namespace valve;
+
+    constexpr std::uint32_t kValves = 10000;  // 阀门数量
+
+    InterlockEngine engine(kValves);
+    for (std::uint32_t v = 0; v + 1 < kValves; v += 2) {
+        engine.addRule(InterlockEngine::RuleKind::EXCLUSIVE_OPEN, v, v + 1);
+    }
+    engine.finalize();
+    for (std::uint32_t v = 0; v < kValves; ++v) {
+        engine.onStatusChange(v, ValveStatus::CLOSED);  // 全部确认关闭
+    }
+
+    // 每对中的偶数阀门打开再关闭
+    std::uint64_t allowed = 0;
+    double ns = bench::measureNs(1, [&] {
+        for (std::uint32_t v = 0; v < kValves; v += 2) {
+            allowed += engine.authorize(v, ValveMove::OPEN);
+            engine.onStatusChange(v, ValveStatus::OPENED);
+            allowed += engine.authorize(v, ValveMove::CLOSE);
+            engine.onStatusChange(v, ValveStatus::CLOSED);
+        }
+    });
+    bench::report("authorize + status change (per command)", ns / kValves);
+
+    // 奇数阀门在同伴打开时被否决
+    for (std::uint32_t v = 0; v < kValves; v += 2) {
+        engine.authorize(v, ValveMove::OPEN);
+        engine.onStatusChange(v, ValveStatus::OPENED);
+    }
+    std::uint64_t vetoed = 0;
+    ns = bench::measureNs(1, [&] {
+        for (std::uint32_t v = 1; v < kValves; v += 2) {
+            vetoed += !engine.authorize(v, ValveMove::OPEN);
+        }
+    });
+    bench::report("vetoed authorize", ns / (kValves / 2));
+    std::printf("allowed=%llu vetoed=%llu violated=%zu\n", static_cast<unsigned long long>(allowed),
+                static_cast<unsigned long long>(vetoed), engine.violatedCount());
+
+    bool ok = allowed == kValves && vetoed == kValves / 2 && engine.violatedCount() == 0;
+    return (ok && checkFailClosed()) ? 0 : 1;
+}
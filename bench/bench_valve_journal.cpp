@@ -0,0 +1,146 @@
+#include "../include/valve_journal.h"  // 包含事件日志定义
+#include "bench_common.h"              // 基准测试辅助工具
+#include <filesystem>                  // 目录清理
+#include <thread>                      // 线程支持
+#include <vector>                      // 动态数组支持
+
+namespace {
+
+constexpr std::size_t kThreads = 4;              // 写入线程数
+constexpr std::size_t kPerThread = 500000;       // 每个线程写入的记录数
+
+/**
+ * 多个线程并发追加记录
+ * @return 总耗时(纳秒)
+ */
+double appendAll(valve::ValveJournal& journal, std::uint32_t valves) {
+    using namespace valve;
+    return bench::measureNs(1, [&] {
+        std::vector<std::thread> writers;
+        for (std::size_t t = 0; t < kThreads; ++t) {
+            writers.emplace_back([&journal, t, valves] {
+                for (std::size_t i = 0; i < kPerThread; ++i) {
+                    auto valveId = static_cast<std::uint32_t>((t * kPerThread + i) % valves);
+                    journal.append(i % 2 == 0 ? JournalEventKind::COMMAND : JournalEventKind::STATUS, valveId,
+                                   i % 2 == 0 ? static_cast<std::uint8_t>(ValveCommand::OPEN)
+                                              : static_cast<std::uint8_t>(ValveStatus::OPENED),
+                                   static_cast<std::uint32_t>(i / 2 + 1));
+                }
+            });
+        }
+        for (auto& writer : writers) {
+            writer.join();
+        }
+    });
+}
+
+/**
+ * 环形回绕：环形容量远小于写入量，写入方领先落盘位置一整个环形时等待组提交，
+ * 关闭后最后一个环形内的记录应连续且以最后一个LSN结尾，没有记录被未落盘地覆盖
+ * @return 是否通过检查
+ */
+bool wrapAround() {
+    using namespace valve;
+    const std::string directory = "bench_valve_journal_wrap";
+    std::filesystem::remove_all(directory);
+    ValveJournal journal;
+    JournalOptions options;
+    options.segmentCount = 4;
+    options.recordsPerSegment = 1u << 14;  // 共64K条，写入2M条回绕约30次
+    if (!journal.open(directory, options)) {
+        std::printf("failed to open journal\n");
+        return false;
+    }
+    const double totalNs = appendAll(journal, 10000);
+    const double events = static_cast<double>(kThreads * kPerThread);
+    bench::report("append wrapping (per event, 4 threads)", totalNs / events);
+    const std::uint64_t last = journal.nextLsn() - 1;
+    journal.close();
+
+    JournalReader reader;
+    reader.open(directory);
+    std::uint64_t expected = 0;
+    std::size_t gaps = 0;
+    std::size_t records = reader.scan([&](std::uint64_t lsn, const JournalRecord&) {
+        if (expected != 0 && lsn != expected) {
+            ++gaps;
+        }
+        expected = lsn + 1;
+    });
+    std::printf("wrap: records %zu, last lsn %llu (expected %llu), gaps %zu\n", records,
+                static_cast<unsigned long long>(expected - 1), static_cast<unsigned long long>(last), gaps);
+    std::filesystem::remove_all(directory);
+    return gaps == 0 && expected - 1 == last && records > 3 * options.recordsPerSegment;
+}
+
+/**
+ * 未打开和已关闭的日志：append()不写入并返回kInvalidLsn
+ * @return 是否通过检查
+ */
+bool closedAppend() {
+    using namespace valve;
+    const std::string directory = "bench_valve_journal_closed";
+    std::filesystem::remove_all(directory);
+    ValveJournal journal;
+    bool ok = journal.append(JournalEventKind::STATUS, 1, 0, 0) == ValveJournal::kInvalidLsn;
+    JournalOptions options;
+    options.segmentCount = 2;
+    options.recordsPerSegment = 1024;
+    ok = ok && journal.open(directory, options) && journal.append(JournalEventKind::STATUS, 1, 0, 0) == 0;
+    journal.close();
+    ok = ok && journal.append(JournalEventKind::STATUS, 1, 0, 0) == ValveJournal::kInvalidLsn;
+    std::filesystem::remove_all(directory);
+    std::printf("append before open / after close rejected: %s\n", ok ? "yes" : "no");
+    return ok;
+}
+
+} // namespace
+
+/**
+ * 事件日志基准测试
+ * 多个线程并发追加记录，测量吞吐量和单次追加耗时，
+ * 然后按时间范围、单个阀门查询并重放；最后测量环形回绕时的追加
+ */
+int main() {
+    using namespace valve;
+
+    constexpr std::uint32_t kValves = 10000;         // 阀门数量
+    const std::string directory = "bench_valve_journal";
+    std::filesystem::remove_all(directory);
+
+    ValveJournal journal;
+    JournalOptions options;
+    options.segmentCount = 16;
+    options.recordsPerSegment = 1u << 18;  // 共4M条，本测试不回绕；写满的7段有阀门索引，最后一段逐条扫描
+    if (!journal.open(directory, options)) {
+        std::printf("failed to open journal\n");
+        return 1;
+    }
+
+    const double totalNs = appendAll(journal, kValves);
+    const double events = static_cast<double>(kThreads * kPerThread);
+    bench::report("append (per event, 4 threads)", totalNs / events);
+    std::printf("%-40s %12.0f events/s\n", "append throughput", events / (totalNs / 1e9));
+
+    bench::report("group commit to durable", bench::measureNs(1, [&] { journal.waitDurable(journal.nextLsn() - 1); }));
+    journal.close();
+
+    JournalReader reader;
+    reader.open(directory);
+    std::size_t all = 0;
+    bench::report("scan all", bench::measureNs(1, [&] {
+        all = reader.scan([](std::uint64_t, const JournalRecord&) {});
+    }));
+    std::size_t one = 0;
+    bench::report("query single valve", bench::measureNs(1, [&] {
+        one = reader.queryValve(42, [](std::uint64_t, const JournalRecord&) {});
+    }));
+    std::vector<ValveSnapshotRecord> state;
+    bench::report("replay (10k valves)", bench::measureNs(1, [&] { state = replayJournal(reader, kValves); }));
+
+    std::printf("records: %zu, valve 42: %zu, valve 42 status: %u\n", all, one, state[42].status);
+    std::filesystem::remove_all(directory);
+    const bool wrapped = wrapAround();
+    const bool guarded = closedAppend();
+    return all == kThreads * kPerThread && wrapped && guarded ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+#include "../include/valve_controller.h"  // 包含控制器接口定义
+#include "../include/valve_profile.h"     // 包含阀门参数配置定义
+#include "bench_common.h"                 // 基准测试辅助工具
+#include <memory>                         // 智能指针支持
+
+namespace {
+
+/**
+ * 创建使用模拟器的控制器舰队
+ */
+std::vector<std::unique_ptr<valve::ValveController>> makeFleet(std::size_t count) {
+    using namespace valve;
+    std::vector<std::unique_ptr<ValveController>> fleet;
+    fleet.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        fleet.push_back(std::make_unique<ValveController>(
+            std::make_unique<ValveDriver>(ValveHALFactory::createHAL("simulator"))));
+    }
+    return fleet;
+}
+
+} // namespace
+
+/**
+ * 阀门参数配置基准测试
+ * 十万个阀门：逐个以参数初始化(每个阀门计算并持有自己的配置)，
+ * 与以类别目录中的共享配置初始化对比
+ */
+int main() {
+    using namespace valve;
+
+    constexpr std::size_t kValves = 100000;  // 阀门数量
+    constexpr ValveParameters kGateValve{Position(100), Position(0), Speed(25)};
+    static_assert(validateParameters(kGateValve) == ParameterError::NONE, "gate valve parameters");
+    static_assert(makeProfile(kGateValve).travelTime == std::chrono::seconds(4), "gate valve travel time");
+    static_assert(validateParameters(ValveParameters{Position(5), Position(5), Speed(1)}) == ParameterError::ZERO_STROKE,
+                  "zero stroke must be rejected");
+    static_assert(Position(8388607).raw() == 8388607 * 256 && Position(-8388608).raw() == INT32_MIN,
+                  "position range boundaries");
+
+    // 超出定点范围的整数单位在运行时抛出异常，而不是有符号溢出
+    volatile int tooLarge = static_cast<int>(Position::kMaxUnits) + 1;
+    bool outOfRange = false;
+    try {
+        Position overflow(tooLarge);
+        bench::keep(overflow);
+    } catch (const std::out_of_range&) {
+        outOfRange = true;
+    }
+
+    auto fleet = makeFleet(kValves);
+    bool ok = true;
+    bench::report("setup with own parameters (per valve)", bench::measureNs(1, [&] {
+        for (auto& controller : fleet) {
+            ok = controller->setup(kGateValve) && ok;
+        }
+    }) / kValves);
+
+    ValveClassCatalog catalog;
+    auto gate = catalog.define("gate", kGateValve);
+    bench::report("setup with shared class (per valve)", bench::measureNs(1, [&] {
+        for (auto& controller : fleet) {
+            ok = controller->setup(gate) && ok;
+        }
+    }) / kValves);
+
+    std::size_t shared = 0;
+    for (auto& controller : fleet) {
+        shared += controller->profile() == gate.get();
+    }
+    bool rejected = !fleet[0]->setup(ValveParameters{Position(0), Position(100), Speed(0)});
+    std::printf("profile bytes: %zu, shared by: %zu controllers, travel: %lld ms, invalid rejected: %s\n",
+                sizeof(ValveProfile), shared,
+                static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                    fleet[0]->expectedTravelTime()).count()),
+                rejected ? "yes" : "no");
+    std::printf("position %d units rejected: %s\n", static_cast<int>(tooLarge), outOfRange ? "yes" : "no");
+    return (ok && rejected && outOfRange) ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+#include "../include/valve_controller.h"  // 包含控制器接口定义
+#include "../include/valve_recipe.h"      // 包含配方引擎定义
+#include "../include/valve_interlock.h"   // 包含联锁规则引擎定义
+#include "bench_common.h"                 // 基准测试辅助工具
+#include <memory>                         // 智能指针支持
+
+namespace {
+
+/**
+ * 立即完成的硬件抽象层
+ * move调用内同步报告最终状态，使测量结果只包含编排开销；
+ * inverted为true时报告与命令相反的状态，模拟卡阀
+ */
+class InstantHAL : public valve::IValveHAL {
+public:
+    explicit InstantHAL(bool inverted = false) : inverted_(inverted) {}
+    bool setParameters(const valve::ValveParameters&) override { return true; }
+    bool move(valve::ValveMove target) override {
+        status_ = ((target == valve::ValveMove::OPEN) != inverted_) ? valve::ValveStatus::OPENED
+                                                                    : valve::ValveStatus::CLOSED;
+        if (callback_) {
+            callback_(status_);  // 同步完成
+        }
+        return true;
+    }
+    valve::ValveStatus getStatus() const override { return status_; }
+    bool setCompletionCallback(CompletionCallback callback) override {
+        callback_ = std::move(callback);
+        return true;
+    }
+
+private:
+    bool inverted_;
+    valve::ValveStatus status_ = valve::ValveStatus::UNKNOWN;
+    CompletionCallback callback_;
+};
+
+/**
+ * 检查不会完成的步骤立即失败，而不是等到30秒超时
+ * 阀门0被联锁否决，阀门1到达相反状态
+ */
+bool failsFast() {
+    using namespace valve;
+    ValveController blocker(std::make_unique<ValveDriver>(std::make_unique<InstantHAL>()));
+    ValveController vetoed(std::make_unique<ValveDriver>(std::make_unique<InstantHAL>()));
+    ValveController stuck(std::make_unique<ValveDriver>(std::make_unique<InstantHAL>(true)));
+    InterlockEngine interlock(2);
+    interlock.addRule(InterlockEngine::RuleKind::EXCLUSIVE_OPEN, 0, 1);
+    interlock.finalize();
+    vetoed.setInterlock(&interlock, 0);
+    blocker.setInterlock(&interlock, 1);
+    vetoed.close();
+    blocker.close();
+    blocker.open();  // 阀门1打开后阀门0不得打开
+
+    RecipeEngine engine({&vetoed, &stuck});
+    bool ok = true;
+    for (std::uint32_t valve : {0u, 1u}) {
+        Recipe recipe;
+        recipe.addStep(valve, ValveMove::OPEN);
+        RecipeReport report = engine.run(recipe);
+        ok = ok && !report.success && report.steps[0].outcome == StepOutcome::FAILED &&
+             report.totalNs < 1000000000LL;
+    }
+    std::printf("veto / opposite state fail fast: %s\n", ok ? "yes" : "no");
+    return ok;
+}
+
+} // namespace
+
+/**
+ * 配方引擎编排开销基准测试
+ * 1000个步骤组成10条并行链，每条链100步，每步操作不同的阀门
+ */
+int main() {
+    using namespace valve;
+
+    constexpr std::uint32_t kChains = 10;         // 并行分支数
+    constexpr std::uint32_t kChainLength = 100;   // 每条分支的步骤数
+    constexpr std::uint32_t kValves = kChains * kChainLength;
+    constexpr std::size_t kRuns = 200;            // 重复执行次数
+
+    std::vector<std::unique_ptr<ValveController>> controllers;
+    std::vector<ValveController*> fleet;
+    for (std::uint32_t i = 0; i < kValves; ++i) {
+        controllers.push_back(std::make_unique<ValveController>(
+            std::make_unique<ValveDriver>(std::make_unique<InstantHAL>())));
+        controllers.back()->setup(ValveParameters{Position(100), Position(0), Speed(10)});
+        fleet.push_back(controllers.back().get());
+    }
+
+    Recipe recipe;
+    for (std::uint32_t chain = 0; chain < kChains; ++chain) {
+        for (std::uint32_t k = 0; k < kChainLength; ++k) {
+            std::uint32_t valve = chain * kChainLength + k;
+            ValveMove action = (k % 2 == 0) ? ValveMove::CLOSE : ValveMove::OPEN;
+            std::uint32_t step = recipe.addStep(valve, action);
+            if (k > 0) {
+                recipe.addDependency(step, step - 1);  // 链内顺序依赖
+            }
+        }
+    }
+
+    RecipeEngine engine(fleet);
+    RecipeReport last;
+    double ns = bench::measureNs(kRuns, [&] { last = engine.run(recipe); });
+
+    std::printf("steps: %u, success: %s\n", kValves, last.success ? "yes" : "no");
+    bench::report("recipe run (1000 steps)", ns);
+    bench::report("per step", ns / kValves);
+    bench::report("ready->issued wait per step", static_cast<double>(last.orchestrationNs) / kValves);
+    return (last.success && failsFast()) ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+#include "../include/valve_controller.h"  // 包含控制器接口定义
+#include "../include/valve_snapshot.h"    // 包含快照定义
+#include "bench_common.h"                 // 基准测试辅助工具
+#include <cstdio>                         // remove支持
+#include <memory>                         // 智能指针支持
+
+namespace {
+
+/**
+ * 创建使用模拟器的控制器舰队
+ */
+std::vector<std::unique_ptr<valve::ValveController>> makeFleet(std::size_t count) {
+    using namespace valve;
+    std::vector<std::unique_ptr<ValveController>> fleet;
+    fleet.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        fleet.push_back(std::make_unique<ValveController>(
+            std::make_unique<ValveDriver>(ValveHALFactory::createHAL("simulator"))));
+    }
+    return fleet;
+}
+
+std::vector<valve::ValveController*> pointers(const std::vector<std::unique_ptr<valve::ValveController>>& fleet) {
+    std::vector<valve::ValveController*> result;
+    result.reserve(fleet.size());
+    for (const auto& controller : fleet) {
+        result.push_back(controller.get());
+    }
+    return result;
+}
+
+} // namespace
+
+/**
+ * 快照热启动基准测试
+ * 十万个阀门：写入快照，然后在新建的舰队上读取快照并用硬件状态校正
+ */
+int main() {
+    using namespace valve;
+
+    constexpr std::size_t kValves = 100000;  // 阀门数量
+    const std::string path = "bench_valve_snapshot.bin";
+
+    // 构造运行中的舰队，一半已打开一半已关闭
+    auto running = makeFleet(kValves);
+    auto runningPtrs = pointers(running);
+    for (std::size_t i = 0; i < kValves; ++i) {
+        ValveStatus status = (i % 2 == 0) ? ValveStatus::OPENED : ValveStatus::CLOSED;
+        std::uint8_t value = static_cast<std::uint8_t>(status);
+        running[i]->restore(ValveSnapshotRecord{value, value, 0, 0, static_cast<std::uint32_t>(i)});
+    }
+
+    bool saved = false;
+    bench::report("save snapshot (100k)", bench::measureNs(1, [&] { saved = saveSnapshot(path, runningPtrs); }));
+
+    // 模拟服务重启：新舰队全部处于UNKNOWN状态
+    auto restarted = makeFleet(kValves);
+    auto restartedPtrs = pointers(restarted);
+    std::size_t restored = 0;
+    std::size_t settled = 0;
+    double ns = bench::measureNs(1, [&] {
+        restored = loadSnapshot(path, restartedPtrs);
+        settled = reconcileFleet(restartedPtrs, nullptr);
+    });
+    bench::report("load + reconcile (100k)", ns);
+
+    std::printf("saved: %s, restored: %zu, settled: %zu\n", saved ? "yes" : "no", restored, settled);
+    std::remove(path.c_str());
+    return (saved && settled == kValves) ? 0 : 1;
+}
@@ -0,0 +1,341 @@
+// dzn-runtime -- Dezyne runtime library
+//
+// This file is part of dzn-runtime.
+//
+// All rights reserved.
+//
+//
+// Commentary:
+//
+// Native stackful contexts: switching between coroutines saves the
+// callee-saved registers on the stack being left and restores them from
+// the stack being entered.  x86-64 and aarch64 use a hand written switch
+// routine, other platforms fall back to ucontext.
+//
+// Code:
+
+#include <dzn/config.hh>
+#include <dzn/context.hh>
+
+#if DZN_NATIVE_CONTEXT
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if (defined (__x86_64__) || defined (__aarch64__)) && defined (__ELF__)
+#define DZN_CONTEXT_ASM 1
+#else
+#define DZN_CONTEXT_ASM 0
+#include <ucontext.h>
+#endif
+
+#if DZN_CONTEXT_ASM
+// void *dzn_context_switch (void **from, void *to, void *arg)
+//
+// Save the callee-saved registers on the current stack, store the stack
+// pointer in *FROM, switch to stack TO and restore its registers.  ARG is
+// passed on as the return value and as the first argument, so that a
+// fresh stack enters its entry function with ARG.
+extern "C" void *dzn_context_switch (void **from, void *to, void *arg);
+
+#if defined (__x86_64__)
+asm (R"(
+        .text
+        .globl  dzn_context_switch
+        .hidden dzn_context_switch
+        .type   dzn_context_switch, @function
+        .p2align 4
+dzn_context_switch:
+        pushq   %rbp
+        pushq   %rbx
+        pushq   %r12
+        pushq   %r13
+        pushq   %r14
+        pushq   %r15
+        subq    $8, %rsp
+        stmxcsr (%rsp)
+        fnstcw  4(%rsp)
+        movq    %rsp, (%rdi)
+        movq    %rsi, %rsp
+        ldmxcsr (%rsp)
+        fldcw   4(%rsp)
+        addq    $8, %rsp
+        popq    %r15
+        popq    %r14
+        popq    %r13
+        popq    %r12
+        popq    %rbx
+        popq    %rbp
+        movq    %rdx, %rax
+        movq    %rdx, %rdi
+        ret
+        .size   dzn_context_switch, .-dzn_context_switch
+)");
+#elif defined (__aarch64__)
+asm (R"(
+        .text
+        .globl  dzn_context_switch
+        .hidden dzn_context_switch
+        .type   dzn_context_switch, %function
+        .p2align 4
+dzn_context_switch:
+        sub     sp, sp, #176
+        stp     x19, x20, [sp, #0]
+        stp     x21, x22, [sp, #16]
+        stp     x23, x24, [sp, #32]
+        stp     x25, x26, [sp, #48]
+        stp     x27, x28, [sp, #64]
+        stp     x29, x30, [sp, #80]
+        stp     d8, d9, [sp, #96]
+        stp     d10, d11, [sp, #112]
+        stp     d12, d13, [sp, #128]
+        stp     d14, d15, [sp, #144]
+        mov     x9, sp
+        str     x9, [x0]
+        mov     sp, x1
+        ldp     x19, x20, [sp, #0]
+        ldp     x21, x22, [sp, #16]
+        ldp     x23, x24, [sp, #32]
+        ldp     x25, x26, [sp, #48]
+        ldp     x27, x28, [sp, #64]
+        ldp     x29, x30, [sp, #80]
+        ldp     d8, d9, [sp, #96]
+        ldp     d10, d11, [sp, #112]
+        ldp     d12, d13, [sp, #128]
+        ldp     d14, d15, [sp, #144]
+        add     sp, sp, #176
+        mov     x0, x2
+        ret
+        .size   dzn_context_switch, .-dzn_context_switch
+)");
+#endif
+
+#else // !DZN_CONTEXT_ASM
+// The ucontext of a suspended context lives on its own stack; its
+// address serves as the stack pointer.
+static void *
+dzn_context_switch (void **from, void *to, void *arg)
+{
+  ucontext_t self;
+  *from = &self;
+  if (swapcontext (&self, static_cast<ucontext_t *> (to)))
+    std::abort ();
+  return arg;
+}
+#endif // !DZN_CONTEXT_ASM
+
+namespace dzn
+{
+static thread_local context *current_context;
+
+context &
+context::current ()
+{
+  // the thread itself, when it is not running any native context
+  static thread_local context root;
+  if (!current_context)
+    current_context = &root;
+  return *current_context;
+}
+
+context::~context ()
+{
+  finish ();
+  deallocate ();
+  if (current_context == this)
+    current_context = nullptr;
+}
+
+void
+context::finish ()
+{
+  if (!live)
+    {
+      state = FINAL;
+      return;
+    }
+  context &self = current ();
+  assert (&self != this);
+  state = FINAL;
+  link = &self;
+  transfer (self, *this);
+}
+
+void
+context::block ()
+{
+  assert (this == &current ());
+  if (link && link != this)
+    resume (*this, *link);
+}
+
+void
+context::release ()
+{
+  if (state != INITIAL && state != BLOCKED)
+    throw std::runtime_error ("not allowed to release a call which is " +
+                              to_string (state));
+  context &self = current ();
+  if (&self != this)
+    self.link = this;
+}
+
+void
+context::call (context &c)
+{
+  if (state != INITIAL && state != BLOCKED)
+    throw std::runtime_error ("not allowed to release a call which is " +
+                              to_string (state));
+  link = &c;
+  resume (c, *this);
+}
+
+void
+context::yield (context &to)
+{
+  if (&to == this) return;
+  to.link = link;
+  resume (*this, to);
+}
+
+// Not inlined: the stack of a context whose work returned stays in
+// entry, and a pump may resume it from another thread; entry must not
+// keep a thread local address computed before the switch.
+#if defined (__GNUC__)
+__attribute__ ((noinline))
+#endif
+void
+context::transfer (context &from, context &to)
+{
+  current_context = &to;
+  if (from.state != FINAL) from.state = BLOCKED;
+  if (to.state != FINAL) to.state = RELEASED;
+  dzn_context_switch (&from.sp, to.sp, &to);
+}
+
+void
+context::resume (context &from, context &to)
+{
+  transfer (from, to);
+  if (from.state == FINAL)
+    throw forced_unwind ();
+  if (from.exception)
+    {
+      std::exception_ptr exception = from.exception;
+      from.exception = nullptr;
+      std::rethrow_exception (exception);
+    }
+}
+
+void
+context::entry (void *arg)
+{
+  context &self = *static_cast<context *> (arg);
+  self.live = true;
+  while (self.state != FINAL)
+    {
+      try
+        {
+          std::function<void (context &)> yield ([&self] (context & c) { self.yield (c); });
+          if (self.work) self.work (yield);
+        }
+      catch (forced_unwind const&)
+        {
+          debug.rdbuf () && debug << "ignoring forced_unwind" << std::endl;
+        }
+      catch (...)
+        {
+          if (self.link) self.link->exception = std::current_exception ();
+        }
+      if (self.state == FINAL) break;
+      transfer (self, *self.link);
+    }
+  self.live = false;
+  transfer (self, *self.link);
+  std::abort ();
+}
+
+#if !DZN_CONTEXT_ASM
+static void
+ucontext_entry (unsigned high, unsigned low)
+{
+  std::uintptr_t self = (static_cast<std::uintptr_t> (high) << 16 << 16) | low;
+  void (*entry) (void *);
+  std::memcpy (&entry, reinterpret_cast<void *> (self), sizeof (entry));
+  entry (*reinterpret_cast<void **> (self + sizeof (entry)));
+}
+#endif
+
+void
+context::allocate (size_t size)
+{
+  void *memory;
+  if (pool)
+    {
+      memory = pool->allocate ();
+      stack_size = pool->size ();
+      guard_size = pool->guard ();
+    }
+  else
+    {
+      memory = stack_pool::map (size, stack_size);
+      guard_size = stack_pool::page_size ();
+    }
+  stack = memory;
+
+  char *top = static_cast<char *> (memory) + stack_size;
+  void (*start) (void *) = &context::entry;
+#if DZN_CONTEXT_ASM && defined (__x86_64__)
+  // fake return address for entry, its address for the ret, rbp, rbx,
+  // r12-r15 and mxcsr/x87 control word
+  void **frame = reinterpret_cast<void **> (top) - 9;
+  std::memset (frame, 0, 9 * sizeof (void *));
+  frame[7] = reinterpret_cast<void *> (start);
+  std::uint32_t mxcsr = 0x1f80;
+  std::uint16_t fpucw = 0x037f;
+  std::memcpy (frame, &mxcsr, sizeof (mxcsr));
+  std::memcpy (reinterpret_cast<char *> (frame) + 4, &fpucw, sizeof (fpucw));
+  sp = frame;
+#elif DZN_CONTEXT_ASM && defined (__aarch64__)
+  // x19-x28, x29, x30 (entry) and d8-d15
+  void **frame = reinterpret_cast<void **> (top - 176);
+  std::memset (frame, 0, 176);
+  frame[11] = reinterpret_cast<void *> (start);
+  sp = frame;
+#else
+  // entry and its argument, then the ucontext to start from
+  char *base = top - 64;
+  std::memcpy (base, &start, sizeof (start));
+  void *self = this;
+  std::memcpy (base + sizeof (start), &self, sizeof (self));
+  ucontext_t *uc = reinterpret_cast<ucontext_t *>
+    ((reinterpret_cast<std::uintptr_t> (base) - sizeof (ucontext_t)) & ~std::uintptr_t (15));
+  getcontext (uc);
+  uc->uc_stack.ss_sp = static_cast<char *> (memory) + guard_size;
+  uc->uc_stack.ss_size = reinterpret_cast<char *> (uc) - static_cast<char *> (memory) - guard_size;
+  uc->uc_link = nullptr;
+  std::uintptr_t address = reinterpret_cast<std::uintptr_t> (base);
+  makecontext (uc, reinterpret_cast<void (*) ()> (&ucontext_entry), 2,
+               static_cast<unsigned> (address >> 16 >> 16),
+               static_cast<unsigned> (address));
+  sp = uc;
+#endif
+}
+
+void
+context::deallocate ()
+{
+  if (stack && pool)
+    pool->deallocate (stack);
+  else if (stack)
+    stack_pool::unmap (stack, stack_size);
+  stack = nullptr;
+  stack_size = 0;
+}
+}
+
+#endif // DZN_NATIVE_CONTEXT
+//version: 2.18.3
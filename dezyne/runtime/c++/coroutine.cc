@@ -15,23 +15,40 @@
 
 namespace dzn
 {
-coroutine::coroutine (size_t id, std::function<void()>&& worker)
+// The work is kept in the coroutine, so that the context holds no
+// more than this pointer and does not allocate.
+coroutine::coroutine (size_t id, std::function<void()>&& worker,
+                      dzn::stack_pool *stacks)
   : id (id)
-  , context ([this, worker] (dzn::yield &yield)
+  , work (std::move (worker))
+#if HAVE_BOOST_COROUTINE
+  , context ([this] (dzn::yield &yield)
   {
     this->yield = std::move (yield);
-    worker ();
+    this->work ();
   })
+#else
+  , context ([this] (dzn::yield &yield)
+  {
+    this->yield = std::move (yield);
+    this->work ();
+  }, stacks)
+#endif
   , port ()
   , finished ()
   , skip_block ()
+  , previous ()
+  , next ()
 {}
 coroutine::coroutine ()
   : id (0)
+  , work ()
   , context ()
   , port ()
   , finished ()
   , skip_block ()
+  , previous ()
+  , next ()
 {}
 void coroutine::yield_to (dzn::coroutine &that)
 {
@@ -25,5 +25,38 @@
 /* #undef HAVE_BOOST_COROUTINE */
 #endif
 
+#ifndef DZN_NATIVE_CONTEXT
+/* Define to 1 to run coroutines on their own stack in the pump thread,
+   to 0 to run each coroutine on a thread of its own. */
+#if defined (__unix__) || defined (__APPLE__)
+#define DZN_NATIVE_CONTEXT 1
+#else
+#define DZN_NATIVE_CONTEXT 0
+#endif
+#endif
+
+#ifndef DZN_CONTEXT_STACK_SIZE
+/* Define the stack size in bytes of a native coroutine context. */
+#define DZN_CONTEXT_STACK_SIZE (256 * 1024)
+#endif
+
+#ifndef DZN_STACK_POOL_HIGH_WATER
+/* Define the number of unused coroutine stacks a pump keeps for
+   reuse. */
+#define DZN_STACK_POOL_HIGH_WATER 64
+#endif
+
+#ifndef DZN_THREAD_POOL_LIMIT
+/* Define the maximum number of threads of the dzn::thread::pool behind
+   std_async. */
+#define DZN_THREAD_POOL_LIMIT 256
+#endif
+
+#ifndef DZN_LOCATOR_SLOTS
+/* Define the number of services with the default key a dzn::locator
+   holds without allocating. */
+#define DZN_LOCATOR_SLOTS 8
+#endif
+
 #endif /* DZN_CONFIG_HH */
 //version: 2.18.3
@@ -16,10 +16,11 @@
 #define DZN_CONTEXT_HH
 
 #include <dzn/config.hh>
-#include <dzn/std-async.hh>
+#include <dzn/stack-pool.hh>
 
 #include <cassert>
 #include <condition_variable>
+#include <exception>
 #include <functional>
 #include <future>
 #include <map>
@@ -28,6 +29,9 @@
 #include <thread>
 #include <iostream>
 
+#if !DZN_NATIVE_CONTEXT
+#include <dzn/std-async.hh>
+
 namespace dzn
 {
 extern std::ostream debug;
@@ -55,19 +59,25 @@ class context
   std::function<void (std::function<void (context &)>&)> work;
   std::mutex mutex;
   std::condition_variable condition;
-  std::future<void> future;
+  dzn::completion done;
 public:
-  struct forced_unwind: public std::runtime_error
+  // Thrown at every coroutine release; no message, so that unwinding
+  // does not allocate.
+  struct forced_unwind: public std::exception
   {
-    forced_unwind (): std::runtime_error ("forced_unwind") {}
+    char const *what () const noexcept
+    {
+      return "forced_unwind";
+    }
   };
+  // the thread of a context has a stack of its own, a pool is not used
   template <typename Work>
-  context (Work &&work)
+  context (Work &&work, stack_pool * = nullptr)
     : state (INITIAL)
     , work ()
     , mutex ()
     , condition ()
-    , future (dzn::std_async ([this]
+    , done (dzn::std_thread ([this]
     {
       try
         {
@@ -101,7 +111,7 @@ public:
     , work ()
     , mutex ()
     , condition ()
-    , future ()
+    , done ()
   {}
   context (context &&) = delete;
   context &operator= (context &&) = delete;
@@ -131,6 +141,8 @@ public:
   {
     //debug << "[" << get_id () << "] call" << std::endl;
     std::unique_lock<std::mutex> lock (mutex);
+    // after its work returned, the thread may not have blocked yet
+    while (state == RELEASED) condition.wait (lock);
     do_release (lock);
 
     std::unique_lock<std::mutex> lock2 (c.mutex);
@@ -175,10 +187,110 @@ private:
     state = FINAL;
     lock.unlock ();
     condition.notify_all ();
-    if (future.valid ()) future.wait ();
+    if (done.valid ()) done.wait ();
+  }
+};
+}
+
+#else // DZN_NATIVE_CONTEXT
+
+namespace dzn
+{
+extern std::ostream debug;
+
+// A native context runs its work on a stack of its own.  Call, yield and
+// release switch stacks within the calling thread, saving only the
+// callee-saved registers.  A default constructed context has no stack
+// and represents the thread that calls into the other contexts.  When
+// the work returns, control goes back to the context that called,
+// yielded to or released this one; calling it again runs the work anew.
+class context
+{
+  enum State {INITIAL, RELEASED, BLOCKED, FINAL};
+  static std::string to_string (State state)
+  {
+    switch (state)
+      {
+      case INITIAL:
+        return "INITIAL";
+      case RELEASED:
+        return "RELEASED";
+      case BLOCKED:
+        return "BLOCKED";
+      case FINAL:
+        return "FINAL";
+      }
+    throw std::logic_error ("UNKNOWN STATE");
   }
+  State state;
+  bool live;
+  void *sp;
+  void *stack;
+  size_t stack_size;
+  size_t guard_size;
+  stack_pool *pool;
+  context *link;
+  std::exception_ptr exception;
+  std::function<void (std::function<void (context &)>&)> work;
+public:
+  // Thrown at every coroutine release; no message, so that unwinding
+  // does not allocate.
+  struct forced_unwind: public std::exception
+  {
+    char const *what () const noexcept
+    {
+      return "forced_unwind";
+    }
+  };
+  // The stack comes from POOL, or is mapped for this context alone.
+  template <typename Work>
+  context (Work &&work, stack_pool *pool = nullptr)
+    : state (INITIAL)
+    , live ()
+    , sp ()
+    , stack ()
+    , stack_size ()
+    , guard_size ()
+    , pool (pool)
+    , link ()
+    , exception ()
+    , work (std::forward<Work> (work))
+  {
+    allocate (DZN_CONTEXT_STACK_SIZE);
+  }
+  context ()
+    : state (INITIAL)
+    , live ()
+    , sp ()
+    , stack ()
+    , stack_size ()
+    , guard_size ()
+    , pool ()
+    , link ()
+    , exception ()
+    , work ()
+  {}
+  context (context &&) = delete;
+  context &operator= (context &&) = delete;
+  context (context const&) = delete;
+  context &operator= (context const&) = delete;
+  ~context ();
+  void finish ();
+  void block ();
+  void release ();
+  void call (context &c);
+  void yield (context &to);
+  static context &current ();
+private:
+  void allocate (size_t size);
+  void deallocate ();
+  static void entry (void *);
+  static void transfer (context &from, context &to);
+  static void resume (context &from, context &to);
 };
 }
 
+#endif // DZN_NATIVE_CONTEXT
+
 #endif //DZN_CONTEXT_HH
 //version: 2.18.3
@@ -35,23 +35,178 @@ typedef std::function<void (context &)> yield;
 }
 #endif
 
+#include <dzn/slab.hh>
+#include <dzn/stack-pool.hh>
+
+#include <cstddef>
+#include <iterator>
+#include <new>
+
 namespace dzn
 {
 struct coroutine
 {
   size_t id;
+  std::function<void ()> work;
   dzn::context context;
   dzn::yield yield;
   void *component;
   void *port;
   bool finished;
   bool skip_block;
+  // links of the coroutine_list holding this coroutine
+  coroutine *previous;
+  coroutine *next;
   coroutine ();
-  coroutine (size_t id, std::function<void()> &&worker);
+  coroutine (size_t id, std::function<void()> &&worker,
+             dzn::stack_pool *stacks = nullptr);
   void yield_to (dzn::coroutine &that);
   void call (coroutine &that);
   void release ();
 };
+
+// Sequence of coroutines, linked through the coroutines themselves.
+// A coroutine keeps its address for life and moves between lists
+// without allocating; its storage comes from, and returns to, a slab.
+class coroutine_list
+{
+  typedef dzn::slab<sizeof (coroutine)> coroutines;
+  coroutine *first;
+  coroutine *last;
+  size_t count;
+  void unlink (coroutine *c)
+  {
+    (c->previous ? c->previous->next : first) = c->next;
+    (c->next ? c->next->previous : last) = c->previous;
+    c->previous = c->next = nullptr;
+    --count;
+  }
+  void link (coroutine *c)
+  {
+    c->previous = last;
+    c->next = nullptr;
+    (last ? last->next : first) = c;
+    last = c;
+    ++count;
+  }
+public:
+  class iterator
+  {
+    coroutine *c;
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef coroutine value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef coroutine *pointer;
+    typedef coroutine &reference;
+    iterator (coroutine *c = nullptr)
+      : c (c)
+    {}
+    coroutine &operator * () const
+    {
+      return *c;
+    }
+    coroutine *operator -> () const
+    {
+      return c;
+    }
+    iterator &operator ++ ()
+    {
+      c = c->next;
+      return *this;
+    }
+    iterator operator ++ (int)
+    {
+      iterator i = *this;
+      c = c->next;
+      return i;
+    }
+    bool operator == (iterator const& that) const
+    {
+      return c == that.c;
+    }
+    bool operator != (iterator const& that) const
+    {
+      return c != that.c;
+    }
+  };
+  coroutine_list ()
+    : first ()
+    , last ()
+    , count ()
+  {}
+  coroutine_list (coroutine_list const&) = delete;
+  coroutine_list &operator = (coroutine_list const&) = delete;
+  ~coroutine_list ()
+  {
+    while (first)
+      erase (first);
+  }
+  iterator begin () const
+  {
+    return iterator (first);
+  }
+  iterator end () const
+  {
+    return iterator ();
+  }
+  coroutine &front () const
+  {
+    return *first;
+  }
+  coroutine &back () const
+  {
+    return *last;
+  }
+  size_t size () const
+  {
+    return count;
+  }
+  bool empty () const
+  {
+    return !count;
+  }
+  template <typename... Args>
+  coroutine &emplace_back (Args &&...args)
+  {
+    void *p = coroutines::allocate ();
+    coroutine *c;
+    try
+      {
+        c = new (p) coroutine (std::forward<Args> (args)...);
+      }
+    catch (...)
+      {
+        coroutines::deallocate (p);
+        throw;
+      }
+    link (c);
+    return *c;
+  }
+  void erase (coroutine *c)
+  {
+    unlink (c);
+    c->~coroutine ();
+    coroutines::deallocate (c);
+  }
+  // Move C from THAT to the back of this list.
+  void splice (coroutine_list &that, coroutine *c)
+  {
+    that.unlink (c);
+    link (c);
+  }
+  template <typename Predicate>
+  void remove_if (Predicate predicate)
+  {
+    for (coroutine *c = first; c;)
+      {
+        coroutine *next = c->next;
+        if (predicate (*c))
+          erase (c);
+        c = next;
+      }
+  }
+};
 }
 #endif //DZN_COROUTINE_HH
 //version: 2.18.3
@@ -17,13 +17,16 @@
 
 #include <dzn/config.hh>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <functional>
 #include <iostream>
-#include <map>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <typeinfo>
+#include <vector>
 
 namespace dzn
 {
@@ -41,26 +44,125 @@ struct illegal_handler
   }
 };
 
+// Services are found by type and key.  Every service type gets a slot
+// number the first time it is used; services with the default, empty
+// key live in an array indexed by that slot, the first
+// DZN_LOCATOR_SLOTS of them inline, so that the lookups on the event
+// path and the clone per component neither hash nor allocate.  Named
+// services live in an open addressing table that keeps the hash of
+// each key.
 struct locator
 {
 private:
   typedef std::string Key;
-  struct type_info
-  {
-    const std::type_info *type;
-    type_info (std::type_info const& t)
-      : type (&t)
-    {}
-    bool operator < (type_info const& that) const
-    {
-      return type->before (*that.type);
-    }
+  struct named
+  {
+    size_t hash;
+    size_t slot;
+    Key key;
+    const void *service;
   };
-  std::map<std::pair<Key, type_info>, const void *> services;
+  static size_t const none = size_t (-1);
+  static size_t next_slot ()
+  {
+    static std::atomic<size_t> slots (0);
+    return slots++;
+  }
+  template <typename T>
+  static size_t unique ()
+  {
+    static size_t const s = next_slot ();
+    return s;
+  }
+  // const T is found as T, like typeid (T)
+  template <typename T>
+  static size_t slot ()
+  {
+    return unique<typename std::remove_cv<T>::type> ();
+  }
+  const void *defaults[DZN_LOCATOR_SLOTS];
+  std::vector<const void *> more;
+  std::vector<named> services;
+  size_t count;
   locator (locator const&) = default;
+  static size_t hash (size_t slot, Key const& key)
+  {
+    return std::hash<Key> () (key) ^ (slot * 0x9e3779b97f4a7c15ull);
+  }
+  const void *find (size_t slot) const
+  {
+    if (slot < DZN_LOCATOR_SLOTS)
+      return defaults[slot];
+    slot -= DZN_LOCATOR_SLOTS;
+    return slot < more.size () ? more[slot] : nullptr;
+  }
+  const void *find (size_t slot, Key const& key) const
+  {
+    if (key.empty ())
+      return find (slot);
+    if (services.empty ())
+      return nullptr;
+    size_t h = hash (slot, key);
+    size_t mask = services.size () - 1;
+    for (size_t i = h & mask; services[i].slot != none; i = (i + 1) & mask)
+      if (services[i].hash == h && services[i].slot == slot
+          && services[i].key == key)
+        return services[i].service;
+    return nullptr;
+  }
+  void insert (size_t slot, const void *service)
+  {
+    if (slot < DZN_LOCATOR_SLOTS)
+      defaults[slot] = service;
+    else
+      {
+        slot -= DZN_LOCATOR_SLOTS;
+        if (slot >= more.size ())
+          more.resize (slot + 1);
+        more[slot] = service;
+      }
+  }
+  void insert (size_t slot, Key const& key, const void *service)
+  {
+    if (key.empty ())
+      return insert (slot, service);
+    if (2 * (count + 1) > services.size ())
+      grow ();
+    size_t h = hash (slot, key);
+    size_t mask = services.size () - 1;
+    size_t i = h & mask;
+    for (; services[i].slot != none; i = (i + 1) & mask)
+      if (services[i].hash == h && services[i].slot == slot
+          && services[i].key == key)
+        {
+          services[i].service = service;
+          return;
+        }
+    services[i] = named {h, slot, key, service};
+    ++count;
+  }
+  void grow ()
+  {
+    std::vector<named> old (std::max<size_t> (2 * services.size (), 8),
+                            named {0, none, Key (), nullptr});
+    old.swap (services);
+    size_t mask = services.size () - 1;
+    for (auto &n : old)
+      if (n.slot != none)
+        {
+          size_t i = n.hash & mask;
+          while (services[i].slot != none)
+            i = (i + 1) & mask;
+          services[i] = std::move (n);
+        }
+  }
 public:
   locator (locator &&) = default;
   locator ()
+    : defaults ()
+    , more ()
+    , services ()
+    , count (0)
   {
     static illegal_handler ih;
     set (std::clog).set (ih);
@@ -70,21 +172,36 @@ public:
     return locator (*this);
   }
   template <typename T>
-  locator &set (T &t, const Key &key = Key ())
+  locator &set (T &t)
   {
-    services[std::make_pair (key, type_info (typeid (T)))] = &t;
+    insert (slot<T> (), &t);
     return *this;
   }
   template <typename T>
-  T *try_get (Key const& key = Key ()) const
+  locator &set (T &t, const Key &key)
   {
-    auto it = services.find (std::make_pair (key, type_info (typeid (T))));
-    if (it != services.end () && it->second)
-      return reinterpret_cast<T *> (const_cast<void *> (it->second));
-    return nullptr;
+    insert (slot<T> (), key, &t);
+    return *this;
+  }
+  template <typename T>
+  T *try_get () const
+  {
+    return reinterpret_cast<T *> (const_cast<void *> (find (slot<T> ())));
+  }
+  template <typename T>
+  T *try_get (Key const& key) const
+  {
+    return reinterpret_cast<T *> (const_cast<void *> (find (slot<T> (), key)));
+  }
+  template <typename T>
+  T &get () const
+  {
+    if (T *t = try_get<T> ())
+      return *t;
+    throw std::runtime_error ("<" + std::string (typeid (T).name ()) + ",\"\"> not available");
   }
   template <typename T>
-  T &get (Key const& key = Key ()) const
+  T &get (Key const& key) const
   {
     if (T *t = try_get<T> (key))
       return *t;
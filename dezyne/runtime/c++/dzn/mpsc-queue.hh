@@ -0,0 +1,102 @@
+// dzn-runtime -- Dezyne runtime library
+//
+// This file is part of dzn-runtime.
+//
+// All rights reserved.
+//
+//
+// Commentary:
+//
+// Unbounded multi-producer single-consumer queue.  A producer links its
+// node with a single atomic exchange and never blocks or waits for
+// another producer; only the consumer pops.  The queue always holds one
+// stub node, the last node popped.  Nodes come from a dzn::slab, so that
+// a steady stream of pushes and pops does not allocate.
+//
+// Code:
+
+#ifndef DZN_MPSC_QUEUE_HH
+#define DZN_MPSC_QUEUE_HH
+
+#include <dzn/slab.hh>
+
+#include <atomic>
+#include <new>
+#include <utility>
+
+namespace dzn
+{
+template <typename T>
+class mpsc_queue
+{
+  struct node
+  {
+    std::atomic<node *> next;
+    T value;
+    explicit node (T &&value)
+      : next (nullptr)
+      , value (std::move (value))
+    {}
+  };
+  typedef dzn::slab<sizeof (node)> nodes;
+  static node *make (T &&value)
+  {
+    return new (nodes::allocate ()) node (std::move (value));
+  }
+  static void free (node *n)
+  {
+    n->~node ();
+    nodes::deallocate (n);
+  }
+  // written by producers
+  alignas (64) std::atomic<node *> head;
+  // written by the consumer only
+  alignas (64) std::atomic<node *> tail;
+public:
+  mpsc_queue ()
+    : head (make (T ()))
+    , tail (head.load (std::memory_order_relaxed))
+  {}
+  mpsc_queue (mpsc_queue const&) = delete;
+  mpsc_queue &operator = (mpsc_queue const&) = delete;
+  ~mpsc_queue ()
+  {
+    T value;
+    while (pop (value))
+      ;
+    free (tail.load (std::memory_order_relaxed));
+  }
+  // Any thread.  The exchange is sequentially consistent, so that a
+  // producer which next checks whether the consumer sleeps either sees
+  // it sleeping or is seen by its last empty () check.
+  void push (T &&value)
+  {
+    node *n = make (std::move (value));
+    node *prev = head.exchange (n);
+    prev->next.store (n, std::memory_order_release);
+  }
+  // Consumer only.  Returns false when the queue is empty or when the
+  // first producer in line has not finished linking its node yet.
+  bool pop (T &value)
+  {
+    node *stub = tail.load (std::memory_order_relaxed);
+    node *next = stub->next.load (std::memory_order_acquire);
+    if (!next)
+      return false;
+    value = std::move (next->value);
+    next->value = T ();
+    tail.store (next, std::memory_order_release);
+    free (stub);
+    return true;
+  }
+  // Any thread; compares pointers only.  A push in progress counts as
+  // not empty.
+  bool empty () const
+  {
+    return head.load () == tail.load ();
+  }
+};
+}
+
+#endif //DZN_MPSC_QUEUE_HH
+//version: 2.18.3
@@ -19,12 +19,17 @@
 #include <dzn/config.hh>
 #include <dzn/coroutine.hh>
 #include <dzn/meta.hh>
+#include <dzn/mpsc-queue.hh>
+#include <dzn/ring.hh>
+#include <dzn/stack-pool.hh>
+#include <dzn/std-async.hh>
+#include <dzn/task.hh>
+#include <dzn/timer-wheel.hh>
 
+#include <atomic>
 #include <condition_variable>
 #include <functional>
 #include <future>
-#include <list>
-#include <map>
 #include <mutex>
 #include <queue>
 #include <set>
@@ -43,32 +48,40 @@ struct pump
   bool running;
   bool paused;
   std::function<void ()> worker;
-  std::list<coroutine> coroutines;
-  std::list<coroutine> collateral_blocked;
+  // stacks of the coroutines, which must go before them
+  dzn::stack_pool stacks;
+  dzn::coroutine_list coroutines;
+  dzn::coroutine_list collateral_blocked;
   size_t current_coroutine;
-  std::queue<std::function<void ()>> queue;
-  std::vector<std::pair<std::function<bool ()>, std::function<void (size_t)>>> deferred;
-
-  struct deadline
-  {
-    size_t id;
-    std::chrono::steady_clock::time_point time;
-    deadline (size_t identifier, size_t ms);
-    bool expired (std::chrono::steady_clock::time_point const& now) const
-    {return time <= now;}
-    bool operator < (deadline const& that) const
-    {return this->time < that.time || (this->time == that.time && this->id < that.id);}
-  };
-
-  std::map<deadline, std::function<void ()>> timers;
-  std::vector<std::function<void ()>> switch_context;
+  // the coroutine running on the pump, null in the driver
+  dzn::coroutine *current;
+  // to be removed once no longer running
+  std::vector<dzn::coroutine *> finished_coroutines;
+  dzn::mpsc_queue<dzn::task<void ()>> queue;
+  dzn::ring<std::pair<dzn::task<bool ()>, dzn::task<void (size_t)>>> deferred;
+  dzn::timer_wheel timers;
+  dzn::ring<std::function<void ()>> switch_context;
   std::function<void ()> exit;
   std::thread::id thread_id;
   std::condition_variable condition;
   std::condition_variable idle;
   std::mutex mutex;
-  std::future<void> task;
+  std::atomic<bool> sleeping;
+  // Set for a pump that shares the threads of an executor with other
+  // pumps; a null executor gives the pump a thread of its own.
+  std::function<void (dzn::task<void ()> &&)> executor;
+  enum {PARKED, QUEUED, RUNNING, STOPPED};
+  std::atomic<int> schedule;
+  bool parking;
+  completion::state *stopped;
+  dzn::completion task;
   pump ();
+  explicit pump (std::function<void (dzn::task<void ()> &&)> const& executor);
+  // Coroutines get stacks of STACK_SIZE bytes; HIGH_WATER unused stacks
+  // are kept.
+  pump (size_t stack_size, size_t high_water);
+  pump (std::function<void (dzn::task<void ()> &&)> const& executor,
+        size_t stack_size, size_t high_water);
   ~pump ();
   size_t coroutine_id ();
   void stop ();
@@ -79,7 +92,7 @@ struct pump
   void operator () ();
 
   void collateral_block (runtime &, dzn::component *);
-  void collateral_release (std::list<coroutine>::iterator);
+  void collateral_release (dzn::coroutine *);
 
   bool blocked_p (void *);
   void block (runtime &, dzn::component *, void *);
@@ -87,14 +100,17 @@ struct pump
   void create_context ();
   void context_switch ();
   void release (runtime &, dzn::component *, void *);
-  void operator () (std::function<void ()> const&);
-  void operator () (std::function<void ()> &&);
-  void defer (std::function<bool ()> &&, std::function<void (size_t)> &&);
+  void operator () (dzn::task<void ()> &&);
+  void defer (dzn::task<bool ()> &&, dzn::task<void (size_t)> &&);
   void prune_deferred ();
-  void handle (size_t, size_t, std::function<void ()> const&);
+  void handle (size_t, size_t, dzn::task<void ()> &&);
   void remove (size_t);
+  void wake ();
 private:
-  bool timers_expired (std::chrono::steady_clock::time_point const& now) const;
+  void switch_to (dzn::coroutine &, dzn::coroutine &);
+  bool timers_expired (std::chrono::steady_clock::time_point const& now);
+  bool quiescent () const;
+  bool park ();
 };
 
 #if __cplusplus > 201402L
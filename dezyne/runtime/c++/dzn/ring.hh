@@ -0,0 +1,135 @@
+// dzn-runtime -- Dezyne runtime library
+//
+// This file is part of dzn-runtime.
+//
+// All rights reserved.
+//
+//
+// Commentary:
+//
+// First-in first-out queue on a circular buffer with the interface of
+// std::queue, which can also be popped from the back.  The buffer
+// doubles when full and is never shrunk, so a queue that keeps being
+// filled and drained does not allocate.
+//
+// Code:
+
+#ifndef DZN_RING_HH
+#define DZN_RING_HH
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace dzn
+{
+template <typename T>
+class ring
+{
+  T *buffer;
+  size_t capacity;
+  size_t first;
+  size_t count;
+  T *slot (size_t i) const
+  {
+    return buffer + ((first + i) & (capacity - 1));
+  }
+  void grow ()
+  {
+    size_t size = capacity ? 2 * capacity : 8;
+    T *larger = static_cast<T *> (::operator new (size * sizeof (T)));
+    for (size_t i = 0; i < count; ++i)
+      {
+        T *t = slot (i);
+        new (larger + i) T (std::move (*t));
+        t->~T ();
+      }
+    ::operator delete (buffer);
+    buffer = larger;
+    capacity = size;
+    first = 0;
+  }
+public:
+  typedef T value_type;
+  ring ()
+    : buffer ()
+    , capacity ()
+    , first ()
+    , count ()
+  {}
+  ring (ring &&that) noexcept
+    : buffer (that.buffer)
+    , capacity (that.capacity)
+    , first (that.first)
+    , count (that.count)
+  {
+    that.buffer = nullptr;
+    that.capacity = that.first = that.count = 0;
+  }
+  ring (ring const&) = delete;
+  ring &operator = (ring const&) = delete;
+  ~ring ()
+  {
+    while (count)
+      pop ();
+    ::operator delete (buffer);
+  }
+  bool empty () const
+  {
+    return !count;
+  }
+  size_t size () const
+  {
+    return count;
+  }
+  T &front ()
+  {
+    assert (count);
+    return *slot (0);
+  }
+  T &back ()
+  {
+    assert (count);
+    return *slot (count - 1);
+  }
+  T &operator [] (size_t i)
+  {
+    assert (i < count);
+    return *slot (i);
+  }
+  void push (T const& t)
+  {
+    emplace (t);
+  }
+  void push (T &&t)
+  {
+    emplace (std::move (t));
+  }
+  template <typename... Args>
+  void emplace (Args &&...args)
+  {
+    if (count == capacity)
+      grow ();
+    new (slot (count)) T (std::forward<Args> (args)...);
+    ++count;
+  }
+  void pop ()
+  {
+    assert (count);
+    slot (0)->~T ();
+    first = (first + 1) & (capacity - 1);
+    --count;
+  }
+  void pop_back ()
+  {
+    assert (count);
+    slot (count - 1)->~T ();
+    --count;
+  }
+};
+}
+
+#endif //DZN_RING_HH
+//version: 2.18.3
@@ -21,9 +21,12 @@
 #include <dzn/meta.hh>
 #include <dzn/locator.hh>
 #include <dzn/coroutine.hh>
+#include <dzn/ring.hh>
+#include <dzn/task.hh>
 
 #include <algorithm>
 #include <cstddef>
+#include <deque>
 #include <future>
 #include <iostream>
 #include <map>
@@ -137,7 +140,7 @@ bool port_blocked_p (locator const &, void *);
 void port_block (locator const &, dzn::component *, void *);
 void port_release (locator const &, dzn::component *, void *);
 size_t coroutine_id (locator const &);
-void defer (locator const &, std::function<bool ()> &&, std::function<void (size_t)> &&);
+void defer (locator const &, dzn::task<bool ()> &&, dzn::task<void (size_t)> &&);
 void prune_deferred (locator const &);
 
 struct runtime
@@ -152,13 +155,29 @@ struct runtime
     void *skip;
     bool native;
     bool performs_flush;
-    std::function<void()> port_update;
+    dzn::task<void ()> port_update;
     dzn::component *deferred;
-    std::queue<std::function<void ()>> queue;
+    dzn::ring<dzn::task<void ()>> queue;
   };
   bool defer;
-  std::map<dzn::component *, state> states;
-  std::map<size_t, int> coroutine_id2activity;
+  // The state of every component seen by this runtime, indexed by the
+  // id it got on first use; a deque keeps references stable while it
+  // grows.  Ids are found by open addressing on the component pointer,
+  // with the last component looked up cached for the runs of accesses
+  // on a single component in event handling and flush.
+  std::deque<state> states;
+  struct entry
+  {
+    dzn::component *component;
+    size_t id;
+  };
+  std::vector<entry> ids;
+  dzn::component *last_component;
+  state *last_state;
+  // indexed by coroutine id; a deque keeps the references stable
+  std::deque<int> coroutine_id2activity;
+  state *find (dzn::component *);
+  state &at (dzn::component *);
   bool skip_block (dzn::component *, void *);
   void set_skip_block (dzn::component *, void *);
   void reset_skip_block (dzn::component *);
@@ -167,9 +186,9 @@ struct runtime
   int &activity (dzn::locator const&);
   size_t &handling (dzn::component *);
   size_t &blocked (dzn::component *);
-  std::function<void()> &deferred_flush (dzn::component *);
+  dzn::task<void ()> &deferred_flush (dzn::component *);
   dzn::component *&deferred (dzn::component *);
-  std::queue<std::function<void ()> > &queue (dzn::component *);
+  dzn::ring<dzn::task<void ()>> &queue (dzn::component *);
   bool &performs_flush (dzn::component *);
   bool &native (dzn::component *);
   void flush (dzn::component *, size_t, bool sync_p);
@@ -217,8 +236,8 @@ struct scoped_handling
 template <typename C, typename P, typename E>
 void defer (C *component, P &&predicate, E const &statement)
 {
-  defer (component->dzn_locator, std::function<bool ()> (predicate),
-         std::function<void (size_t)> ([ = ] (size_t coroutine_id)
+  defer (component->dzn_locator, dzn::task<bool ()> (predicate),
+         dzn::task<void (size_t)> ([ = ] (size_t coroutine_id)
          {
            scoped_activity activity (component->dzn_runtime,
                                      component->dzn_locator, -1);
@@ -0,0 +1,129 @@
+// dzn-runtime -- Dezyne runtime library
+//
+// This file is part of dzn-runtime.
+//
+// All rights reserved.
+//
+//
+// Commentary:
+//
+// Fixed-size block allocator.  Every thread keeps a cache of free
+// blocks; blocks travel between threads in batches through a shared
+// list, so that a block allocated by a producer and freed by the pump
+// thread costs a lock only once per batch.  Memory is kept for reuse and
+// is never given back.
+//
+// Code:
+
+#ifndef DZN_SLAB_HH
+#define DZN_SLAB_HH
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace dzn
+{
+template <size_t Size>
+class slab
+{
+  union block
+  {
+    block *next;
+    alignas (std::max_align_t) unsigned char data[Size];
+  };
+  static constexpr size_t batch = 64;
+  typedef std::pair<block *, size_t> chain;
+  struct shared_list
+  {
+    std::mutex mutex;
+    std::vector<chain> chains;
+  };
+  // never destroyed: a detached thread may return its cache after
+  // static destruction has begun
+  static shared_list &shared ()
+  {
+    static shared_list *list = new shared_list;
+    return *list;
+  }
+  struct cache
+  {
+    block *free;
+    size_t count;
+    cache ()
+      : free ()
+      , count ()
+    {}
+    ~cache ()
+    {
+      if (count)
+        {
+          std::lock_guard<std::mutex> lock (shared ().mutex);
+          shared ().chains.emplace_back (free, count);
+        }
+    }
+  };
+  static cache &local ()
+  {
+    static thread_local cache c;
+    return c;
+  }
+  static void refill (cache &c)
+  {
+    {
+      std::lock_guard<std::mutex> lock (shared ().mutex);
+      if (shared ().chains.size ())
+        {
+          chain ch = shared ().chains.back ();
+          shared ().chains.pop_back ();
+          c.free = ch.first;
+          c.count = ch.second;
+          return;
+        }
+    }
+    block *blocks = static_cast<block *> (::operator new (batch * sizeof (block)));
+    for (size_t i = 0; i < batch; ++i)
+      blocks[i].next = i + 1 < batch ? &blocks[i + 1] : nullptr;
+    c.free = blocks;
+    c.count = batch;
+  }
+  static void spill (cache &c)
+  {
+    block *head = c.free;
+    block *last = head;
+    for (size_t i = 1; i < batch; ++i)
+      last = last->next;
+    c.free = last->next;
+    c.count -= batch;
+    last->next = nullptr;
+    std::lock_guard<std::mutex> lock (shared ().mutex);
+    shared ().chains.emplace_back (head, batch);
+  }
+public:
+  static constexpr size_t size = Size;
+  static void *allocate ()
+  {
+    cache &c = local ();
+    if (!c.free)
+      refill (c);
+    block *b = c.free;
+    c.free = b->next;
+    --c.count;
+    return b;
+  }
+  static void deallocate (void *p)
+  {
+    cache &c = local ();
+    block *b = static_cast<block *> (p);
+    b->next = c.free;
+    c.free = b;
+    if (++c.count >= 2 * batch)
+      spill (c);
+  }
+};
+}
+
+#endif //DZN_SLAB_HH
+//version: 2.18.3
@@ -0,0 +1,85 @@
+// dzn-runtime -- Dezyne runtime library
+//
+// This file is part of dzn-runtime.
+//
+// All rights reserved.
+//
+//
+// Commentary:
+//
+// Stacks for the native coroutine contexts of a pump.  Every stack is
+// mapped once, with a guard page below it so that an overflow faults,
+// and goes back to the pool when its coroutine is removed.  The pool
+// hands out the most recently returned stack first, whose top is still
+// in cache, and keeps at most HIGH_WATER unused stacks; beyond that a
+// returned stack is unmapped.  Block and release cycles then neither
+// map nor unmap, and the memory of a parked coroutine is one stack of
+// the configured size.  A pool belongs to a single pump and is not
+// thread safe.
+//
+// Code:
+
+#ifndef DZN_STACK_POOL_HH
+#define DZN_STACK_POOL_HH
+
+#include <dzn/config.hh>
+
+#include <cstddef>
+#include <vector>
+
+namespace dzn
+{
+class stack_pool
+{
+public:
+  struct statistics
+  {
+    size_t stack_size;   // usable bytes of a stack
+    size_t guard_size;   // bytes of the guard below a stack
+    size_t high_water;   // most unused stacks kept
+    size_t in_use;       // stacks handed out
+    size_t free;         // unused stacks kept
+    size_t peak;         // most stacks handed out at once
+    size_t mapped;       // bytes mapped for stacks in use and kept
+    size_t maps;         // stacks mapped
+    size_t reuses;       // stacks handed out again
+  };
+  explicit stack_pool (size_t stack_size = DZN_CONTEXT_STACK_SIZE,
+                       size_t high_water = DZN_STACK_POOL_HIGH_WATER);
+  stack_pool (stack_pool const&) = delete;
+  stack_pool &operator = (stack_pool const&) = delete;
+  ~stack_pool ();
+  // Map stacks until COUNT unused stacks are kept.
+  void reserve (size_t count);
+  // The lowest address of a stack of size () bytes, guard included.
+  void *allocate ();
+  void deallocate (void *stack);
+  size_t size () const
+  {
+    return guard_size + stack_size;
+  }
+  size_t guard () const
+  {
+    return guard_size;
+  }
+  statistics stats () const;
+
+  // A single stack of at least STACK_SIZE usable bytes, for a context
+  // outside a pool; SIZE receives its size, guard included.
+  static void *map (size_t stack_size, size_t &size);
+  static void unmap (void *stack, size_t size);
+  static size_t page_size ();
+private:
+  size_t stack_size;
+  size_t guard_size;
+  size_t high_water;
+  std::vector<void *> unused;
+  size_t in_use;
+  size_t peak;
+  size_t maps;
+  size_t reuses;
+};
+}
+
+#endif //DZN_STACK_POOL_HH
+//version: 2.18.3
@@ -14,15 +14,173 @@
 #ifndef DZN_STD_ASYNC_HH
 #define DZN_STD_ASYNC_HH
 
+#include <dzn/slab.hh>
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
 #include <functional>
-#include <future>
+#include <mutex>
+#include <new>
+#include <thread>
 
 // forward declaration of dzn::async as indirection for std::async or
 // dzn::thread::pool::defer
 
 namespace dzn
 {
-std::future<void> std_async (std::function<void ()> const &);
+// Handle on work started by std_async.  Instead of the shared state of
+// a std::future, with its own mutex and condition variable, the work and
+// the handle share a pooled flag; the rare waiter sleeps on a condition
+// variable common to all completions.
+class completion
+{
+public:
+  struct state
+  {
+    std::atomic<unsigned> references;
+    std::atomic<bool> done;
+    std::exception_ptr exception;
+    state ()
+      : references (2)
+      , done (false)
+      , exception ()
+    {}
+  };
+private:
+  typedef dzn::slab<sizeof (state)> states;
+  struct waiters
+  {
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::atomic<size_t> count;
+    waiters ()
+      : count (0)
+    {}
+  };
+  // never destroyed, like the slab lists, for work finishing on a
+  // detached thread
+  static waiters &shared ()
+  {
+    static waiters *w = new waiters;
+    return *w;
+  }
+  static void release (state *s)
+  {
+    if (s->references.fetch_sub (1, std::memory_order_acq_rel) == 1)
+      {
+        s->~state ();
+        states::deallocate (s);
+      }
+  }
+  state *s;
+  explicit completion (state *s)
+    : s (s)
+  {}
+public:
+  completion () noexcept
+    : s ()
+  {}
+  completion (completion &&that) noexcept
+    : s (that.s)
+  {
+    that.s = nullptr;
+  }
+  completion &operator = (completion &&that) noexcept
+  {
+    if (this != &that)
+      {
+        if (s) release (s);
+        s = that.s;
+        that.s = nullptr;
+      }
+    return *this;
+  }
+  completion (completion const&) = delete;
+  completion &operator = (completion const&) = delete;
+  ~completion ()
+  {
+    if (s) release (s);
+  }
+  // Start tracking work: WORK receives the state to pass to finish ()
+  // once the work has run.
+  static completion create (state *&work)
+  {
+    work = new (states::allocate ()) state;
+    return completion (work);
+  }
+  // Mark the work done, with the exception it threw if any, and drop
+  // its reference.
+  static void finish (state *work, std::exception_ptr exception = nullptr)
+  {
+    work->exception = exception;
+    work->done.store (true);
+    waiters &w = shared ();
+    if (w.count.load ())
+      {
+        std::lock_guard<std::mutex> lock (w.mutex);
+        w.condition.notify_all ();
+      }
+    release (work);
+  }
+  bool valid () const
+  {
+    return s != nullptr;
+  }
+  bool ready () const
+  {
+    return s && s->done.load (std::memory_order_acquire);
+  }
+  void wait () const
+  {
+    if (ready ())
+      return;
+    waiters &w = shared ();
+    std::unique_lock<std::mutex> lock (w.mutex);
+    ++w.count;
+    w.condition.wait (lock, [this] {return s->done.load ();});
+    --w.count;
+  }
+  // Wait and rethrow what the work threw.
+  void get ()
+  {
+    wait ();
+    state *done = s;
+    s = nullptr;
+    std::exception_ptr exception = done->exception;
+    release (done);
+    if (exception)
+      std::rethrow_exception (exception);
+  }
+};
+
+dzn::completion std_async (std::function<void ()> const &);
+
+// Run WORK on a thread of its own, also when std_async is backed by a
+// bounded pool.  For work that blocks for its whole lifetime, such as
+// the loop of a dedicated pump or the thread of a context: on a pool it
+// would hold a worker until it returns, and with more of it than the
+// pool limit the rest would never start.
+inline dzn::completion
+std_thread (std::function<void ()> const &work)
+{
+  completion::state *state;
+  dzn::completion done = completion::create (state);
+  std::thread ([work, state]
+  {
+    std::exception_ptr exception;
+    try
+      {
+        work ();
+      }
+    catch (...)
+      {
+        exception = std::current_exception ();
+      }
+    completion::finish (state, exception);
+  }).detach ();
+  return done;
+}
 }
 
 #endif
@@ -0,0 +1,227 @@
+// dzn-runtime -- Dezyne runtime library
+//
+// This file is part of dzn-runtime.
+//
+// All rights reserved.
+//
+//
+// Commentary:
+//
+// Move-only callable with a fixed inline buffer, used for pump events,
+// timers, deferred events and runtime queues instead of std::function.
+// A callable that fits the buffer is stored in place; a larger one goes
+// to a pooled slab block, and only callables larger than a slab block
+// are allocated from the heap.
+//
+// Code:
+
+#ifndef DZN_TASK_HH
+#define DZN_TASK_HH
+
+#include <dzn/slab.hh>
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace dzn
+{
+template <typename Signature, size_t Capacity = 56>
+class task;
+
+template <typename R, typename... Args, size_t Capacity>
+class task<R (Args...), Capacity>
+{
+  typedef dzn::slab<256> overflow;
+  struct ops
+  {
+    R (*invoke) (void *, Args &&...);
+    void (*relocate) (void *from, void *to);
+    void (*destroy) (void *);
+  };
+  template <typename F>
+  static constexpr bool fits ()
+  {
+    return sizeof (F) <= Capacity
+      && alignof (F) <= alignof (std::max_align_t)
+      && std::is_nothrow_move_constructible<F>::value;
+  }
+  template <typename F>
+  struct local
+  {
+    static R invoke (void *storage, Args &&...args)
+    {
+      return (*static_cast<F *> (storage)) (std::forward<Args> (args)...);
+    }
+    static void relocate (void *from, void *to)
+    {
+      F *f = static_cast<F *> (from);
+      new (to) F (std::move (*f));
+      f->~F ();
+    }
+    static void destroy (void *storage)
+    {
+      static_cast<F *> (storage)->~F ();
+    }
+    static constexpr ops table = {&invoke, &relocate, &destroy};
+  };
+  template <typename F>
+  struct remote
+  {
+    static F *&get (void *storage)
+    {
+      return *static_cast<F **> (storage);
+    }
+    static R invoke (void *storage, Args &&...args)
+    {
+      return (*get (storage)) (std::forward<Args> (args)...);
+    }
+    static void relocate (void *from, void *to)
+    {
+      new (to) F * (get (from));
+    }
+    static void destroy (void *storage)
+    {
+      F *f = get (storage);
+      f->~F ();
+      deallocate (f);
+    }
+    static bool pooled ()
+    {
+      return sizeof (F) <= overflow::size && alignof (F) <= alignof (std::max_align_t);
+    }
+    static void *allocate ()
+    {
+      return pooled () ? overflow::allocate () : ::operator new (sizeof (F));
+    }
+    static void deallocate (void *memory)
+    {
+      if (pooled ())
+        overflow::deallocate (memory);
+      else
+        ::operator delete (memory);
+    }
+    static constexpr ops table = {&invoke, &relocate, &destroy};
+  };
+  template <typename F>
+  static bool null_p (F const&) {return false;}
+  template <typename S>
+  static bool null_p (std::function<S> const& f) {return !f;}
+  template <typename T>
+  static bool null_p (T *p) {return !p;}
+
+  template <typename T, typename F>
+  void construct (F &&f, std::true_type)
+  {
+    new (storage) T (std::forward<F> (f));
+    table = &local<T>::table;
+  }
+  template <typename T, typename F>
+  void construct (F &&f, std::false_type)
+  {
+    void *memory = remote<T>::allocate ();
+    T *t;
+    try
+      {
+        t = new (memory) T (std::forward<F> (f));
+      }
+    catch (...)
+      {
+        remote<T>::deallocate (memory);
+        throw;
+      }
+    new (storage) T * (t);
+    table = &remote<T>::table;
+  }
+
+  alignas (std::max_align_t) mutable unsigned char storage[Capacity];
+  ops const *table;
+public:
+  task () noexcept
+    : table ()
+  {}
+  task (std::nullptr_t) noexcept
+    : table ()
+  {}
+  template <typename F,
+            typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, task>::value>::type>
+  task (F &&f)
+    : table ()
+  {
+    typedef typename std::decay<F>::type T;
+    if (!null_p (f))
+      construct<T> (std::forward<F> (f), std::integral_constant<bool, fits<T> ()> ());
+  }
+  task (task &&that) noexcept
+    : table (that.table)
+  {
+    if (table)
+      {
+        table->relocate (that.storage, storage);
+        that.table = nullptr;
+      }
+  }
+  task (task const&) = delete;
+  task &operator = (task const&) = delete;
+  task &operator = (task &&that) noexcept
+  {
+    if (this != &that)
+      {
+        reset ();
+        if (that.table)
+          {
+            that.table->relocate (that.storage, storage);
+            table = that.table;
+            that.table = nullptr;
+          }
+      }
+    return *this;
+  }
+  task &operator = (std::nullptr_t) noexcept
+  {
+    reset ();
+    return *this;
+  }
+  template <typename F,
+            typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, task>::value>::type>
+  task &operator = (F &&f)
+  {
+    return *this = task (std::forward<F> (f));
+  }
+  ~task ()
+  {
+    reset ();
+  }
+  void reset () noexcept
+  {
+    if (table)
+      {
+        table->destroy (storage);
+        table = nullptr;
+      }
+  }
+  explicit operator bool () const noexcept
+  {
+    return table != nullptr;
+  }
+  R operator () (Args... args) const
+  {
+    assert (table);
+    return table->invoke (storage, std::forward<Args> (args)...);
+  }
+};
+
+template <typename R, typename... Args, size_t Capacity>
+template <typename F>
+constexpr typename task<R (Args...), Capacity>::ops task<R (Args...), Capacity>::local<F>::table;
+
+template <typename R, typename... Args, size_t Capacity>
+template <typename F>
+constexpr typename task<R (Args...), Capacity>::ops task<R (Args...), Capacity>::remote<F>::table;
+}
+
+#endif //DZN_TASK_HH
+//version: 2.18.3
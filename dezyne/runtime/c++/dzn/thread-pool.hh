@@ -0,0 +1,240 @@
+// dzn-runtime -- Dezyne runtime library
+//
+// Copyright © 2020, 2023 Rutger van Beusekom <rutger@dezyne.org>
+//
+// This file is part of dzn-runtime.
+//
+// All rights reserved.
+//
+//
+// Commentary:
+//
+// Bounded work-stealing thread pool, behind std_async when the runtime
+// is built with thread-pool.cc instead of std-async.cc, and the shared
+// executor of scheduled pumps, see pump.cc.  Every worker
+// owns a deque: work submitted by a worker goes to the back of its own
+// deque, other work to a shared injection queue, so that it never
+// lands behind a worker that is blocked.  A worker takes work from the
+// back of its own deque, then from the front of the injection queue
+// and, when both are empty, steals from the front of another deque.
+// Work that blocks keeps its worker; the pool therefore starts a
+// thread whenever work is queued and no worker is idle, up to the
+// limit.  With the limit reached, work waits until a worker is done.
+// Work that blocks for its whole lifetime, the loop of a dedicated pump
+// and the thread of a context, does not use the pool but std_thread.
+//
+// Code:
+
+#ifndef DZN_THREAD_POOL_HH
+#define DZN_THREAD_POOL_HH
+
+#include <dzn/config.hh>
+#include <dzn/ring.hh>
+#include <dzn/std-async.hh>
+#include <dzn/task.hh>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace dzn
+{
+namespace thread
+{
+struct metrics
+{
+  size_t threads;
+  size_t idle;
+  size_t queued;
+  size_t executed;
+  size_t steals;
+};
+
+class pool
+{
+  struct job
+  {
+    dzn::task<void ()> work;
+    completion::state *state;
+  };
+  struct worker
+  {
+    pool *owner;
+    std::mutex mut_;
+    dzn::ring<job> deque_;
+    std::thread thread_;
+  };
+  static worker *&current ()
+  {
+    static thread_local worker *w = nullptr;
+    return w;
+  }
+  size_t const limit_;
+  std::unique_ptr<worker[]> workers_;
+  std::mutex inject_mut_;
+  dzn::ring<job> inject_;
+  std::atomic<size_t> started_;
+  std::atomic<size_t> queued_;
+  std::atomic<size_t> idle_;
+  std::atomic<size_t> executed_;
+  std::atomic<size_t> steals_;
+  std::mutex mut_;
+  std::condition_variable con_;
+  bool running_;
+public:
+  explicit pool (size_t limit = DZN_THREAD_POOL_LIMIT)
+    : limit_ (std::max<size_t> (limit, 1))
+    , workers_ (new worker[limit_])
+    , inject_mut_ ()
+    , inject_ ()
+    , started_ (0)
+    , queued_ (0)
+    , idle_ (0)
+    , executed_ (0)
+    , steals_ (0)
+    , mut_ ()
+    , con_ ()
+    , running_ (true)
+  {
+    for (size_t i = 0; i < limit_; ++i)
+      workers_[i].owner = this;
+  }
+  ~pool ()
+  {
+    std::unique_lock<std::mutex> lock (mut_);
+    running_ = false;
+    con_.notify_all ();
+    lock.unlock ();
+    // the workers finish the queued work first
+    for (size_t i = 0; i < started_; ++i)
+      workers_[i].thread_.join ();
+  }
+  dzn::completion async (dzn::task<void ()> &&work)
+  {
+    assert (work);
+    completion::state *state;
+    dzn::completion done = completion::create (state);
+    worker *w = current () && current ()->owner == this ? current () : nullptr;
+    {
+      std::lock_guard<std::mutex> lock (w ? w->mut_ : inject_mut_);
+      (w ? w->deque_ : inject_).push (job {std::move (work), state});
+      ++queued_;
+    }
+    if (idle_ || started_ < limit_)
+      {
+        std::lock_guard<std::mutex> lock (mut_);
+        if (idle_)
+          con_.notify_one ();
+        else if (started_ < limit_)
+          start ();
+      }
+    return done;
+  }
+  size_t size () const
+  {
+    return started_;
+  }
+  size_t limit () const
+  {
+    return limit_;
+  }
+  thread::metrics metrics () const
+  {
+    return {started_.load (), idle_.load (), queued_.load (),
+            executed_.load (), steals_.load ()};
+  }
+private:
+  pool &operator = (pool const &);
+  pool (pool const &);
+
+  void start ()
+  {
+    worker &w = workers_[started_];
+    w.thread_ = std::thread ([this, &w] {run (w);});
+    ++started_;
+  }
+  void run (worker &self)
+  {
+    current () = &self;
+    job j;
+    for (;;)
+      {
+        if (pop (self, j) || take (j) || steal (self, j))
+          {
+            std::exception_ptr exception;
+            try
+              {
+                j.work ();
+              }
+            catch (...)
+              {
+                exception = std::current_exception ();
+              }
+            j.work = nullptr;
+            ++executed_;
+            completion::finish (j.state, exception);
+            continue;
+          }
+        std::unique_lock<std::mutex> lock (mut_);
+        ++idle_;
+        con_.wait (lock, [this] {return queued_ || !running_;});
+        --idle_;
+        if (!running_ && !queued_)
+          break;
+      }
+    current () = nullptr;
+  }
+  bool pop (worker &self, job &j)
+  {
+    std::lock_guard<std::mutex> lock (self.mut_);
+    if (self.deque_.empty ())
+      return false;
+    j = std::move (self.deque_.back ());
+    self.deque_.pop_back ();
+    --queued_;
+    return true;
+  }
+  bool take (job &j)
+  {
+    std::lock_guard<std::mutex> lock (inject_mut_);
+    if (inject_.empty ())
+      return false;
+    j = std::move (inject_.front ());
+    inject_.pop ();
+    --queued_;
+    return true;
+  }
+  bool steal (worker &self, job &j)
+  {
+    size_t n = started_;
+    size_t first = &self - workers_.get ();
+    for (size_t i = 1; i < n; ++i)
+      {
+        worker &victim = workers_[(first + i) % n];
+        std::lock_guard<std::mutex> lock (victim.mut_);
+        if (!victim.deque_.empty ())
+          {
+            j = std::move (victim.deque_.front ());
+            victim.deque_.pop ();
+            --queued_;
+            ++steals_;
+            return true;
+          }
+      }
+    return false;
+  }
+};
+}
+
+dzn::thread::metrics thread_pool_metrics ();
+size_t thread_pool_size ();
+}
+
+#endif //DZN_THREAD_POOL_HH
+//version: 2.18.3
@@ -0,0 +1,107 @@
+// dzn-runtime -- Dezyne runtime library
+//
+// This file is part of dzn-runtime.
+//
+// All rights reserved.
+//
+//
+// Commentary:
+//
+// Hierarchical timer wheel for the pump timers.  Time is counted in
+// millisecond ticks; five levels of 64 slots cover 2^30 ms, later
+// deadlines wait in the last slot of the top level.  Timers live in a
+// node array linked into their slot, and an open addressing table maps
+// timer identifiers to nodes, so arming and cancelling a timer is O(1)
+// and does not allocate once the arrays have grown.  When a slot comes
+// due its timers move to the ready list in deadline order; pop () hands
+// them out one at a time, so that a timer cancelled by an earlier one
+// does not fire.
+//
+// Code:
+
+#ifndef DZN_TIMER_WHEEL_HH
+#define DZN_TIMER_WHEEL_HH
+
+#include <dzn/task.hh>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dzn
+{
+class timer_wheel
+{
+public:
+  typedef std::chrono::steady_clock clock;
+  timer_wheel ();
+  timer_wheel (timer_wheel const&) = delete;
+  timer_wheel &operator = (timer_wheel const&) = delete;
+  // Arm timer IDENTIFIER to run EVENT MILLISECONDS after NOW;
+  // IDENTIFIER must not be armed.
+  void arm (size_t identifier, clock::time_point now, size_t milliseconds,
+            dzn::task<void ()> &&event);
+  // Cancel timer IDENTIFIER; returns false when it is not armed.
+  bool cancel (size_t identifier);
+  // Move the timers that are due at NOW to the ready list.
+  void advance (clock::time_point now);
+  // Take the earliest ready timer that is due at NOW.
+  bool pop (clock::time_point now, dzn::task<void ()> &event);
+  // Whether a timer is due at NOW.
+  bool expired (clock::time_point now);
+  // When the pump should look again: the earliest ready deadline or the
+  // start of the first occupied slot.
+  clock::time_point next () const;
+  bool empty () const {return !armed;}
+  size_t size () const {return armed;}
+private:
+  static constexpr size_t levels = 5;
+  static constexpr size_t bits = 6;
+  static constexpr size_t slots = size_t (1) << bits;
+  static constexpr std::uint32_t nil = ~std::uint32_t (0);
+  static constexpr std::uint16_t ready_list = levels * slots;
+  struct node
+  {
+    dzn::task<void ()> event;
+    size_t id;
+    std::int64_t time;
+    std::uint32_t prev;
+    std::uint32_t next;
+    std::uint16_t list;
+  };
+  struct list
+  {
+    std::uint32_t head;
+    std::uint32_t tail;
+  };
+  clock::time_point start;
+  std::uint64_t current;
+  size_t armed;
+  size_t wheeled;
+  std::vector<node> nodes;
+  std::uint32_t vacant;
+  list lists[levels * slots + 1];
+  std::uint64_t occupied[levels];
+  std::vector<std::uint32_t> index;
+  std::vector<std::uint32_t> due;
+
+  std::int64_t since_start (clock::time_point time) const;
+  std::uint64_t expiry (std::uint32_t n) const;
+  void place (std::uint32_t n);
+  void link (std::uint16_t l, std::uint32_t n);
+  void unlink (std::uint32_t n);
+  void cascade (size_t level, size_t slot);
+  void drain (size_t slot);
+  std::uint32_t allocate ();
+  void release (std::uint32_t n);
+  size_t hash (size_t identifier) const;
+  std::uint32_t find (size_t identifier) const;
+  void insert (std::uint32_t n);
+  void erase (size_t identifier);
+  void grow ();
+};
+}
+
+#endif //DZN_TIMER_WHEEL_HH
+//version: 2.18.3
@@ -12,6 +12,15 @@
 //
 // Commentary:
 //
+// A pump constructed with an executor does not own a thread.  It runs
+// on the executor while it has work and parks when it runs out: its
+// coroutine returns to the driver, which returns to the executor.  An
+// event, resume, stop or the alarm thread, which keeps the first timer
+// deadline of every parked pump, schedules it again.  Only a quiescent
+// pump parks, one whose single coroutine has returned; a pump with
+// blocked coroutines keeps its thread, so that no suspended stack ever
+// moves to another thread.
+//
 // Code:
 
 #include <dzn/std-async.hh>
@@ -20,6 +29,8 @@
 #include <dzn/pump.hh>
 #include <dzn/runtime.hh>
 
+#include <dzn/timer-wheel.hh>
+
 #include <algorithm>
 #include <cassert>
 #include <iterator>
@@ -27,10 +38,10 @@
 
 namespace dzn
 {
-static std::list<coroutine>::iterator find_self (std::list<coroutine> &coroutines);
+static coroutine *find_self (coroutine_list &coroutines);
 void
-defer (dzn::locator const& locator, std::function<bool ()> &&predicate,
-            std::function<void (size_t)> &&event)
+defer (dzn::locator const& locator, dzn::task<bool ()> &&predicate,
+            dzn::task<void (size_t)> &&event)
 {
   locator.get<dzn::pump> ().defer (std::move (predicate), std::move (event));
 }
@@ -82,8 +93,10 @@ port_blocked_p (dzn::locator const& locator, void *port)
   return pump ? pump->blocked_p (port) : false;
 }
 
-static std::list<coroutine>::iterator
-find_self (std::list<coroutine> &coroutines)
+// The coroutine that is not blocked and has not finished: the one that
+// is running, kept as pump::current.
+static coroutine *
+find_self (coroutine_list &coroutines)
 {
   auto coroutine_p = [] (dzn::coroutine const& coroutine)
   {return coroutine.port == nullptr && !coroutine.finished;};
@@ -95,42 +108,138 @@ find_self (std::list<coroutine> &coroutines)
   assert (count < 3);
   assert (count == 1);
 #endif
-  return std::find_if (coroutines.begin (), coroutines.end (), coroutine_p);
+  auto it = std::find_if (coroutines.begin (), coroutines.end (), coroutine_p);
+  return it != coroutines.end () ? &*it : nullptr;
 }
 
-static std::list<coroutine>::iterator
-find_blocked (std::list<coroutine> &coroutines,
-                                                    void *port)
+static coroutine *
+find_blocked (coroutine_list &coroutines, void *port)
 {
-  return std::find_if (coroutines.begin (), coroutines.end (),
-                       [port] (dzn::coroutine & c) {return c.port == port;});
+  auto it = std::find_if (coroutines.begin (), coroutines.end (),
+                          [port] (dzn::coroutine & c) {return c.port == port;});
+  return it != coroutines.end () ? &*it : nullptr;
 }
 
 static void
-remove_finished_coroutines (std::list<coroutine> &coroutines)
+remove_finished_coroutines (coroutine_list &coroutines,
+                            std::vector<coroutine *> &finished)
+{
+  for (auto c : finished)
+    {
+      debug.rdbuf () && debug << "[" << c->id << "] removing" << std::endl;
+      coroutines.erase (c);
+    }
+  finished.clear ();
+}
+
+namespace
+{
+// Wakes parked pumps at their first timer deadline, on a thread shared
+// by all pumps.
+class alarm
 {
-  coroutines.remove_if ([] (dzn::coroutine & c)
+  std::mutex mutex;
+  std::condition_variable condition;
+  dzn::timer_wheel wheel;
+  bool started;
+  void run ()
   {
-    if (c.finished) debug.rdbuf () && debug << "[" << c.id << "] removing"
-                                            << std::endl;
-    return c.finished;
-  });
+    std::unique_lock<std::mutex> lock (mutex);
+    for (;;)
+      {
+        auto now = std::chrono::steady_clock::now ();
+        wheel.advance (now);
+        dzn::task<void ()> wake;
+        while (wheel.pop (now, wake))
+          wake ();
+        if (wheel.empty ())
+          condition.wait (lock);
+        else
+          condition.wait_until (lock, wheel.next ());
+      }
+  }
+public:
+  alarm ()
+    : started (false)
+  {}
+  void arm (pump *p, std::chrono::steady_clock::time_point time)
+  {
+    std::lock_guard<std::mutex> lock (mutex);
+    if (!started)
+      {
+        std::thread ([this] {run ();}).detach ();
+        started = true;
+      }
+    auto now = std::chrono::steady_clock::now ();
+    size_t ms = time <= now ? 0
+      : std::chrono::duration_cast<std::chrono::milliseconds> (time - now
+          + std::chrono::milliseconds (1) - std::chrono::nanoseconds (1)).count ();
+    size_t id = reinterpret_cast<size_t> (p);
+    wheel.cancel (id);
+    wheel.arm (id, now, ms, [p] {p->wake ();});
+    condition.notify_one ();
+  }
+  void cancel (pump *p)
+  {
+    std::lock_guard<std::mutex> lock (mutex);
+    wheel.cancel (reinterpret_cast<size_t> (p));
+  }
+};
+
+// never destroyed: its thread is detached
+alarm &
+alarms ()
+{
+  static alarm *a = new alarm;
+  return *a;
+}
 }
 
-pump::deadline::deadline (size_t id, size_t ms)
-  : id (id)
-  , time (std::chrono::steady_clock::now () + std::chrono::milliseconds (ms))
+pump::pump ()
+  : pump (DZN_CONTEXT_STACK_SIZE, DZN_STACK_POOL_HIGH_WATER)
 {}
 
-pump::pump ()
+pump::pump (std::function<void (dzn::task<void ()> &&)> const& executor)
+  : pump (executor, DZN_CONTEXT_STACK_SIZE, DZN_STACK_POOL_HIGH_WATER)
+{}
+
+pump::pump (size_t stack_size, size_t high_water)
   : unblocked ()
   , running (true)
   , paused (false)
+  , stacks (stack_size, high_water)
   , current_coroutine (0)
+  , current ()
+  , finished_coroutines ()
   , switch_context ()
-  , task (dzn::std_async (std::ref (*this)))
+  , sleeping (false)
+  , executor ()
+  , schedule (RUNNING)
+  , parking (false)
+  , stopped ()
+  , task (dzn::std_thread (std::ref (*this)))
 {}
 
+pump::pump (std::function<void (dzn::task<void ()> &&)> const& executor,
+            size_t stack_size, size_t high_water)
+  : unblocked ()
+  , running (true)
+  , paused (false)
+  , stacks (stack_size, high_water)
+  , current_coroutine (0)
+  , current ()
+  , finished_coroutines ()
+  , switch_context ()
+  , sleeping (false)
+  , executor (executor)
+  , schedule (PARKED)
+  , parking (false)
+  , stopped ()
+  , task (dzn::completion::create (stopped))
+{
+  wake ();
+}
+
 pump::~pump ()
 {
   stop ();
@@ -139,7 +248,7 @@ pump::~pump ()
 bool
 pump::blocked_p (void *port)
 {
-  return find_blocked (coroutines, port) != coroutines.end ();
+  return find_blocked (coroutines, port);
 }
 
 void
@@ -152,7 +261,10 @@ pump::stop ()
       running = false;
       condition.notify_one ();
       lock.unlock ();
+      wake ();
       task.wait ();
+      if (executor)
+        alarms ().cancel (this);
     }
 }
 
@@ -179,6 +291,8 @@ pump::resume ()
   std::unique_lock<std::mutex> lock (mutex);
   paused = false;
   condition.notify_one ();
+  lock.unlock ();
+  wake ();
 }
 
 void
@@ -195,57 +309,77 @@ pump::operator () ()
 {
   try
     {
-      auto work_p = [this] {return queue.size () || deferred.size () || !running;};
-
-      worker = [&]
+      schedule = RUNNING;
+      worker = [this]
       {
-        std::unique_lock<std::mutex> lock (mutex);
-        if (queue.empty ())
-          idle.notify_one ();
-
-        if (queue.empty () && deferred.empty ())
+        auto work_p = [this] {return !queue.empty () || deferred.size () || !running;};
+        parking = false;
+        dzn::task<void ()> f;
+        if (!queue.pop (f))
           {
-            if (timers.size ())
-              condition.wait_until (lock, timers.begin ()->first.time, work_p);
-            else
-              condition.wait (lock, work_p);
-          }
-
-        if (queue.size ())
-          {
-            std::function<void ()> f (std::move (queue.front ()));
-            queue.pop ();
+            if (executor)
+              remove_finished_coroutines (coroutines, finished_coroutines);
+            std::unique_lock<std::mutex> lock (mutex);
+            idle.notify_one ();
+            // a scheduled pump gives up its thread instead of sleeping
+            if (deferred.empty () && executor && quiescent ())
+              parking = true;
+            else if (deferred.empty ())
+              {
+                // producers take the mutex only to wake us from here
+                sleeping = true;
+                if (timers.size ())
+                  condition.wait_until (lock, timers.next (), work_p);
+                else
+                  condition.wait (lock, work_p);
+                sleeping = false;
+              }
             lock.unlock ();
-            f ();
-            lock.lock ();
+            queue.pop (f);
           }
 
-        if (queue.empty () && deferred.size () && deferred.front ().first ())
+        if (f)
+          f ();
+
+        // deferred and timers belong to the pump thread; the mutex is
+        // only needed when there is something to do
+        if (deferred.size () && queue.empty ())
           {
-            auto p = deferred.front ();
-            deferred.erase (deferred.begin ());
-            lock.unlock ();
-            p.second (current_coroutine);
-            lock.lock ();
+            std::unique_lock<std::mutex> lock (mutex);
+            if (deferred.front ().first ())
+              {
+                auto p = std::move (deferred.front ());
+                deferred.pop ();
+                lock.unlock ();
+                p.second (current_coroutine);
+              }
           }
 
-        auto now = std::chrono::steady_clock::now ();
-        while (timers_expired (now))
+        if (timers.size ())
           {
-            auto f (timers.begin ()->second);
-            timers.erase (timers.begin ());
-            lock.unlock ();
-            f ();
-            lock.lock ();
+            std::unique_lock<std::mutex> lock (mutex);
+            auto now = std::chrono::steady_clock::now ();
+            timers.advance (now);
+            dzn::task<void ()> timeout;
+            while (timers.pop (now, timeout))
+              {
+                lock.unlock ();
+                timeout ();
+                lock.lock ();
+              }
           }
       };
 
       coroutine zero;
       debug.rdbuf () &&debug << "coroutine zero: "
                              << zero.id << std::endl;
-      create_context ();
-      debug.rdbuf () &&debug << "coroutine self: "
-                             << find_self (coroutines)->id << std::endl;
+      // a scheduled pump comes back here after parking
+      if (coroutines.empty ())
+        {
+          create_context ();
+          debug.rdbuf () &&debug << "coroutine self: "
+                                 << coroutines.back ().id << std::endl;
+        }
 
       exit = [&]
       {
@@ -255,14 +389,18 @@ pump::operator () ()
       };
 
       std::unique_lock<std::mutex> lock (mutex);
-      while (running || queue.size () || collateral_blocked.size ())
+      while (running || !queue.empty () || collateral_blocked.size ())
         {
+          if (executor && (parking || paused) && park ())
+            return;
           condition.wait (lock, [this] {return !paused;});
           lock.unlock ();
           assert (coroutines.size ());
-          coroutines.back ().call (zero);
+          current = &coroutines.back ();
+          current->call (zero);
+          current = nullptr;
           lock.lock ();
-          remove_finished_coroutines (coroutines);
+          remove_finished_coroutines (coroutines, finished_coroutines);
         }
       debug.rdbuf () &&debug << "finish pump; #coroutines: " << coroutines.size ()
                              << " #collateral: " << collateral_blocked.size () << std::endl;
@@ -276,6 +414,13 @@ pump::operator () ()
       assert (coroutines.size () != 2);
       assert (coroutines.size () < 3);
       assert (coroutines.size () == 1);
+      if (executor)
+        {
+          // stop () may destroy the pump as soon as it is finished
+          lock.unlock ();
+          schedule = STOPPED;
+          completion::finish (stopped);
+        }
     }
   catch (std::exception const& exception)
     {
@@ -285,15 +430,56 @@ pump::operator () ()
 }
 
 bool
-pump::timers_expired (std::chrono::steady_clock::time_point const& now) const
+pump::timers_expired (std::chrono::steady_clock::time_point const& now)
+{
+  return timers.size () && timers.expired (now);
+}
+
+bool
+pump::quiescent () const
+{
+  return coroutines.size () == 1 && collateral_blocked.empty ()
+    && switch_context.empty () && unblocked.empty ();
+}
+
+// Called with the mutex held when the coroutine returned for lack of
+// work, or when paused.  Returns false when work arrived meanwhile and
+// the pump should go on.
+bool
+pump::park ()
+{
+  parking = false;
+  // before publishing PARKED: from then on a new run may own the timers
+  if (timers.size ())
+    alarms ().arm (this, timers.next ());
+  schedule = PARKED;
+  if (paused || (queue.empty () && running))
+    return true;
+  int parked = PARKED;
+  return !schedule.compare_exchange_strong (parked, RUNNING);
+}
+
+void
+pump::wake ()
 {
-  return timers.size () && timers.begin ()->first.expired (now);
+  int parked = PARKED;
+  if (executor && schedule.compare_exchange_strong (parked, QUEUED))
+    executor ([this] {(*this) ();});
 }
 
 size_t
 pump::coroutine_id ()
 {
-  return find_self (coroutines)->id;
+  assert (!current || current == find_self (coroutines));
+  return current ? current->id : find_self (coroutines)->id;
+}
+
+void
+pump::switch_to (dzn::coroutine &from, dzn::coroutine &to)
+{
+  current = &to;
+  from.yield_to (to);
+  current = &from;
 }
 
 void
@@ -303,15 +489,18 @@ pump::create_context ()
   {
     try
       {
-        auto self = find_self (coroutines);
+        dzn::coroutine *self = current;
+        assert (self == find_self (coroutines));
         debug.rdbuf () &&debug << "[" << self->id << "] create context"
                                << std::endl;
         context_switch ();
-        while (running || queue.size () || timers_expired (std::chrono::steady_clock::now ()))
+        while (running || !queue.empty () || timers_expired (std::chrono::steady_clock::now ()))
           {
             worker ();
             if (unblocked.size ()) collateral_release (self);
             context_switch ();
+            if (parking && quiescent ())
+              break;
           }
         exit ();
       }
@@ -326,7 +515,7 @@ pump::create_context ()
                                << std::endl;
         std::terminate ();
       }
-  });
+  }, &stacks);
 }
 
 void
@@ -336,7 +525,7 @@ pump::context_switch ()
     {
       debug.rdbuf () &&debug << "context_switch" << std::endl;
       auto context = std::move (switch_context.front ());
-      switch_context.erase (switch_context.begin ());
+      switch_context.pop ();
       context ();
     }
 }
@@ -344,17 +533,17 @@ pump::context_switch ()
 void
 pump::collateral_block (dzn::runtime &runtime, dzn::component *component)
 {
-  auto self = find_self (coroutines);
+  dzn::coroutine *self = current;
   debug.rdbuf () &&debug << "[" << self->id << "] collateral_block"
                          << std::endl;
 
-  collateral_blocked.splice (collateral_blocked.end (), coroutines, self);
+  collateral_blocked.splice (coroutines, self);
 
   self->component = component;
   size_t coroutine_id = runtime.handling (component) ? runtime.handling (component) : runtime.blocked (component);
-  auto it = find_if (coroutines.begin (), coroutines.end (),
-                     [coroutine_id] (dzn::coroutine & coroutine)
-                     {return coroutine.id == coroutine_id;});
+  auto it = std::find_if (coroutines.begin (), coroutines.end (),
+                          [coroutine_id] (dzn::coroutine & coroutine)
+                          {return coroutine.id == coroutine_id;});
 
   if (it == coroutines.end () || !it->port)
     throw std::runtime_error ("blocking port not found");
@@ -365,14 +554,14 @@ pump::collateral_block (dzn::runtime &runtime, dzn::component *component)
                          << self->port << std::endl;
 
   create_context ();
-  self->yield_to (coroutines.back ());
+  switch_to (*self, coroutines.back ());
 
   debug.rdbuf () &&debug << "[" << self->id << "] collateral_unblock"
                          << std::endl;
 }
 
 void
-pump::collateral_release (std::list<coroutine>::iterator self)
+pump::collateral_release (dzn::coroutine *self)
 {
   debug.rdbuf () &&debug << "[" << self->id << "] collateral_release"
                          << std::endl;
@@ -394,10 +583,11 @@ pump::collateral_release (std::list<coroutine>::iterator self)
         {
           debug.rdbuf () &&debug << "collateral_unblocking: " << it->id
                                  << " for port: " << it->port << " " << std::endl;
-          coroutines.splice (coroutines.end (), collateral_blocked, it);
+          coroutines.splice (collateral_blocked, &*it);
           coroutines.back ().port = nullptr;
           self->finished = true;
-          self->yield_to (coroutines.back ());
+          finished_coroutines.push_back (self);
+          switch_to (*self, coroutines.back ());
         }
     }
   while (it != collateral_blocked.end ());
@@ -414,7 +604,7 @@ pump::collateral_release (std::list<coroutine>::iterator self)
 void
 pump::block (dzn::runtime &runtime, dzn::component *component, void *port)
 {
-  auto self = find_self (coroutines);
+  dzn::coroutine *self = current;
   runtime.blocked (component) = self->id;
   runtime.handling (component) = 0;
   runtime.flush (component, self->id, true);
@@ -449,7 +639,7 @@ pump::block (dzn::runtime &runtime, dzn::component *component, void *port)
     }
 
   assert (coroutines.back ().port == nullptr);
-  self->yield_to (coroutines.back ());
+  switch_to (*self, coroutines.back ());
   debug.rdbuf () &&debug << "[" << self->id << "] entered context" << std::endl;
   if (debug.rdbuf ())
     {
@@ -458,7 +648,7 @@ pump::block (dzn::runtime &runtime, dzn::component *component, void *port)
         debug << coroutine.id << " ";
       debug << std::endl;
     }
-  remove_finished_coroutines (coroutines);
+  remove_finished_coroutines (coroutines, finished_coroutines);
   runtime.reset_skip_block (component);
   runtime.blocked (component) = 0;
 }
@@ -467,11 +657,12 @@ bool
 pump::collateral_release_skip_block (dzn::component *component)
 {
   bool have_collateral = false;
-  collateral_blocked.reverse ();
-  auto it = collateral_blocked.begin ();
-  while (it != collateral_blocked.end ())
+  // from the back, the most recently blocked first
+  dzn::coroutine *self = collateral_blocked.empty () ? nullptr
+    : &collateral_blocked.back ();
+  for (dzn::coroutine *previous; self; self = previous)
     {
-      auto self = it++;
+      previous = self->previous;
       if (self->component == component
           && std::find_if (unblocked.begin (), unblocked.end (),
                            [&] (void *port)
@@ -482,22 +673,21 @@ pump::collateral_release_skip_block (dzn::component *component)
           have_collateral = true;
           self->component = nullptr;
           self->port = nullptr;
-          coroutines.splice (coroutines.end (), collateral_blocked, self);
+          coroutines.splice (collateral_blocked, self);
         }
     }
-  collateral_blocked.reverse ();
   return have_collateral;
 }
 void pump::release (dzn::runtime &runtime, dzn::component *component, void *port)
 {
   runtime.set_skip_block (component, port);
 
-  auto self = find_self (coroutines);
+  dzn::coroutine *self = current;
   debug.rdbuf () &&debug << "[" << self->id << "] release of "
                          << port << std::endl;
 
-  auto blocked = find_blocked (coroutines, port);
-  if (blocked == coroutines.end ())
+  dzn::coroutine *blocked = find_blocked (coroutines, port);
+  if (!blocked)
     {
       debug.rdbuf () &&debug << "[" << self->id << "] skip block" << std::endl;
       return;
@@ -505,9 +695,10 @@ void pump::release (dzn::runtime &runtime, dzn::component *component, void *port
 
   debug.rdbuf () &&debug << "[" << blocked->id << "] unblock" << std::endl;
 
-  switch_context.emplace_back ([blocked, this]
+  switch_context.emplace ([blocked, this]
   {
-    auto self = find_self (this->coroutines);
+    dzn::coroutine *self = this->current;
+    assert (self == find_self (this->coroutines));
     debug.rdbuf () &&debug << "setting unblocked to port "
                            << blocked->port << std::endl;
     this->unblocked.push_back (blocked->port);
@@ -518,63 +709,58 @@ void pump::release (dzn::runtime &runtime, dzn::component *component, void *port
     debug.rdbuf () &&debug << "[" << blocked->id << "] to" << std::endl;
 
     self->finished = true;
-    self->yield_to (*blocked);
+    this->finished_coroutines.push_back (self);
+    switch_to (*self, *blocked);
     assert (!"we must never return here!!!");
   });
 }
 
 void
-pump::operator () (std::function<void ()> const& event)
+pump::operator () (dzn::task<void ()> &&event)
 {
   assert (event);
-  std::lock_guard<std::mutex> lock (mutex);
-  queue.push (event);
-  condition.notify_one ();
-}
-
-void
-pump::operator () (std::function<void ()> &&event)
-{
-  assert (event);
-  std::lock_guard<std::mutex> lock (mutex);
   queue.push (std::move (event));
-  condition.notify_one ();
+  if (sleeping)
+    {
+      std::lock_guard<std::mutex> lock (mutex);
+      condition.notify_one ();
+    }
+  else
+    wake ();
 }
 
 void
-pump::defer (std::function<bool ()> &&predicate,
-             std::function<void (size_t)> &&event)
+pump::defer (dzn::task<bool ()> &&predicate,
+             dzn::task<void (size_t)> &&event)
 {
-  deferred.emplace_back (std::move (predicate), std::move (event));
+  deferred.emplace (std::move (predicate), std::move (event));
 }
 
 void
 pump::prune_deferred ()
 {
-  deferred.erase (std::remove_if (deferred.begin (), deferred.end (),
-                                  [] (typename decltype (deferred)::value_type const& e)
-                                  {return !e.first ();}),
-                  deferred.end ());
+  // rotate once through the ring, keeping the order of what remains
+  for (size_t n = deferred.size (); n; --n)
+    {
+      auto e = std::move (deferred.front ());
+      deferred.pop ();
+      if (e.first ())
+        deferred.push (std::move (e));
+    }
 }
 
 void
 pump::handle (size_t identifier, size_t milliseconds,
-                   std::function<void ()> const& event)
+                   dzn::task<void ()> &&event)
 {
-  assert (event);
-  assert (std::find_if (timers.begin (), timers.end (),
-                        [identifier] (std::pair<deadline, std::function<void ()>> const &pair)
-                        { return pair.first.id == identifier; }) == timers.end ());
-  timers.emplace (deadline (identifier, milliseconds), event);
+  timers.arm (identifier, std::chrono::steady_clock::now (), milliseconds,
+              std::move (event));
 }
 
 void
 pump::remove (size_t identifier)
 {
-  auto it = std::find_if (timers.begin (), timers.end (),
-                          [identifier] (typename decltype (timers)::value_type const& pair)
-                          { return pair.first.id == identifier; });
-  if (it != timers.end ()) timers.erase (it);
+  timers.cancel (identifier);
 }
 }
 //version: 2.18.3
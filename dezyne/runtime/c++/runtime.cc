@@ -17,12 +17,79 @@
 #include <dzn/coroutine.hh>
 
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
 
 namespace dzn
 {
 std::ostream debug (nullptr);
-runtime::runtime () : defer () {}
+runtime::runtime ()
+  : defer ()
+  , states ()
+  , ids ()
+  , last_component ()
+  , last_state ()
+{}
+
+static size_t const no_id = size_t (-1);
+
+static size_t
+component_hash (dzn::component *component)
+{
+  std::uint64_t h = reinterpret_cast<std::uintptr_t> (component)
+    * std::uint64_t (0x9e3779b97f4a7c15ull);
+  return h ^ (h >> 32);
+}
+
+runtime::state *
+runtime::find (dzn::component *component)
+{
+  if (last_state && component == last_component)
+    return last_state;
+  if (ids.empty ())
+    return nullptr;
+  size_t mask = ids.size () - 1;
+  for (size_t i = component_hash (component) & mask; ids[i].id != no_id;
+       i = (i + 1) & mask)
+    if (ids[i].component == component)
+      {
+        last_component = component;
+        last_state = &states[ids[i].id];
+        return last_state;
+      }
+  return nullptr;
+}
+
+runtime::state &
+runtime::at (dzn::component *component)
+{
+  if (state *s = find (component))
+    return *s;
+  if (2 * (states.size () + 1) > ids.size ())
+    {
+      std::vector<entry> old (std::max<size_t> (2 * ids.size (), 64),
+                              entry {nullptr, no_id});
+      old.swap (ids);
+      size_t mask = ids.size () - 1;
+      for (auto const& e : old)
+        if (e.id != no_id)
+          {
+            size_t i = component_hash (e.component) & mask;
+            while (ids[i].id != no_id)
+              i = (i + 1) & mask;
+            ids[i] = e;
+          }
+    }
+  size_t mask = ids.size () - 1;
+  size_t i = component_hash (component) & mask;
+  while (ids[i].id != no_id)
+    i = (i + 1) & mask;
+  ids[i] = entry {component, states.size ()};
+  states.emplace_back ();
+  last_component = component;
+  last_state = &states.back ();
+  return *last_state;
+}
 
 void
 trace_in (std::ostream &os, port::meta const &meta, const char *event_name)
@@ -70,85 +137,89 @@ trace_qout (std::ostream &os, port::meta const &meta, const char *event_name)
 bool
 runtime::external (dzn::component *component)
 {
-  return (states.find (component) == states.end ());
+  return !find (component);
 }
 
 int &
 runtime::activity (dzn::locator const& locator)
 {
-  return coroutine_id2activity[coroutine_id(locator)];
+  size_t id = coroutine_id (locator);
+  if (id >= coroutine_id2activity.size ())
+    coroutine_id2activity.resize (id + 1);
+  return coroutine_id2activity[id];
 }
 
 size_t &
 runtime::handling (dzn::component *component)
 {
-  return states[component].handling;
+  return at (component).handling;
 }
 
 size_t &
 runtime::blocked (dzn::component *component)
 {
-  return states[component].blocked;
+  return at (component).blocked;
 }
 
-std::function<void()> &
+dzn::task<void ()> &
 runtime::deferred_flush (dzn::component *component)
 {
-  return states[component].port_update;
+  return at (component).port_update;
 }
 
 dzn::component *&
 runtime::deferred (dzn::component *component)
 {
-  return states[component].deferred;
+  return at (component).deferred;
 }
 
-std::queue<std::function<void ()> > &
+dzn::ring<dzn::task<void ()>> &
 runtime::queue (dzn::component *component)
 {
-  return states[component].queue;
+  return at (component).queue;
 }
 
 bool &
 runtime::performs_flush (dzn::component *component)
 {
-  return states[component].performs_flush;
+  return at (component).performs_flush;
 }
 
 bool &
 runtime::native (dzn::component *component)
 {
-  return states[component].native;
+  return at (component).native;
 }
 
 bool
 runtime::skip_block (dzn::component *component, void *port)
 {
-  return states[component].skip == port;
+  return at (component).skip == port;
 }
 
 void
 runtime::set_skip_block (dzn::component *component, void *port)
 {
-  states[component].skip = port;
+  at (component).skip = port;
 }
 
 void
 runtime::reset_skip_block (dzn::component *component)
 {
-  states[component].skip = nullptr;
+  at (component).skip = nullptr;
 }
 
 void
 runtime::flush (dzn::component *component, size_t coroutine_id, bool sync_p)
 {
-  std::queue<std::function<void ()> > &q = queue (component);
-  auto &flush = this->deferred_flush (component);
-  handling (component) = coroutine_id;
+  state &self = at (component);
+  dzn::ring<dzn::task<void ()>> &q = self.queue;
+  auto &flush = self.port_update;
+  self.handling = coroutine_id;
   bool flushed = false;
   while (!q.empty ())
     {
-      std::function<void ()> event = q.front ();
+      dzn::task<void ()> event (std::move (q.front ()));
       q.pop ();
       if (!flushed && !sync_p && flush)
       {
@@ -158,18 +229,19 @@ runtime::flush (dzn::component *component, size_t coroutine_id, bool sync_p)
       flush = nullptr;
       event ();
     }
-  handling (component) = 0;
-  dzn::component *target = deferred (component);
+  self.handling = 0;
+  dzn::component *target = self.deferred;
   if (!sync_p && target)
     {
-      deferred (component) = nullptr;
+      self.deferred = nullptr;
       if (!handling (target))
         runtime::flush (target, coroutine_id, sync_p);
     }
   else if (!sync_p && this->deferred_flush (nullptr))
     {
-      this->deferred_flush (nullptr) ();
-      this->deferred_flush (nullptr) = nullptr;
+      auto &external = this->deferred_flush (nullptr);
+      external ();
+      external = nullptr;
     }
 }
 }
@@ -0,0 +1,142 @@
+// dzn-runtime -- Dezyne runtime library
+//
+// This file is part of dzn-runtime.
+//
+// All rights reserved.
+//
+//
+// Commentary:
+//
+// Without mmap, as on platforms where coroutines run on threads of
+// their own, stacks come from the heap and have no guard page.
+//
+// Code:
+
+#include <dzn/stack-pool.hh>
+
+#include <cassert>
+#include <new>
+
+#if defined (__unix__) || defined (__APPLE__)
+#define DZN_STACK_MMAP 1
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define DZN_STACK_MMAP 0
+#endif
+
+namespace dzn
+{
+size_t
+stack_pool::page_size ()
+{
+#if DZN_STACK_MMAP
+  static size_t const page = sysconf (_SC_PAGESIZE);
+  return page;
+#else
+  return 64;
+#endif
+}
+
+void *
+stack_pool::map (size_t stack_size, size_t &size)
+{
+  size_t page = page_size ();
+  stack_size = (stack_size + page - 1) / page * page;
+#if DZN_STACK_MMAP
+  // the lowest page is a guard page, so an overflow faults
+  size = stack_size + page;
+  void *memory = mmap (nullptr, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED)
+    throw std::bad_alloc ();
+  mprotect (memory, page, PROT_NONE);
+  return memory;
+#else
+  size = stack_size + page;
+  return ::operator new (size);
+#endif
+}
+
+void
+stack_pool::unmap (void *stack, size_t size)
+{
+#if DZN_STACK_MMAP
+  munmap (stack, size);
+#else
+  (void) size;
+  ::operator delete (stack);
+#endif
+}
+
+stack_pool::stack_pool (size_t stack_size, size_t high_water)
+  : stack_size ((stack_size + page_size () - 1) / page_size () * page_size ())
+  , guard_size (page_size ())
+  , high_water (high_water)
+  , unused ()
+  , in_use (0)
+  , peak (0)
+  , maps (0)
+  , reuses (0)
+{}
+
+stack_pool::~stack_pool ()
+{
+  assert (!in_use);
+  for (auto stack : unused)
+    unmap (stack, size ());
+}
+
+void
+stack_pool::reserve (size_t count)
+{
+  unused.reserve (count);
+  while (unused.size () < count)
+    {
+      size_t mapped;
+      unused.push_back (map (stack_size, mapped));
+      ++maps;
+    }
+}
+
+void *
+stack_pool::allocate ()
+{
+  void *stack;
+  if (unused.size ())
+    {
+      stack = unused.back ();
+      unused.pop_back ();
+      ++reuses;
+    }
+  else
+    {
+      size_t mapped;
+      stack = map (stack_size, mapped);
+      assert (mapped == size ());
+      ++maps;
+    }
+  if (++in_use > peak)
+    peak = in_use;
+  return stack;
+}
+
+void
+stack_pool::deallocate (void *stack)
+{
+  assert (in_use);
+  --in_use;
+  if (unused.size () < high_water)
+    unused.push_back (stack);
+  else
+    unmap (stack, size ());
+}
+
+stack_pool::statistics
+stack_pool::stats () const
+{
+  return {stack_size, guard_size, high_water, in_use, unused.size (), peak,
+          (in_use + unused.size ()) * size (), maps, reuses};
+}
+}
+//version: 2.18.3
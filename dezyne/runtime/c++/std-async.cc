@@ -11,15 +11,16 @@
 //
 // Code:
 
+#include <dzn/std-async.hh>
+
 #include <functional>
-#include <future>
 
 namespace dzn
 {
-std::future<void>
+dzn::completion
 std_async (std::function<void ()> const &work)
 {
-  return std::async (std::launch::async, work);
+  return std_thread (work);
 }
 }
 //version: 2.18.3
@@ -0,0 +1,367 @@
+// dzn-runtime -- Dezyne runtime library
+//
+// This file is part of dzn-runtime.
+//
+// All rights reserved.
+//
+//
+// Commentary:
+//
+// A timer due at tick E is kept at the lowest level whose 64 slots
+// reach E from the current tick, in slot (E >> 6 * level) % 64.  When
+// the current tick crosses a slot boundary of a higher level, that
+// slot is cascaded: its timers are placed again, now at a lower level.
+// Level 0 slots are drained as their tick comes.  A timer's tick is
+// its deadline rounded up to the millisecond, so a timer never fires
+// early.
+//
+// Code:
+
+#include <dzn/timer-wheel.hh>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace dzn
+{
+static const std::int64_t nanoseconds_per_tick = 1000000;
+
+static unsigned
+lowest_bit (std::uint64_t map)
+{
+#if defined (__GNUC__)
+  return __builtin_ctzll (map);
+#else
+  unsigned bit = 0;
+  while (!(map & 1))
+    {
+      map >>= 1;
+      ++bit;
+    }
+  return bit;
+#endif
+}
+
+timer_wheel::timer_wheel ()
+  : start (clock::now ())
+  , current (0)
+  , armed (0)
+  , wheeled (0)
+  , nodes ()
+  , vacant (nil)
+  , occupied ()
+  , index ()
+  , due ()
+{
+  for (auto &l : lists)
+    l.head = l.tail = nil;
+}
+
+void
+timer_wheel::arm (size_t identifier, clock::time_point now, size_t milliseconds,
+                  dzn::task<void ()> &&event)
+{
+  assert (event);
+  assert (find (identifier) == nil);
+  if (!wheeled && lists[ready_list].head == nil)
+    current = std::max<std::int64_t> (since_start (now), 0) / nanoseconds_per_tick;
+  std::uint32_t n = allocate ();
+  node &t = nodes[n];
+  t.event = std::move (event);
+  t.id = identifier;
+  t.time = since_start (now) + std::int64_t (milliseconds) * nanoseconds_per_tick;
+  insert (n);
+  ++armed;
+  if (expiry (n) <= current)
+    link (ready_list, n);
+  else
+    place (n);
+}
+
+bool
+timer_wheel::cancel (size_t identifier)
+{
+  std::uint32_t n = find (identifier);
+  if (n == nil)
+    return false;
+  unlink (n);
+  erase (identifier);
+  release (n);
+  --armed;
+  return true;
+}
+
+void
+timer_wheel::advance (clock::time_point now)
+{
+  std::uint64_t target = std::max<std::int64_t> (since_start (now), 0) / nanoseconds_per_tick;
+  while (current < target)
+    {
+      if (!wheeled)
+        {
+          current = target;
+          break;
+        }
+      // nothing happens before the next boundary of the lowest
+      // occupied level
+      size_t level = 0;
+      while (!occupied[level])
+        ++level;
+      std::uint64_t step = std::uint64_t (1) << (bits * level);
+      std::uint64_t tick = (current | (step - 1)) + 1;
+      if (tick > target)
+        {
+          current = target;
+          break;
+        }
+      current = tick;
+      for (size_t l = levels - 1; l > 0; --l)
+        if (!(current & ((std::uint64_t (1) << (bits * l)) - 1)))
+          cascade (l, (current >> (bits * l)) & (slots - 1));
+      drain (current & (slots - 1));
+    }
+}
+
+bool
+timer_wheel::pop (clock::time_point now, dzn::task<void ()> &event)
+{
+  std::uint32_t n = lists[ready_list].head;
+  if (n == nil || nodes[n].time > since_start (now))
+    return false;
+  event = std::move (nodes[n].event);
+  unlink (n);
+  erase (nodes[n].id);
+  release (n);
+  --armed;
+  return true;
+}
+
+bool
+timer_wheel::expired (clock::time_point now)
+{
+  advance (now);
+  std::uint32_t n = lists[ready_list].head;
+  return n != nil && nodes[n].time <= since_start (now);
+}
+
+timer_wheel::clock::time_point
+timer_wheel::next () const
+{
+  std::uint32_t n = lists[ready_list].head;
+  if (n != nil)
+    return start + std::chrono::nanoseconds (nodes[n].time);
+  std::uint64_t best = std::numeric_limits<std::uint64_t>::max ();
+  for (size_t level = 0; level < levels; ++level)
+    if (occupied[level])
+      {
+        // the first occupied slot after the current one, counting the
+        // current slot as the 64th
+        size_t shift = bits * level;
+        std::uint64_t base = current >> shift;
+        unsigned r = (base + 1) & (slots - 1);
+        std::uint64_t map = occupied[level];
+        std::uint64_t rotated = r ? (map >> r) | (map << (slots - r)) : map;
+        std::uint64_t tick = (base + 1 + lowest_bit (rotated)) << shift;
+        best = std::min (best, tick);
+      }
+  if (best == std::numeric_limits<std::uint64_t>::max ())
+    return clock::time_point::max ();
+  return start + std::chrono::milliseconds (best);
+}
+
+std::int64_t
+timer_wheel::since_start (clock::time_point time) const
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds> (time - start).count ();
+}
+
+std::uint64_t
+timer_wheel::expiry (std::uint32_t n) const
+{
+  std::int64_t time = nodes[n].time;
+  return time <= 0 ? 0 : (time + nanoseconds_per_tick - 1) / nanoseconds_per_tick;
+}
+
+void
+timer_wheel::place (std::uint32_t n)
+{
+  std::uint64_t tick = expiry (n);
+  assert (tick > current);
+  std::uint64_t delta = tick - current;
+  size_t level = 0;
+  while (level + 1 < levels && delta >> (bits * (level + 1)))
+    ++level;
+  if (delta >> (bits * levels))
+    tick = current + (std::uint64_t (1) << (bits * levels)) - 1;
+  link (level * slots + ((tick >> (bits * level)) & (slots - 1)), n);
+}
+
+void
+timer_wheel::link (std::uint16_t l, std::uint32_t n)
+{
+  node &t = nodes[n];
+  t.list = l;
+  t.next = nil;
+  t.prev = lists[l].tail;
+  if (t.prev != nil)
+    nodes[t.prev].next = n;
+  else
+    lists[l].head = n;
+  lists[l].tail = n;
+  if (l != ready_list)
+    {
+      occupied[l / slots] |= std::uint64_t (1) << (l % slots);
+      ++wheeled;
+    }
+}
+
+void
+timer_wheel::unlink (std::uint32_t n)
+{
+  node &t = nodes[n];
+  std::uint16_t l = t.list;
+  if (t.prev != nil)
+    nodes[t.prev].next = t.next;
+  else
+    lists[l].head = t.next;
+  if (t.next != nil)
+    nodes[t.next].prev = t.prev;
+  else
+    lists[l].tail = t.prev;
+  if (l != ready_list)
+    {
+      if (lists[l].head == nil)
+        occupied[l / slots] &= ~(std::uint64_t (1) << (l % slots));
+      --wheeled;
+    }
+}
+
+void
+timer_wheel::cascade (size_t level, size_t slot)
+{
+  size_t l = level * slots + slot;
+  std::uint32_t n = lists[l].head;
+  lists[l].head = lists[l].tail = nil;
+  occupied[level] &= ~(std::uint64_t (1) << slot);
+  while (n != nil)
+    {
+      std::uint32_t next = nodes[n].next;
+      --wheeled;
+      if (expiry (n) <= current)
+        due.push_back (n);
+      else
+        place (n);
+      n = next;
+    }
+}
+
+void
+timer_wheel::drain (size_t slot)
+{
+  std::uint32_t n = lists[slot].head;
+  lists[slot].head = lists[slot].tail = nil;
+  occupied[0] &= ~(std::uint64_t (1) << slot);
+  while (n != nil)
+    {
+      --wheeled;
+      due.push_back (n);
+      n = nodes[n].next;
+    }
+  // timers due at the same tick fire in deadline order
+  std::sort (due.begin (), due.end (), [this] (std::uint32_t a, std::uint32_t b)
+  {
+    return nodes[a].time < nodes[b].time
+      || (nodes[a].time == nodes[b].time && nodes[a].id < nodes[b].id);
+  });
+  for (auto n : due)
+    link (ready_list, n);
+  due.clear ();
+}
+
+std::uint32_t
+timer_wheel::allocate ()
+{
+  if (vacant == nil)
+    {
+      nodes.emplace_back ();
+      return nodes.size () - 1;
+    }
+  std::uint32_t n = vacant;
+  vacant = nodes[n].next;
+  return n;
+}
+
+void
+timer_wheel::release (std::uint32_t n)
+{
+  nodes[n].event = nullptr;
+  nodes[n].next = vacant;
+  vacant = n;
+}
+
+size_t
+timer_wheel::hash (size_t identifier) const
+{
+  std::uint64_t h = std::uint64_t (identifier) * 0x9e3779b97f4a7c15ull;
+  return (h ^ (h >> 32)) & (index.size () - 1);
+}
+
+std::uint32_t
+timer_wheel::find (size_t identifier) const
+{
+  if (index.empty ())
+    return nil;
+  for (size_t i = hash (identifier); index[i] != nil; i = (i + 1) & (index.size () - 1))
+    if (nodes[index[i]].id == identifier)
+      return index[i];
+  return nil;
+}
+
+void
+timer_wheel::insert (std::uint32_t n)
+{
+  if (2 * (armed + 1) > index.size ())
+    grow ();
+  size_t i = hash (nodes[n].id);
+  while (index[i] != nil)
+    i = (i + 1) & (index.size () - 1);
+  index[i] = n;
+}
+
+void
+timer_wheel::erase (size_t identifier)
+{
+  size_t mask = index.size () - 1;
+  size_t i = hash (identifier);
+  while (nodes[index[i]].id != identifier)
+    i = (i + 1) & mask;
+  // shift the rest of the probe run back, so that lookups need no
+  // tombstones
+  for (size_t j = (i + 1) & mask; index[j] != nil; j = (j + 1) & mask)
+    {
+      size_t k = hash (nodes[index[j]].id);
+      if (i <= j ? i < k && k <= j : i < k || k <= j)
+        continue;
+      index[i] = index[j];
+      i = j;
+    }
+  index[i] = nil;
+}
+
+void
+timer_wheel::grow ()
+{
+  std::vector<std::uint32_t> old (std::max<size_t> (16, 2 * index.size ()), nil);
+  old.swap (index);
+  for (auto n : old)
+    if (n != nil)
+      {
+        size_t i = hash (nodes[n].id);
+        while (index[i] != nil)
+          i = (i + 1) & (index.size () - 1);
+        index[i] = n;
+      }
+}
+}
+//version: 2.18.3
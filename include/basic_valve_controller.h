@@ -0,0 +1,148 @@
+#pragma once  // 防止头文件重复包含
+#include "valve_types.h"       // 包含基本类型定义
+#include "valve_controller.h"  // 包含控制器接口定义
+#include <cstdint>             // 定宽整数类型
+#include <utility>             // forward支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+/**
+ * 静态组合的驱动层
+ * 直接持有具体的硬件抽象层，命令和完成通知都是普通的模板调用，可被内联
+ * HAL需要提供：
+ *   bool setParameters(const ValveParameters&);
+ *   template <typename Done> bool moveTo(ValveMove, Done&& done);  完成时调用done(status)
+ *   ValveStatus getStatus() const;
+ * 异步完成的HAL需要自行保存done的副本
+ * @tparam HAL 具体的硬件抽象层类型
+ */
+template <typename HAL>
+class BasicValveDriver {
+public:
+    using Hal = HAL;
+
+    /**
+     * 构造函数
+     * @param args 硬件抽象层的构造参数
+     */
+    template <typename... Args>
+    explicit BasicValveDriver(Args&&... args) : hal_(std::forward<Args>(args)...) {}
+
+    bool setup(const ValveParameters& params) { return hal_.setParameters(params); }
+    ValveStatus getStatus() const { return hal_.getStatus(); }
+    HAL& hal() { return hal_; }
+
+    /**
+     * 打开阀门
+     * @param sink 状态接收方，需提供onDriverStatus(ValveStatus)
+     */
+    template <typename Sink>
+    void open(Sink& sink) { startMove(ValveMove::OPEN, sink); }
+
+    /**
+     * 关闭阀门
+     * @param sink 状态接收方，需提供onDriverStatus(ValveStatus)
+     */
+    template <typename Sink>
+    void close(Sink& sink) { startMove(ValveMove::CLOSE, sink); }
+
+private:
+    /**
+     * 发送移动命令
+     * 与ValveDriver相同：先通知移动中状态，硬件拒绝命令时通知错误状态
+     */
+    template <typename Sink>
+    void startMove(ValveMove target, Sink& sink) {
+        sink.onDriverStatus(ValveStatus::MOVING);
+        if (!hal_.moveTo(target, [&sink](ValveStatus status) { sink.onDriverStatus(status); })) {
+            sink.onDriverStatus(ValveStatus::ERROR);  // 硬件拒绝命令
+        }
+    }
+
+    HAL hal_;  // 硬件抽象层
+};
+
+/**
+ * 静态组合的阀门控制器
+ * 与ValveController的状态规则相同，但驱动层和硬件抽象层在编译期确定，
+ * open() → 驱动层 → 硬件 → 完成通知整条链没有虚调用；
+ * 仍实现IValveController，可在需要运行时替换的地方按接口使用
+ * 只包含基本控制路径，联锁、日志等舰队功能使用ValveController
+ * 对象可移动，可直接存放在std::vector中
+ * @tparam Driver 驱动层类型，通常为BasicValveDriver<HAL>
+ */
+template <typename Driver>
+class BasicValveController final : public IValveController {
+public:
+    /**
+     * 构造函数
+     * @param args 驱动层的构造参数
+     */
+    template <typename... Args>
+    explicit BasicValveController(Args&&... args) : driver_(std::forward<Args>(args)...) {}
+
+    bool setup(const ValveParameters& params) override {
+        if (validateParameters(params) != ParameterError::NONE) {
+            return false;  // 无效参数不下发
+        }
+        return driver_.setup(params);
+    }
+
+    void open() override {
+        ++commandSeq_;                   // 记录命令序号
+        inflight_ = ValveCommand::OPEN;  // 记录未完成命令
+        driver_.open(*this);
+    }
+
+    void close() override {
+        ++commandSeq_;                    // 记录命令序号
+        inflight_ = ValveCommand::CLOSE;  // 记录未完成命令
+        driver_.close(*this);
+    }
+
+    bool isOpen() const override { return status_ == ValveStatus::OPENED; }
+    bool isClosed() const override { return status_ == ValveStatus::CLOSED; }
+
+    void setStatusCallback(StatusCallback callback) override { statusCallback_ = std::move(callback); }
+
+    /**
+     * 接收驱动层的状态变化
+     * 由驱动层调用，更新状态后通知客户端
+     * @param status 新的阀门状态
+     */
+    void onDriverStatus(ValveStatus status) {
+        status_ = status;
+        if (status == ValveStatus::OPENED || status == ValveStatus::CLOSED) {
+            lastConfirmed_ = status;
+            inflight_ = ValveCommand::NONE;
+        } else if (status == ValveStatus::ERROR) {
+            inflight_ = ValveCommand::NONE;
+        }
+        if (statusCallback_) {
+            statusCallback_(status);  // 通知客户端
+        }
+    }
+
+    ValveStatus status() const { return status_; }
+    ValveStatus lastConfirmed() const { return lastConfirmed_; }
+    ValveCommand inflight() const { return inflight_; }
+    std::uint32_t commandSequence() const { return commandSeq_; }
+    Driver& driver() { return driver_; }
+
+private:
+    Driver driver_;                                     // 驱动层
+    StatusCallback statusCallback_;                     // 状态变化回调函数
+    ValveStatus status_ = ValveStatus::UNKNOWN;         // 最近一次的状态
+    ValveStatus lastConfirmed_ = ValveStatus::UNKNOWN;  // 最后确认的终点状态
+    ValveCommand inflight_ = ValveCommand::NONE;        // 未完成的命令
+    std::uint32_t commandSeq_ = 0;                      // 已下发命令的序号
+};
+
+/**
+ * 按硬件抽象层类型组合的静态控制器
+ * 例如StaticValveController<BusChannel>
+ */
+template <typename HAL>
+using StaticValveController = BasicValveController<BasicValveDriver<HAL>>;
+
+} // namespace valve
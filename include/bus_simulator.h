@@ -0,0 +1,100 @@
+#pragma once  // 防止头文件重复包含
+#include "valve_hal.h"  // 包含硬件抽象层接口
+#include <atomic>       // 原子变量支持
+#include <memory>       // 智能指针支持
+#include <vector>       // 动态数组支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+class BusSimulator;  // 总线网关模拟器
+
+/**
+ * 总线网关的单通道硬件抽象层
+ * 只保存网关指针、通道编号和完成回调，状态和参数都存放在网关中，
+ * 可直接嵌入对象区中的阀门单元
+ */
+class BusChannel final : public IValveHAL {
+public:
+    /**
+     * 构造函数
+     * @param bus 所属网关，生命周期必须长于通道
+     * @param index 通道编号
+     */
+    BusChannel(BusSimulator& bus, std::size_t index) : bus_(&bus), index_(index) {}
+
+    bool setParameters(const ValveParameters& params) override;
+    bool move(ValveMove target) override;
+    ValveStatus getStatus() const override;
+    bool setCompletionCallback(CompletionCallback callback) override;
+
+    /**
+     * 供静态组合使用的移动接口
+     * 立即到达终点并直接调用done，调用链可被完整内联
+     * @param target 移动目标(打开/关闭)
+     * @param done 完成时以最终状态调用
+     * @return 操作是否成功启动
+     */
+    template <typename Done>
+    bool moveTo(ValveMove target, Done&& done);
+
+private:
+    BusSimulator* bus_;            // 所属网关
+    std::size_t index_;            // 通道编号
+    CompletionCallback callback_;  // 动作完成回调函数
+};
+
+/**
+ * 总线网关模拟器
+ * 模拟挂载大量阀门通道的现场总线网关：既提供批量接口，
+ * 也可为每个通道创建单阀门硬件抽象层；通道移动立即完成并同步通知
+ * 不同通道可在不同线程中并发访问
+ */
+class BusSimulator : public IBulkValveHAL {
+public:
+    /**
+     * 构造函数
+     * @param channels 通道数量
+     */
+    explicit BusSimulator(std::size_t channels);
+    ~BusSimulator() override;
+
+    BusSimulator(const BusSimulator&) = delete;
+    BusSimulator& operator=(const BusSimulator&) = delete;
+
+    std::size_t channelCount() const override { return status_.size(); }
+    void readStatus(std::size_t first, std::size_t count, ValveStatus* out) const override;
+    bool setParameters(std::size_t first, std::size_t count, const ValveParameters* params) override;
+
+    /**
+     * 创建单个通道的硬件抽象层
+     * 返回的对象引用本网关，必须先于网关销毁
+     * @param index 通道编号
+     * @return 通道硬件抽象层
+     */
+    std::unique_ptr<IValveHAL> channel(std::size_t index);
+
+    /**
+     * 获取参数写入事务数
+     * 批量写入计一次，单通道写入每次计一次
+     */
+    std::uint64_t parameterTransactions() const { return parameterTransactions_.load(); }
+
+    const ValveParameters& parameters(std::size_t index) const { return params_[index]; }
+
+private:
+    friend class BusChannel;
+
+    std::vector<ValveStatus> status_;                   // 各通道状态
+    std::vector<ValveParameters> params_;               // 各通道参数
+    std::atomic<std::uint64_t> parameterTransactions_{0};  // 参数写入事务数
+};
+
+template <typename Done>
+bool BusChannel::moveTo(ValveMove target, Done&& done) {
+    ValveStatus status = (target == ValveMove::OPEN) ? ValveStatus::OPENED : ValveStatus::CLOSED;
+    bus_->status_[index_] = status;
+    done(status);  // 立即完成
+    return true;
+}
+
+} // namespace valve
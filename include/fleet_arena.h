@@ -0,0 +1,83 @@
+#pragma once  // 防止头文件重复包含
+#include "object_arena.h"      // 包含定长对象区定义
+#include "valve_controller.h"  // 包含控制器接口定义
+#include "valve_driver.h"      // 包含驱动层定义
+#include <memory>              // 智能指针支持
+#include <utility>             // forward支持
+#include <vector>              // 动态数组支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+/**
+ * 阀门单元
+ * 硬件抽象层、驱动层和控制器按调用顺序相邻存放在同一块内存中，
+ * 一次命令访问的数据集中在相邻的缓存行
+ * @tparam HAL 具体的硬件抽象层类型
+ */
+template <typename HAL>
+struct ValveCell {
+    template <typename... Args>
+    explicit ValveCell(Args&&... args)
+        : hal(std::forward<Args>(args)...), driver(hal), controller(driver) {}
+
+    ValveCell(const ValveCell&) = delete;
+    ValveCell& operator=(const ValveCell&) = delete;
+
+    HAL hal;                    // 硬件抽象层
+    ValveDriver driver;         // 驱动层，引用hal
+    ValveController controller; // 控制器，引用driver
+};
+
+/**
+ * 舰队对象区
+ * 按分片预分配阀门单元，每个分片是一块连续内存，可由负责该分片的线程首次访问；
+ * 全局索引index对应第index / shardSize个分片中的第index % shardSize个单元
+ * 销毁时每个分片整体释放
+ * @tparam HAL 具体的硬件抽象层类型
+ */
+template <typename HAL>
+class FleetArena {
+public:
+    /**
+     * 构造函数
+     * @param count 阀门数量
+     * @param shards 分片数量
+     */
+    FleetArena(std::size_t count, std::size_t shards)
+        : count_(count), shardSize_(shards == 0 ? count : (count + shards - 1) / shards) {
+        if (shardSize_ == 0) {
+            shardSize_ = 1;
+        }
+        for (std::size_t first = 0; first < count_; first += shardSize_) {
+            std::size_t size = count_ - first < shardSize_ ? count_ - first : shardSize_;
+            shards_.push_back(std::make_unique<ObjectArena<ValveCell<HAL>>>(size));
+        }
+    }
+
+    /**
+     * 在指定索引处构造阀门单元
+     * 不同索引可在不同线程中并发构造
+     * @param index 全局索引
+     * @param args 硬件抽象层的构造参数
+     * @return 该单元的控制器
+     */
+    template <typename... Args>
+    ValveController* emplace(std::size_t index, Args&&... args) {
+        return &shards_[index / shardSize_]->construct(index % shardSize_, std::forward<Args>(args)...)->controller;
+    }
+
+    ValveCell<HAL>* cell(std::size_t index) { return shards_[index / shardSize_]->get(index % shardSize_); }
+    ValveController* controller(std::size_t index) { return &cell(index)->controller; }
+
+    std::size_t size() const { return count_; }
+    std::size_t shardCount() const { return shards_.size(); }
+    std::size_t shardSize() const { return shardSize_; }
+    std::size_t shardOf(std::size_t index) const { return index / shardSize_; }
+
+private:
+    std::size_t count_;      // 阀门数量
+    std::size_t shardSize_;  // 每个分片的单元数
+    std::vector<std::unique_ptr<ObjectArena<ValveCell<HAL>>>> shards_;  // 各分片的对象区
+};
+
+} // namespace valve
@@ -0,0 +1,151 @@
+#pragma once  // 防止头文件重复包含
+#include "valve_types.h"       // 包含基本类型定义
+#include "valve_controller.h"  // 包含控制器接口定义
+#include "valve_hal.h"         // 包含硬件抽象层接口
+#include "object_arena.h"      // 包含定长对象区定义
+#include <cstdint>             // 定宽整数类型
+#include <functional>          // 函数对象支持
+#include <memory>              // 智能指针支持
+#include <string>              // 字符串支持
+#include <vector>              // 动态数组支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+/**
+ * 舰队描述中的一个阀门
+ */
+struct FleetEntry {
+    std::uint16_t zone;         // 所属区域编号
+    ValveParameters params;     // 阀门参数
+    std::uint32_t channel = 0;  // 通道编号：数据行或记录在文件中的序号，被拒绝的行也占用编号
+};
+
+/**
+ * 二进制舰队描述文件头
+ * 文件布局：文件头 + count条FleetBinaryRecord
+ */
+struct FleetBinaryHeader {
+    std::uint32_t magic;    // 文件标识"VFLT"
+    std::uint32_t version;  // 格式版本
+    std::uint64_t count;    // 记录数
+};
+static_assert(sizeof(FleetBinaryHeader) == 16, "fleet header must stay 16 bytes");
+
+/**
+ * 二进制舰队描述记录
+ * 位置和速度为定点原始值
+ */
+struct FleetBinaryRecord {
+    std::uint16_t zone;         // 区域编号
+    std::uint16_t reserved;     // 保留，写为0
+    std::int32_t openPosition;  // 打开位置原始值
+    std::int32_t closePosition; // 关闭位置原始值
+    std::int32_t moveSpeed;     // 速度原始值
+};
+static_assert(sizeof(FleetBinaryRecord) == 16, "fleet record must stay 16 bytes");
+
+/**
+ * 加载计时报告
+ */
+struct LoadReport {
+    std::size_t valves = 0;     // 成功加载的阀门数
+    std::size_t rejected = 0;   // 格式错误或参数无效而跳过的数据行，及逐个下发参数失败的阀门
+    std::size_t profiles = 0;   // 去重后的参数配置数
+    unsigned threads = 0;       // 使用的线程数
+    bool binary = false;        // 是否为二进制格式
+    bool bulkConfigured = false;// 是否经批量接口下发参数
+    double mapMs = 0;           // 映射文件耗时
+    double parseMs = 0;         // 解析耗时
+    double constructMs = 0;     // 构造控制器耗时
+    double configureMs = 0;     // 下发参数耗时
+    double totalMs = 0;         // 总耗时
+
+    /**
+     * 生成可读的报告文本
+     */
+    std::string toString() const;
+};
+
+/**
+ * 加载完成的舰队
+ * 控制器原地构造在定长对象区中，fleet按描述文件顺序给出指针；
+ * 被拒绝的行不构造控制器，channels给出每个控制器对应的通道编号
+ */
+struct LoadedFleet {
+    explicit LoadedFleet(std::size_t count) : controllers(count) {}
+
+    ObjectArena<ValveController> controllers;           // 控制器对象区
+    std::vector<ValveController*> fleet;                // 按文件顺序的控制器
+    std::vector<std::uint16_t> zones;                   // 各阀门的区域编号
+    std::vector<std::uint32_t> channels;                // 各阀门的通道编号
+    std::vector<std::shared_ptr<const ValveProfile>> profiles;  // 去重后的参数配置
+};
+
+/**
+ * 舰队配置加载器
+ * 映射描述文件(CSV或二进制，按文件头自动识别)，按线程数切分并行解析，
+ * 在预分配的对象区中并行构造控制器，相同参数的阀门共享同一配置，
+ * 提供批量接口时以一次批量调用下发全部参数
+ * CSV每行为"zone,open,close,speed"，位置和速度可带小数，行首行尾允许空白；
+ * 空行、#开头的行和文件第一行的表头被忽略，其余每行都是一个数据行，
+ * 第i个数据行(从0计)对应通道i，格式错误或参数无效的行计入rejected并空出其通道，
+ * 后续阀门的通道编号不变；二进制文件中第i条记录对应通道i
+ * 仅POSIX平台使用mmap，其他平台读入内存
+ */
+class FleetLoader {
+public:
+    using HALFactory = std::function<std::unique_ptr<IValveHAL>(std::size_t index)>;
+    using Progress = std::function<void(const char* phase, std::size_t done, std::size_t total)>;
+
+    /**
+     * 构造函数
+     * @param threads 线程数，0表示使用硬件并发数
+     */
+    explicit FleetLoader(unsigned threads = 0);
+
+    /**
+     * 设置进度回调
+     * 在调用load的线程中于每个阶段结束时调用
+     */
+    void setProgress(Progress progress) { progress_ = std::move(progress); }
+
+    /**
+     * 解析描述文件
+     * @param path 文件路径
+     * @param out 输出有效的阀门描述，按文件顺序，channel为其通道编号
+     * @param report 填写解析相关的计时和计数
+     * @return 文件是否可读
+     */
+    bool parse(const std::string& path, std::vector<FleetEntry>& out, LoadReport& report) const;
+
+    /**
+     * 加载舰队
+     * @param path 文件路径
+     * @param halFactory 为通道index的阀门创建硬件抽象层，会在多个线程中并发调用
+     * @param bulk 批量硬件接口，可为nullptr；批量下发失败时退回逐个setup。
+     *             批量下发成功后参数不再经各阀门的硬件抽象层写入，因此halFactory(index)
+     *             必须返回该批量接口通道index的视图(如BusSimulator::channel)，与其共享参数
+     * @param report 输出计时报告
+     * @return 加载的舰队，文件不可读时返回nullptr
+     */
+    std::unique_ptr<LoadedFleet> load(const std::string& path, const HALFactory& halFactory,
+                                      IBulkValveHAL* bulk, LoadReport& report) const;
+
+    unsigned threads() const { return threads_; }
+
+private:
+    unsigned threads_;    // 线程数
+    Progress progress_;   // 进度回调
+};
+
+/**
+ * 写入二进制舰队描述文件
+ * 每个阀门写在其channel对应的记录位置，空出的通道写为全零(无效)记录，
+ * 重新加载时通道编号不变
+ * @param path 文件路径
+ * @param entries 阀门描述，channel必须严格递增
+ * @return 是否写入成功，channel不递增时返回false
+ */
+bool writeFleetBinary(const std::string& path, const std::vector<FleetEntry>& entries);
+
+} // namespace valve
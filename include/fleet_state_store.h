@@ -0,0 +1,217 @@
+#pragma once  // 防止头文件重复包含
+#include "valve_types.h"  // 包含基本类型定义
+#include <array>          // 定长数组支持
+#include <atomic>         // 原子变量支持
+#include <cstddef>        // size_t定义
+#include <cstdint>        // 定宽整数类型
+#include <memory>         // 智能指针支持
+#include <vector>         // 动态数组支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+/**
+ * 舰队状态存储(结构数组布局)
+ * 将所有阀门的状态、位置、目标和最后变化时间分别存放在连续数组中，
+ * 使仪表盘类的聚合查询只需顺序扫描几个紧凑数组，而不必逐个访问控制器对象
+ * 由各ValveController在命令和状态变化时同步更新
+ *
+ * 并发约定：每个阀门槽位只由其所属控制器写入，写入可能来自HAL完成线程；
+ * 各列元素为relaxed原子量，聚合查询不加锁，得到的是逐元素一致的近似快照，适用于周期性统计
+ * add()会扩容各列，只能在没有写入和查询并发进行时调用(例如启动时登记舰队)
+ */
+class FleetStateStore {
+public:
+    using Timestamp = std::int64_t;  // 单调时钟纳秒数
+
+    static constexpr std::size_t kStatusCount = 5;  // ValveStatus枚举值个数
+    using Histogram = std::array<std::size_t, kStatusCount>;  // 按状态计数的直方图
+
+    /**
+     * 聚合查询使用的指令集级别
+     * 默认在构造时按CPU能力自动选择，基准测试可强制指定
+     */
+    enum class SimdLevel {
+        SCALAR,  // 纯标量实现
+        SSE2,    // 128位SSE2实现
+        AVX2     // 256位AVX2实现
+    };
+
+    /**
+     * 构造函数
+     * @param capacity 预留的阀门数量，避免运行中扩容
+     */
+    explicit FleetStateStore(std::size_t capacity = 0);
+
+    /**
+     * 登记一个新阀门
+     * @param zone 阀门所属区域编号
+     * @return 阀门在存储中的槽位索引
+     */
+    std::uint32_t add(std::uint16_t zone);
+
+    /**
+     * 获取已登记的阀门数量
+     * @return 阀门数量
+     */
+    std::size_t size() const { return status_.size(); }
+
+    /**
+     * 更新阀门状态并记录变化时间
+     * @param index 槽位索引
+     * @param status 新状态
+     * @param now 状态变化时间
+     */
+    void setStatus(std::uint32_t index, ValveStatus status, Timestamp now) {
+        status_.store(index, static_cast<std::uint8_t>(status));  // 状态按字节紧凑存放
+        lastChange_.store(index, now);                             // 记录变化时间
+    }
+
+    /**
+     * 更新阀门当前位置
+     * @param index 槽位索引
+     * @param position 当前位置值
+     */
+    void setPosition(std::uint32_t index, std::int32_t position) { position_.store(index, position); }
+
+    /**
+     * 更新阀门目标位置
+     * @param index 槽位索引
+     * @param target 目标位置值
+     */
+    void setTarget(std::uint32_t index, std::int32_t target) { target_.store(index, target); }
+
+    ValveStatus status(std::uint32_t index) const { return static_cast<ValveStatus>(status_.load(index)); }
+    std::uint16_t zone(std::uint32_t index) const { return zone_[index]; }
+    std::int32_t position(std::uint32_t index) const { return position_.load(index); }
+    std::int32_t target(std::uint32_t index) const { return target_.load(index); }
+    Timestamp lastChange(std::uint32_t index) const { return lastChange_.load(index); }
+
+    /**
+     * 统计各状态的阀门数量
+     * @return 以ValveStatus数值为下标的计数数组
+     */
+    Histogram statusHistogram() const;
+
+    /**
+     * 统计指定区域内处于指定状态集合的阀门数量
+     * 例如：zone 7中MOVING或ERROR的阀门数
+     * @param zone 区域编号
+     * @param statusMask 状态位掩码，由statusBit()组合而成
+     * @return 满足条件的阀门数量
+     */
+    std::size_t countInZone(std::uint16_t zone, std::uint8_t statusMask) const;
+
+    /**
+     * 统计超过指定时长未发生状态变化的阀门数量
+     * @param now 当前时间
+     * @param maxAge 允许的最大静止时长(纳秒)
+     * @return 陈旧阀门数量
+     */
+    std::size_t countStale(Timestamp now, Timestamp maxAge) const;
+
+    /**
+     * 收集超过指定时长未发生状态变化的阀门
+     * @param now 当前时间
+     * @param maxAge 允许的最大静止时长(纳秒)
+     * @param out 输出槽位索引(追加写入)
+     * @return 本次找到的陈旧阀门数量
+     */
+    std::size_t collectStale(Timestamp now, Timestamp maxAge, std::vector<std::uint32_t>& out) const;
+
+    /**
+     * 导出全舰队状态位图
+     * 位图格式见valve_codec.h，用于遥测上报
+     * @param planes 输出位图，长度被设置为statusBitmapWords(size())
+     */
+    void exportStatusBitmap(std::vector<std::uint64_t>& planes) const;
+
+    /**
+     * 导出区域状态位图
+     * 位图中第i个阀门对应members中第i个槽位
+     * @param zone 区域编号
+     * @param members 输出区域内阀门的槽位索引(按槽位顺序)
+     * @param planes 输出位图
+     */
+    void exportZoneStatusBitmap(std::uint16_t zone, std::vector<std::uint32_t>& members,
+                                std::vector<std::uint64_t>& planes) const;
+
+    /**
+     * 设置聚合查询使用的指令集级别
+     * 请求的级别超出CPU能力时自动降级
+     * @param level 期望的指令集级别
+     */
+    void setSimdLevel(SimdLevel level);
+    SimdLevel simdLevel() const { return simdLevel_; }
+
+    /**
+     * 检测当前CPU支持的最高指令集级别
+     * @return 可用的指令集级别
+     */
+    static SimdLevel detectSimdLevel();
+
+    /**
+     * 将单个状态转换为状态位掩码
+     * @param status 阀门状态
+     * @return 对应的位掩码
+     */
+    static constexpr std::uint8_t statusBit(ValveStatus status) {
+        return static_cast<std::uint8_t>(1u << static_cast<unsigned>(status));
+    }
+
+    /**
+     * 获取当前单调时钟时间
+     * @return 纳秒时间戳
+     */
+    static Timestamp now();
+
+private:
+    /**
+     * 可并发读写的列
+     * 元素为无锁原子量，与普通数组布局相同，向量化查询可按数组整块读取
+     */
+    template <typename T>
+    class Column {
+    public:
+        static_assert(std::atomic<T>::is_always_lock_free && sizeof(std::atomic<T>) == sizeof(T),
+                      "column elements must be plain lock-free atomics");
+
+        std::size_t size() const { return size_; }
+
+        void reserve(std::size_t capacity) {
+            if (capacity <= capacity_) {
+                return;
+            }
+            std::unique_ptr<std::atomic<T>[]> grown(new std::atomic<T>[capacity]);
+            for (std::size_t i = 0; i < size_; ++i) {
+                grown[i].store(load(i), std::memory_order_relaxed);
+            }
+            data_ = std::move(grown);
+            capacity_ = capacity;
+        }
+
+        void push_back(T value) {
+            if (size_ == capacity_) {
+                reserve(capacity_ ? capacity_ * 2 : 64);
+            }
+            data_[size_++].store(value, std::memory_order_relaxed);
+        }
+
+        T load(std::size_t index) const { return data_[index].load(std::memory_order_relaxed); }
+        void store(std::size_t index, T value) { data_[index].store(value, std::memory_order_relaxed); }
+        const std::atomic<T>* data() const { return data_.get(); }
+
+    private:
+        std::unique_ptr<std::atomic<T>[]> data_;  // 元素存储
+        std::size_t size_ = 0;                    // 元素个数
+        std::size_t capacity_ = 0;                // 已分配的元素个数
+    };
+
+    Column<std::uint8_t> status_;            // 状态字节数组
+    std::vector<std::uint16_t> zone_;        // 区域编号数组，登记后不再改变
+    Column<std::int32_t> position_;          // 当前位置数组
+    Column<std::int32_t> target_;            // 目标位置数组
+    Column<Timestamp> lastChange_;           // 最后状态变化时间数组
+    SimdLevel simdLevel_;                    // 当前使用的指令集级别
+};
+
+} // namespace valve
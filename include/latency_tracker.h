@@ -0,0 +1,233 @@
+#pragma once  // 防止头文件重复包含
+#include "valve_types.h"  // 包含基本类型定义
+#include <array>          // 定长数组支持
+#include <atomic>         // 原子变量支持
+#include <chrono>         // 时间和计时支持
+#include <cstdint>        // 定宽整数类型
+#include <memory>         // 智能指针支持
+#include <mutex>          // 互斥锁支持
+#include <string>         // 字符串支持
+#include <vector>         // 动态数组支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+/**
+ * 一次移动的耗时阶段
+ */
+enum class LatencyPhase : std::uint8_t {
+    ACCEPT,      // 命令下发到硬件接受命令
+    COMPLETION,  // 硬件接受命令到动作完成
+    CALLBACK,    // 控制器收到完成到客户端回调返回，未设置客户端回调时为0
+    ERROR        // 以ERROR结束的移动：命令下发到报告ERROR，这类移动不计入前三个阶段
+};
+
+/**
+ * 对数线性直方图
+ * 小于64纳秒的值精确计数，更大的值按2的幂分段，每段32个子桶，相对误差不超过1/32；
+ * 超过2^45纳秒(约9.8小时)的值计入最后一个桶
+ * 只允许一个线程写入，其他线程可随时读取
+ */
+class LatencyHistogram {
+public:
+    static constexpr unsigned kSubBits = 5;                              // 每段子桶数的对数
+    static constexpr unsigned kSubBuckets = 1u << kSubBits;              // 每段子桶数
+    static constexpr unsigned kMaxExponent = 45;                         // 可区分的最大2的幂
+    static constexpr std::size_t kBuckets = (kMaxExponent - kSubBits + 1) * kSubBuckets + kSubBuckets;  // 桶数
+
+    /**
+     * 计算值所在的桶
+     * @param ns 耗时(纳秒)
+     * @return 桶编号
+     */
+    static std::size_t bucketOf(std::uint64_t ns) {
+        if (ns < 2 * kSubBuckets) {
+            return static_cast<std::size_t>(ns);  // 精确区间
+        }
+        unsigned exponent = 63u - static_cast<unsigned>(__builtin_clzll(ns));
+        if (exponent > kMaxExponent) {
+            return kBuckets - 1;
+        }
+        const unsigned shift = exponent - kSubBits;
+        return static_cast<std::size_t>(shift) * kSubBuckets + static_cast<std::size_t>(ns >> shift);
+    }
+
+    /**
+     * 桶的下界(纳秒)
+     */
+    static std::uint64_t lowerBound(std::size_t bucket) {
+        if (bucket < 2 * kSubBuckets) {
+            return bucket;
+        }
+        const unsigned shift = static_cast<unsigned>(bucket / kSubBuckets) - 1;
+        return static_cast<std::uint64_t>(bucket % kSubBuckets + kSubBuckets) << shift;
+    }
+
+    /**
+     * 桶的宽度(纳秒)
+     */
+    static std::uint64_t width(std::size_t bucket) {
+        return bucket < 2 * kSubBuckets ? 1 : std::uint64_t(1) << (bucket / kSubBuckets - 1);
+    }
+
+    /**
+     * 记录一个样本
+     * 单写者：计数用普通读改写而非原子加，开销只有几纳秒
+     * @param ns 耗时(纳秒)
+     */
+    void record(std::uint64_t ns) {
+        bump(buckets_[bucketOf(ns)], 1);
+        bump(count_, 1);
+        bump(sum_, ns);
+        if (ns > max_.load(std::memory_order_relaxed)) {
+            max_.store(ns, std::memory_order_relaxed);
+        }
+        if (ns < min_.load(std::memory_order_relaxed)) {
+            min_.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    friend struct LatencySnapshot;
+
+    static void bump(std::atomic<std::uint64_t>& counter, std::uint64_t delta) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<std::uint64_t>, kBuckets> buckets_{};  // 各桶计数
+    std::atomic<std::uint64_t> count_{0};                         // 样本数
+    std::atomic<std::uint64_t> sum_{0};                           // 样本总和
+    std::atomic<std::uint64_t> min_{UINT64_MAX};                  // 最小值
+    std::atomic<std::uint64_t> max_{0};                           // 最大值
+};
+
+/**
+ * 直方图快照
+ * 读取时由各线程的直方图合并而成
+ */
+struct LatencySnapshot {
+    std::vector<std::uint64_t> buckets = std::vector<std::uint64_t>(LatencyHistogram::kBuckets, 0);  // 各桶计数
+    std::uint64_t count = 0;         // 样本数
+    std::uint64_t sum = 0;           // 样本总和(纳秒)
+    std::uint64_t min = UINT64_MAX;  // 最小值(纳秒)
+    std::uint64_t max = 0;           // 最大值(纳秒)
+
+    /**
+     * 并入一个直方图的当前计数
+     */
+    void merge(const LatencyHistogram& histogram);
+
+    /**
+     * 并入另一个快照
+     */
+    void merge(const LatencySnapshot& other);
+
+    /**
+     * 分位数
+     * @param quantile 0到1之间的分位点
+     * @return 该分位所在桶的中点(纳秒)，不超过最大值；无样本时为0
+     */
+    std::uint64_t percentile(double quantile) const;
+
+    double mean() const { return count ? static_cast<double>(sum) / count : 0.0; }
+};
+
+/**
+ * 移动耗时统计
+ * 按阀门类别、命令方向和阶段分别统计；每个线程写自己的直方图，无锁无共享写入，
+ * 读取时合并所有线程的直方图。类别名称可自由组合，例如"motor/zone-3"
+ * 线程退出时其分片连同已记录的样本归还实例，由之后首次记录的线程复用，
+ * 每次移动都在新线程上完成时分片数也不超过同时记录的线程数
+ * 只在调用snapshot()或exportText()时读取，不主动推送
+ */
+class LatencyTracker {
+public:
+    static constexpr std::size_t kMaxClasses = 128;          // 最大类别数
+    static constexpr std::uint16_t kNoClass = 0xFFFF;        // 无效类别
+
+    LatencyTracker();
+    ~LatencyTracker();
+
+    LatencyTracker(const LatencyTracker&) = delete;
+    LatencyTracker& operator=(const LatencyTracker&) = delete;
+
+    /**
+     * 当前单调时钟时间(纳秒)
+     */
+    static std::int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * 定义类别
+     * 同名类别返回已有编号
+     * @param name 类别名称
+     * @return 类别编号，类别已满时为kNoClass
+     */
+    std::uint16_t defineClass(const std::string& name);
+
+    /**
+     * 查找类别
+     * @return 类别编号，不存在时为kNoClass
+     */
+    std::uint16_t findClass(const std::string& name) const;
+
+    std::size_t classCount() const;
+
+    /**
+     * 记录一个样本
+     * 首次记录某个组合时在本线程分配直方图，之后只写本线程的数据
+     * @param valveClass 类别编号
+     * @param command 命令方向(打开/关闭)
+     * @param phase 耗时阶段
+     * @param ns 耗时(纳秒)
+     */
+    void record(std::uint16_t valveClass, ValveCommand command, LatencyPhase phase, std::uint64_t ns);
+
+    /**
+     * 记录一次移动的三个阶段
+     * 与分别调用三次record()等价，只查找一次本线程分片
+     * @param valveClass 类别编号
+     * @param command 命令方向(打开/关闭)
+     * @param acceptNs 命令下发到硬件接受
+     * @param completionNs 硬件接受到完成
+     * @param callbackNs 收到完成到客户端回调返回
+     */
+    void recordMove(std::uint16_t valveClass, ValveCommand command, std::uint64_t acceptNs,
+                    std::uint64_t completionNs, std::uint64_t callbackNs);
+
+    /**
+     * 合并所有线程的数据
+     * @param valveClass 类别编号
+     * @param command 命令方向
+     * @param phase 耗时阶段
+     * @return 合并后的快照
+     */
+    LatencySnapshot snapshot(std::uint16_t valveClass, ValveCommand command, LatencyPhase phase) const;
+
+    /**
+     * 以文本格式导出全部有样本的组合
+     * 每行一个指标，包括样本数、平均值和p50/p90/p99/p999/最大值(纳秒)
+     */
+    std::string exportText() const;
+
+private:
+    struct Shard;
+    struct ShardPool;
+
+    static constexpr std::size_t kSlotsPerClass = 8;  // 2个命令方向 x 4个阶段
+
+    static std::size_t slotOf(std::uint16_t valveClass, ValveCommand command, LatencyPhase phase) {
+        return valveClass * kSlotsPerClass + (command == ValveCommand::CLOSE ? 4 : 0) + static_cast<std::size_t>(phase);
+    }
+
+    Shard& localShard();
+    static LatencyHistogram& histogramOf(Shard& shard, std::size_t slot);
+
+    const std::uint64_t id_;                     // 实例编号，区分线程缓存中的不同实例
+    mutable std::mutex mutex_;                   // 保护类别表
+    std::vector<std::string> classes_;           // 类别名称
+    std::shared_ptr<ShardPool> shards_;          // 各线程的分片，线程退出时经弱引用归还
+};
+
+} // namespace valve
@@ -0,0 +1,69 @@
+#pragma once  // 防止头文件重复包含
+#include <cstddef>  // size_t定义
+#include <cstdint>  // 定宽整数类型
+#include <memory>   // 智能指针支持
+#include <new>      // placement new
+#include <utility>  // forward支持
+#include <vector>   // 动态数组支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+/**
+ * 定长对象区
+ * 一次分配容纳capacity个对象的连续内存，对象在指定下标处原地构造，
+ * 地址在对象区生命周期内不变，析构时按下标逆序销毁已构造的对象
+ * 不同下标可在不同线程中并发构造
+ * @tparam T 对象类型
+ */
+template <typename T>
+class ObjectArena {
+public:
+    /**
+     * 构造函数
+     * @param capacity 对象数量上限
+     */
+    explicit ObjectArena(std::size_t capacity)
+        : storage_(new Slot[capacity]), constructed_(capacity, 0), capacity_(capacity) {}
+
+    ~ObjectArena() {
+        for (std::size_t i = capacity_; i-- > 0;) {
+            if (constructed_[i]) {
+                get(i)->~T();
+            }
+        }
+    }
+
+    ObjectArena(const ObjectArena&) = delete;
+    ObjectArena& operator=(const ObjectArena&) = delete;
+
+    /**
+     * 在指定下标处构造对象
+     * 每个下标只能构造一次
+     * @param index 下标
+     * @param args 构造参数
+     * @return 对象指针
+     */
+    template <typename... Args>
+    T* construct(std::size_t index, Args&&... args) {
+        T* object = new (&storage_[index]) T(std::forward<Args>(args)...);
+        constructed_[index] = 1;
+        return object;
+    }
+
+    T* get(std::size_t index) { return std::launder(reinterpret_cast<T*>(&storage_[index])); }
+    const T* get(std::size_t index) const { return std::launder(reinterpret_cast<const T*>(&storage_[index])); }
+
+    bool constructed(std::size_t index) const { return constructed_[index] != 0; }
+    std::size_t capacity() const { return capacity_; }
+
+private:
+    struct alignas(T) Slot {
+        unsigned char bytes[sizeof(T)];
+    };
+
+    std::unique_ptr<Slot[]> storage_;        // 对象存储
+    std::vector<std::uint8_t> constructed_;  // 各下标是否已构造
+    std::size_t capacity_;                   // 对象数量上限
+};
+
+} // namespace valve
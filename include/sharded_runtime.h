@@ -0,0 +1,173 @@
+#pragma once  // 防止头文件重复包含
+#include "valve_types.h"       // 包含基本类型定义
+#include <atomic>              // 原子变量支持
+#include <chrono>              // 时间和计时支持
+#include <condition_variable>  // 条件变量支持
+#include <cstdint>             // 定宽整数类型
+#include <deque>               // 双端队列支持
+#include <functional>          // 函数对象支持
+#include <memory>              // 智能指针支持
+#include <mutex>               // 互斥锁支持
+#include <thread>              // 线程支持
+#include <vector>              // 动态数组支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+class ValveController;  // 阀门控制器
+
+/**
+ * 阀门事件类型
+ */
+enum class ValveEventKind : std::uint8_t {
+    COMMAND,     // 开关命令
+    COMPLETION,  // 外部报告的动作完成
+    TIMER        // 定时器到期
+};
+
+/**
+ * 阀门事件
+ * 同一阀门的事件按提交顺序在同一时刻只由一个工作线程处理
+ */
+struct ValveEvent {
+    std::uint32_t valve;                           // 阀门编号
+    ValveEventKind kind;                           // 事件类型
+    ValveCommand command = ValveCommand::NONE;     // 命令事件的命令
+    ValveStatus status = ValveStatus::UNKNOWN;     // 完成事件的状态
+    std::uint64_t tag = 0;                         // 定时器事件的用户标记
+};
+
+/**
+ * 运行时配置
+ */
+struct RuntimeOptions {
+    std::size_t workers = 0;     // 工作线程数，0表示按硬件核数
+    std::size_t shards = 0;      // 分片数，0表示每个工作线程16个分片
+    bool pinWorkers = true;      // 是否把工作线程绑定到核心
+};
+
+/**
+ * 运行时统计
+ */
+struct RuntimeStats {
+    std::vector<std::uint64_t> processed;  // 各工作线程处理的事件数
+    std::uint64_t batches = 0;             // 分片批处理次数
+    std::uint64_t steals = 0;              // 从其他工作线程窃取的分片数
+    std::uint64_t timers = 0;              // 已到期的定时器数
+};
+
+/**
+ * 分片控制器运行时
+ * 舰队按阀门编号切成连续分片，分片轮流归属各工作线程(分片s属于线程s % workers)，
+ * 热点区域的相邻分片因此落在不同线程上；每个分片有自己的事件队列，
+ * 工作线程只从本地就绪队列取分片，空闲时从其他线程窃取整个分片。
+ * 一个分片在同一时刻只在一个就绪队列中或只被一个线程处理，
+ * 因此同一阀门的命令、完成和定时器事件严格按提交顺序执行，控制器无需加锁
+ */
+class ShardedRuntime {
+public:
+    using EventHandler = std::function<void(const ValveEvent&)>;
+
+    /**
+     * 构造函数
+     * @param fleet 按阀门编号排列的控制器，空指针的阀门只触发事件处理函数
+     * @param options 运行时配置
+     */
+    explicit ShardedRuntime(std::vector<ValveController*> fleet, const RuntimeOptions& options = RuntimeOptions());
+    ~ShardedRuntime();
+
+    ShardedRuntime(const ShardedRuntime&) = delete;
+    ShardedRuntime& operator=(const ShardedRuntime&) = delete;
+
+    /**
+     * 设置事件处理函数
+     * 在工作线程中、运行时自身处理之后调用，须在start()之前设置
+     * @param handler 事件处理函数
+     */
+    void setEventHandler(EventHandler handler) { handler_ = std::move(handler); }
+
+    /**
+     * 启动工作线程
+     * 启动前提交的事件在启动后处理
+     */
+    void start();
+
+    /**
+     * 处理完已提交的事件后停止工作线程
+     * 调用前生产者应停止提交，未到期的定时器被丢弃
+     */
+    void stop();
+
+    /**
+     * 提交开关命令
+     * @param valve 阀门编号
+     * @param command 打开或关闭
+     * @return 是否已入队
+     */
+    bool command(std::uint32_t valve, ValveCommand command);
+
+    /**
+     * 提交外部检测到的动作完成
+     * 在工作线程中以reconcile()应用到控制器
+     * @param valve 阀门编号
+     * @param status 硬件状态
+     * @return 是否已入队
+     */
+    bool complete(std::uint32_t valve, ValveStatus status);
+
+    /**
+     * 设置定时器
+     * 到期后作为该阀门的TIMER事件进入其分片队列
+     * @param valve 阀门编号
+     * @param delay 延迟时间
+     * @param tag 用户标记，原样带回
+     * @return 是否已设置
+     */
+    bool scheduleTimer(std::uint32_t valve, std::chrono::nanoseconds delay, std::uint64_t tag);
+
+    /**
+     * 等待已提交的事件全部处理完
+     * 须在start()之后调用，不等待未到期的定时器
+     */
+    void drain();
+
+    std::size_t workerCount() const { return workerCount_; }
+    std::size_t shardCount() const { return shardCount_; }
+    std::size_t shardOf(std::uint32_t valve) const { return valve / shardSize_; }
+
+    /**
+     * 获取运行时统计
+     */
+    RuntimeStats stats() const;
+
+private:
+    struct Shard;
+    struct Worker;
+
+    bool post(const ValveEvent& event);
+    void schedule(std::size_t shard);
+    void wakeIdle(std::size_t except);
+    void run(std::size_t worker);
+    bool takeLocal(Worker& worker, std::size_t& shard);
+    bool steal(std::size_t thief, std::size_t& shard);
+    void runShard(Worker& worker, std::size_t shard);
+    void fireTimers(Worker& worker);
+    void dispatch(const ValveEvent& event);
+
+    std::vector<ValveController*> fleet_;    // 按编号排列的控制器
+    std::size_t workerCount_;                // 工作线程数
+    std::size_t shardCount_;                 // 分片数
+    std::size_t shardSize_;                  // 每个分片的阀门数
+    bool pinWorkers_;                        // 是否绑定核心
+    std::unique_ptr<Shard[]> shards_;        // 各分片
+    std::unique_ptr<Worker[]> workers_;      // 各工作线程
+    EventHandler handler_;                   // 用户事件处理函数
+
+    std::atomic<bool> running_{false};       // 是否已启动
+    std::atomic<bool> stopping_{false};      // 是否正在停止
+    std::atomic<int> idleWorkers_{0};        // 正在休眠的工作线程数
+    std::atomic<std::uint64_t> pending_{0};  // 已提交未处理的事件数
+    std::mutex drainMutex_;                  // 保护drained_等待
+    std::condition_variable drained_;        // 事件全部处理完时通知
+};
+
+} // namespace valve
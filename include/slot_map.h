@@ -0,0 +1,124 @@
+#pragma once  // 防止头文件重复包含
+#include "valve_types.h"  // 包含ValveId定义
+#include <cstdint>        // 定宽整数类型
+#include <limits>         // 数值极限
+#include <utility>        // move支持
+#include <vector>         // 动态数组支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+/**
+ * 带代数的槽位表
+ * 以ValveId为键，查找为一次下标访问加一次代数比较；
+ * 删除后槽位进入空闲栈优先复用，索引始终不超过历史最大存活数，
+ * 可直接用作SoA数组和批量硬件接口的下标
+ * 槽位代数为奇数表示占用，偶数表示空闲；代数耗尽的槽位不再复用
+ * 非线程安全，并发访问由调用方同步
+ */
+template <typename T>
+class SlotMap {
+public:
+    /**
+     * 预留槽位
+     * @param count 预计的阀门数量
+     */
+    void reserve(std::size_t count) {
+        values_.reserve(count);
+        generations_.reserve(count);
+    }
+
+    /**
+     * 插入元素
+     * @param value 元素
+     * @return 新元素的标识
+     */
+    ValveId insert(T value) {
+        std::uint32_t index;
+        if (!freeList_.empty()) {
+            index = freeList_.back();  // 复用最近释放的槽位
+            freeList_.pop_back();
+            values_[index] = std::move(value);
+        } else {
+            index = static_cast<std::uint32_t>(values_.size());
+            values_.push_back(std::move(value));
+            generations_.push_back(0);
+        }
+        ++generations_[index];  // 偶数变奇数，标记占用
+        ++size_;
+        return ValveId{index, generations_[index]};
+    }
+
+    /**
+     * 删除元素
+     * 元素被替换为默认值以释放其资源，该槽位上的旧标识全部失效
+     * @param id 元素标识
+     * @return 标识是否有效
+     */
+    bool erase(ValveId id) {
+        if (!contains(id)) {
+            return false;  // 已失效的标识
+        }
+        values_[id.index] = T();
+        if (generations_[id.index] == std::numeric_limits<std::uint32_t>::max()) {
+            generations_[id.index] = 0;  // 代数耗尽，槽位退役
+        } else {
+            ++generations_[id.index];  // 奇数变偶数，标记空闲
+            freeList_.push_back(id.index);
+        }
+        --size_;
+        return true;
+    }
+
+    /**
+     * 判断标识是否有效
+     * 只有奇数代数是占用标识：空闲槽位的偶数代数和退役槽位的0都不匹配任何标识
+     */
+    bool contains(ValveId id) const {
+        return (id.generation & 1u) != 0 && id.index < generations_.size() &&
+               generations_[id.index] == id.generation;
+    }
+
+    /**
+     * 按标识查找
+     * @param id 元素标识
+     * @return 元素指针，标识失效时返回nullptr
+     */
+    T* find(ValveId id) { return contains(id) ? &values_[id.index] : nullptr; }
+    const T* find(ValveId id) const { return contains(id) ? &values_[id.index] : nullptr; }
+
+    /**
+     * 获取槽位上当前的标识
+     * @param index 槽位索引
+     * @return 当前标识，槽位空闲时返回无效标识
+     */
+    ValveId idAt(std::uint32_t index) const {
+        if (index >= generations_.size() || (generations_[index] & 1u) == 0) {
+            return ValveId();
+        }
+        return ValveId{index, generations_[index]};
+    }
+
+    /**
+     * 按槽位顺序遍历所有有效元素
+     * @param visitor 访问函数，参数为(ValveId, T&)
+     */
+    template <typename Visitor>
+    void forEach(Visitor&& visitor) {
+        for (std::uint32_t i = 0; i < generations_.size(); ++i) {
+            if (generations_[i] & 1u) {
+                visitor(ValveId{i, generations_[i]}, values_[i]);
+            }
+        }
+    }
+
+    std::size_t size() const { return size_; }                     // 有效元素数
+    std::size_t slotCount() const { return generations_.size(); }  // 槽位数，即SoA数组所需长度
+
+private:
+    std::vector<T> values_;                 // 元素，按槽位索引存放
+    std::vector<std::uint32_t> generations_;// 槽位代数
+    std::vector<std::uint32_t> freeList_;   // 空闲槽位栈
+    std::size_t size_ = 0;                  // 有效元素数
+};
+
+} // namespace valve
@@ -0,0 +1,109 @@
+#pragma once  // 防止头文件重复包含
+#include "valve_types.h"       // 包含基本类型定义
+#include <chrono>              // 时间和计时支持
+#include <condition_variable>  // 条件变量支持
+#include <cstdint>             // 定宽整数类型
+#include <functional>          // 函数对象支持
+#include <memory>              // 智能指针支持
+#include <mutex>               // 互斥锁支持
+#include <shared_mutex>        // 读写锁支持
+#include <thread>              // 线程支持
+#include <vector>              // 动态数组支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+/**
+ * 单条状态通知
+ */
+struct StatusUpdate {
+    std::uint32_t valve;     // 阀门编号
+    ValveStatus status;      // 最新状态
+    std::int64_t timestamp;  // 状态变化时间(单调时钟纳秒)
+};
+
+/**
+ * 订阅配置
+ */
+struct SubscriberOptions {
+    std::size_t capacity = 65536;                  // 队列容量(不同阀门数)
+    std::size_t maxBatch = 1024;                   // 单批最大通知数
+    std::chrono::microseconds maxLatency{1000};    // 最早入队的通知最长等待时间，覆盖不推迟
+};
+
+/**
+ * 订阅者统计
+ */
+struct SubscriberStats {
+    std::uint64_t published = 0;  // 发往该订阅者的通知数
+    std::uint64_t delivered = 0;  // 已交付的通知数
+    std::uint64_t batches = 0;    // 已交付的批次数
+    std::uint64_t coalesced = 0;  // 被同一阀门更新的状态覆盖的通知数
+    std::uint64_t dropped = 0;    // 队列满或阀门编号超出范围而丢弃的通知数
+};
+
+/**
+ * 状态通知分发器
+ * 控制器在完成路径上只把状态写入各订阅者的有界队列，
+ * 每个订阅者由独立线程按批交付；同一阀门未交付的旧状态被新状态覆盖，
+ * 队列满时丢弃新阀门的通知，慢订阅者只影响自己
+ * 订阅者队列是定长环形缓冲，阀门位置表按阀门数预先分配，发布路径不分配内存
+ */
+class StatusNotifier {
+public:
+    using BatchCallback = std::function<void(const std::vector<StatusUpdate>&)>;
+
+    /**
+     * 构造函数
+     * @param valveCount 阀门数量，阀门编号范围为[0, valveCount)
+     */
+    explicit StatusNotifier(std::size_t valveCount);
+    ~StatusNotifier();
+
+    StatusNotifier(const StatusNotifier&) = delete;
+    StatusNotifier& operator=(const StatusNotifier&) = delete;
+
+    /**
+     * 添加订阅者
+     * @param callback 批量通知回调，在订阅者自己的线程中调用
+     * @param options 订阅配置
+     * @return 订阅者标识
+     */
+    std::size_t subscribe(BatchCallback callback, const SubscriberOptions& options = SubscriberOptions());
+
+    /**
+     * 移除订阅者
+     * 未交付的通知被丢弃
+     * @param id subscribe返回的标识
+     */
+    void unsubscribe(std::size_t id);
+
+    /**
+     * 发布状态变化
+     * 只在各订阅者队列上短暂加锁，不等待交付
+     * @param valve 阀门编号
+     * @param status 新的阀门状态
+     */
+    void publish(std::uint32_t valve, ValveStatus status);
+
+    /**
+     * 等待所有已发布的通知交付完成
+     */
+    void flush();
+
+    /**
+     * 获取订阅者统计
+     * @param id 订阅者标识
+     * @return 统计数据，订阅者不存在时全为0
+     */
+    SubscriberStats stats(std::size_t id) const;
+
+private:
+    struct Subscriber;
+
+    std::size_t valveCount_;                                // 阀门数量
+    std::vector<std::unique_ptr<Subscriber>> subscribers_;  // 订阅者列表
+    mutable std::shared_mutex subscribersMutex_;            // 保护订阅者列表
+    std::size_t nextId_ = 1;                                // 下一个订阅者标识
+};
+
+} // namespace valve
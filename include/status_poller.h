@@ -0,0 +1,149 @@
+#pragma once  // 防止头文件重复包含
+#include "valve_types.h"       // 包含基本类型定义
+#include "valve_hal.h"         // 包含硬件抽象层接口
+#include <atomic>              // 原子变量支持
+#include <chrono>              // 时间和计时支持
+#include <condition_variable>  // 条件变量支持
+#include <cstdint>             // 定宽整数类型
+#include <functional>          // 函数对象支持
+#include <mutex>               // 互斥锁支持
+#include <thread>              // 线程支持
+#include <vector>              // 动态数组支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+/**
+ * 轮询配置
+ */
+struct PollerOptions {
+    std::chrono::microseconds minInterval{1000};    // 最短轮询间隔，预计完成时刻附近使用
+    std::chrono::microseconds maxInterval{200000};  // 预计完成前的最长轮询间隔
+    std::chrono::microseconds maxBackoff{8000};     // 预计完成时刻前后的密集轮询窗口，也是逾期后的最长退避间隔
+    std::chrono::nanoseconds defaultTravel{std::chrono::seconds(2)};  // 未给出行程时间时的预计值
+    double timeoutFactor = 4.0;                     // 超过预计时间的倍数后按错误结束，0表示不超时
+    std::size_t mergeGap = 16;                      // 批量读取时合并相距不超过该值的通道
+};
+
+/**
+ * 轮询统计
+ * 一次单阀门读取或一次批量读取各计一次总线事务
+ */
+struct PollerStats {
+    std::uint64_t transactions = 0;  // 总线事务数
+    std::uint64_t channelsRead = 0;  // 读取的通道数
+    std::uint64_t completions = 0;   // 检测到的完成数
+    std::uint64_t timeouts = 0;      // 超时结束的移动数
+};
+
+/**
+ * 集中式状态轮询器
+ * 面向不支持完成回调、只能查询状态的硬件：一个线程只轮询有未完成移动的阀门。
+ * 每个阀门的下次轮询时间按预计行程时间自适应：远离预计完成时刻时间隔长，
+ * 接近时以逐次减半的间隔逼近，逾期后从最短间隔开始按指数退避到maxBackoff；
+ * 设置了批量数据源时，同一时刻到期的阀门按相邻通道合并为少量批量读取
+ */
+class StatusPoller {
+public:
+    using CompletionHandler = std::function<void(std::uint32_t valve, ValveStatus status)>;
+
+    /**
+     * 构造函数
+     * @param handler 检测到完成或超时时在轮询线程中调用，超时报告ERROR
+     * @param options 轮询配置
+     */
+    explicit StatusPoller(CompletionHandler handler, const PollerOptions& options = PollerOptions());
+    ~StatusPoller();
+
+    StatusPoller(const StatusPoller&) = delete;
+    StatusPoller& operator=(const StatusPoller&) = delete;
+
+    /**
+     * 登记单阀门硬件
+     * 未被批量数据源覆盖的阀门通过它逐个读取状态，须在start()之前调用
+     * @param valve 阀门编号
+     * @param hal 硬件抽象层，生命周期必须长于轮询器
+     */
+    void addValve(std::uint32_t valve, const IValveHAL& hal);
+
+    /**
+     * 设置批量数据源
+     * 阀门编号firstValve + i对应通道i，须在start()之前调用
+     * @param bus 批量硬件抽象层，生命周期必须长于轮询器
+     * @param firstValve 通道0对应的阀门编号
+     */
+    void setBulkSource(const IBulkValveHAL& bus, std::uint32_t firstValve = 0);
+
+    /**
+     * 开始跟踪一次移动
+     * 同一阀门之前未完成的移动被替换
+     * @param valve 阀门编号
+     * @param target 移动目标
+     * @param travelTime 预计行程时间，0表示使用默认值
+     */
+    void expect(std::uint32_t valve, ValveMove target, std::chrono::nanoseconds travelTime);
+
+    /**
+     * 停止跟踪一个阀门
+     * @param valve 阀门编号
+     */
+    void cancel(std::uint32_t valve);
+
+    void start();
+    void stop();
+
+    /**
+     * 当前跟踪的移动数
+     */
+    std::size_t inflight() const;
+
+    PollerStats stats() const;
+
+private:
+    /**
+     * 单个阀门的跟踪状态
+     */
+    struct Tracked {
+        const IValveHAL* hal = nullptr;       // 单阀门硬件
+        std::int64_t started = 0;             // 移动开始时间(单调时钟纳秒)
+        std::int64_t travel = 0;              // 预计行程时间(纳秒)
+        std::int64_t interval = 0;            // 逾期后的当前退避间隔(纳秒)
+        std::uint32_t generation = 0;         // 每次expect/cancel递增，使旧的轮询计划失效
+        ValveStatus expected = ValveStatus::UNKNOWN;  // 目标终点状态
+        bool active = false;                  // 是否有未完成移动
+    };
+
+    /**
+     * 轮询计划
+     */
+    struct Due {
+        std::int64_t at;           // 轮询时间
+        std::uint32_t valve;       // 阀门编号
+        std::uint32_t generation;  // 计划对应的跟踪代数
+    };
+
+    void run();
+    void schedule(std::uint32_t valve, Tracked& tracked, std::int64_t now);
+    bool inBulk(std::uint32_t valve) const;
+    void read(const std::vector<std::uint32_t>& valves, const std::vector<const IValveHAL*>& hals,
+              std::vector<ValveStatus>& out);
+
+    CompletionHandler handler_;        // 完成处理函数
+    PollerOptions options_;            // 轮询配置
+    const IBulkValveHAL* bulk_ = nullptr;  // 批量数据源
+    std::uint32_t bulkFirst_ = 0;      // 通道0对应的阀门编号
+
+    mutable std::mutex mutex_;         // 保护以下成员
+    std::condition_variable wake_;     // 有更早的轮询计划或需要停止时通知
+    std::vector<Tracked> valves_;      // 按编号排列的跟踪状态
+    std::vector<Due> plan_;            // 轮询计划最小堆
+    std::size_t inflight_ = 0;         // 未完成移动数
+    bool stopping_ = false;            // 是否正在停止
+    std::thread thread_;               // 轮询线程
+
+    std::atomic<std::uint64_t> transactions_{0};  // 总线事务数
+    std::atomic<std::uint64_t> channelsRead_{0};  // 读取的通道数
+    std::atomic<std::uint64_t> completions_{0};   // 检测到的完成数
+    std::atomic<std::uint64_t> timeouts_{0};      // 超时数
+};
+
+} // namespace valve
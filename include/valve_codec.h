@@ -0,0 +1,95 @@
+#pragma once  // 防止头文件重复包含
+#include "valve_types.h"  // 包含基本类型定义
+#include <cstddef>        // size_t定义
+#include <cstdint>        // 定宽整数类型
+
+namespace valve {  // 阀门控制系统命名空间
+
+/**
+ * 紧凑编码
+ * 状态占3位；命令和命令序号合并为一个32位字：高2位为ValveCommand，低30位为序号；
+ * 批量状态采用位平面格式：每64个阀门为一个字，3个平面依次存放状态的第0、1、2位，
+ * 十万个阀门的状态只需约37.5KB
+ */
+constexpr unsigned kStatusBits = 3;                     // 状态位数
+constexpr std::uint32_t kSequenceMask = 0x3FFFFFFFu;   // 命令字中的序号部分
+
+static_assert(static_cast<unsigned>(ValveStatus::ERROR) < (1u << kStatusBits), "status must fit in 3 bits");
+static_assert(sizeof(ValveStatus) == 1, "status arrays are encoded as bytes");
+
+constexpr std::uint8_t encodeStatus(ValveStatus status) {
+    return static_cast<std::uint8_t>(status) & ((1u << kStatusBits) - 1);
+}
+
+constexpr ValveStatus decodeStatus(std::uint8_t bits) {
+    return static_cast<ValveStatus>(bits & ((1u << kStatusBits) - 1));
+}
+
+/**
+ * 打包命令和序号
+ * 序号按30位回绕
+ */
+constexpr std::uint32_t encodeCommand(ValveCommand command, std::uint32_t sequence) {
+    return (static_cast<std::uint32_t>(command) << 30) | (sequence & kSequenceMask);
+}
+
+constexpr ValveCommand commandOf(std::uint32_t word) {
+    return static_cast<ValveCommand>(word >> 30);
+}
+
+constexpr std::uint32_t sequenceOf(std::uint32_t word) {
+    return word & kSequenceMask;
+}
+
+/**
+ * 位平面中每个平面的字数
+ * @param count 阀门数量
+ */
+constexpr std::size_t statusPlaneWords(std::size_t count) {
+    return (count + 63) / 64;
+}
+
+/**
+ * 状态位图所需的字数(3个平面)
+ * @param count 阀门数量
+ */
+constexpr std::size_t statusBitmapWords(std::size_t count) {
+    return kStatusBits * statusPlaneWords(count);
+}
+
+/**
+ * 批量编码状态位图
+ * 每次处理8个阀门，用乘法把8个字节的同一位收集到一个字节中
+ * @param status 状态数组
+ * @param count 阀门数量
+ * @param planes 输出位图，长度为statusBitmapWords(count)
+ */
+void encodeStatusBitmap(const ValveStatus* status, std::size_t count, std::uint64_t* planes);
+
+/**
+ * 批量解码状态位图
+ * 每次处理8个阀门，查表把一个字节展开为8个字节
+ * @param planes 位图，长度为statusBitmapWords(count)
+ * @param count 阀门数量
+ * @param status 输出状态数组
+ */
+void decodeStatusBitmap(const std::uint64_t* planes, std::size_t count, ValveStatus* status);
+
+/**
+ * 从状态位图读取单个阀门的状态
+ * @param planes 位图
+ * @param count 位图中的阀门数量
+ * @param index 阀门索引
+ */
+inline ValveStatus statusAt(const std::uint64_t* planes, std::size_t count, std::size_t index) {
+    const std::size_t words = statusPlaneWords(count);
+    const std::size_t word = index / 64;
+    const unsigned bit = index % 64;
+    std::uint8_t bits = 0;
+    for (unsigned p = 0; p < kStatusBits; ++p) {
+        bits |= static_cast<std::uint8_t>(((planes[p * words + word] >> bit) & 1u) << p);
+    }
+    return decodeStatus(bits);
+}
+
+} // namespace valve
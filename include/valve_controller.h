@@ -1,13 +1,26 @@
 #pragma once  // 防止头文件重复包含
 #include "valve_types.h"    // 包含基本类型定义
 #include "valve_driver.h"   // 包含驱动层接口
+#include "valve_profile.h"  // 包含阀门参数配置
+#include <atomic>           // 原子变量支持
+#include <chrono>           // 时间和计时支持
+#include <cstdint>          // 定宽整数类型
 #include <memory>           // 智能指针支持
 #include <functional>       // 函数对象支持
+#include <utility>          // pair支持
+#include <vector>           // 动态数组支持
 
 namespace valve {  // 阀门控制系统命名空间
 
 // 前向声明
 class ValveState;  // 阀门状态类
+class FleetStateStore;  // 舰队状态存储
+class InterlockEngine;  // 联锁规则引擎
+class ValveJournal;  // 事件日志
+class StatusNotifier;  // 状态通知分发器
+class StatusPoller;  // 状态轮询器
+class LatencyTracker;  // 移动耗时统计
+struct ValveSnapshotRecord;  // 快照记录
 
 /**
  * 阀门控制器接口
@@ -73,11 +86,24 @@ public:
     /**
      * 构造函数
      * @param driver 驱动层接口的智能指针
+     * @throws std::invalid_argument driver为空
      */
     explicit ValveController(std::unique_ptr<IValveDriver> driver);
+
+    /**
+     * 构造函数
+     * 不接管驱动层的所有权，用于在对象区中与驱动层相邻存放
+     * @param driver 驱动层接口，生命周期必须长于控制器
+     */
+    explicit ValveController(IValveDriver& driver);
     ~ValveController() override = default;  // 虚析构函数
     
     // 实现IValveController接口的方法
+    /**
+     * 初始化控制器
+     * 参数无效时直接返回false，不下发到硬件；
+     * 有效时计算派生值，生成本阀门独有的配置
+     */
     bool setup(const ValveParameters& params) override;
     void open() override;
     void close() override;
@@ -85,6 +111,136 @@ public:
     bool isClosed() const override;
     void setStatusCallback(StatusCallback callback) override;
 
+    /**
+     * 以共享配置初始化控制器
+     * 同类阀门共享同一个配置对象，派生值不再逐个计算
+     * @param profile 阀门参数配置，通常来自ValveClassCatalog
+     * @return 设置是否成功
+     */
+    bool setup(std::shared_ptr<const ValveProfile> profile);
+
+    /**
+     * 记录已经由批量接口写入硬件的配置
+     * 不经过驱动层，用于批量初始化
+     * @param profile 阀门参数配置
+     */
+    void attachProfile(std::shared_ptr<const ValveProfile> profile) { profile_ = std::move(profile); }
+
+    /**
+     * 获取当前参数配置
+     * @return 配置对象，尚未成功初始化时为nullptr
+     */
+    const ValveProfile* profile() const { return profile_.get(); }
+
+    /**
+     * 获取全行程预计时间
+     * @return 行程时间，尚未初始化时为0
+     */
+    std::chrono::nanoseconds expectedTravelTime() const {
+        return profile_ ? profile_->travelTime : std::chrono::nanoseconds(0);
+    }
+
+    /**
+     * 绑定舰队状态存储
+     * 绑定后控制器在命令和状态变化时同步更新存储中的对应槽位
+     * @param store 舰队状态存储，传入nullptr解除绑定
+     * @param index 本阀门在存储中的槽位索引
+     */
+    void bindFleetStore(FleetStateStore* store, std::uint32_t index);
+
+    /**
+     * 接入联锁规则引擎
+     * 接入后打开/关闭命令先经联锁检查，被否决的命令不会下发到驱动层；
+     * 状态变化在通知客户端之前先更新联锁状态
+     * @param engine 联锁规则引擎，传入nullptr解除接入
+     * @param valve 本阀门在引擎中的编号
+     */
+    void setInterlock(InterlockEngine* engine, std::uint32_t valve);
+
+    /**
+     * 接入事件日志
+     * 接入后下发的命令、被否决的命令和状态变化都追加到日志；
+     * 日志未打开或已关闭时这些记录被丢弃；快照恢复不产生日志记录
+     * @param journal 事件日志，传入nullptr解除接入
+     * @param valve 本阀门在日志中的编号
+     */
+    void setJournal(ValveJournal* journal, std::uint32_t valve);
+
+    /**
+     * 接入状态通知分发器
+     * 接入后状态变化在客户端回调之后发布到分发器，由各订阅者异步批量接收
+     * @param notifier 状态通知分发器，传入nullptr解除接入
+     * @param valve 本阀门在分发器中的编号，小于分发器构造时的阀门数量
+     */
+    void setNotifier(StatusNotifier* notifier, std::uint32_t valve);
+
+    /**
+     * 接入状态轮询器
+     * 用于不支持完成回调的硬件：每次下发命令后按预计行程时间登记到轮询器，
+     * 轮询器检测到的完成由其处理函数转交reconcile()
+     * @param poller 状态轮询器，传入nullptr解除接入
+     * @param valve 本阀门在轮询器中的编号
+     */
+    void setPoller(StatusPoller* poller, std::uint32_t valve);
+
+    /**
+     * 接入移动耗时统计
+     * 接入后每次到达终点的移动记录三个阶段的耗时：命令下发到硬件接受、硬件接受到完成、
+     * 收到完成到客户端回调返回；以ERROR结束的移动只以LatencyPhase::ERROR记录下发到报错的耗时
+     * @param tracker 移动耗时统计，传入nullptr解除接入
+     * @param valveClass 本阀门在统计中的类别编号
+     */
+    void setLatencyTracker(LatencyTracker* tracker, std::uint16_t valveClass);
+
+    /**
+     * 生成快照记录
+     * 包含当前状态、最后确认状态、未完成命令和命令序号
+     * @return 快照记录
+     */
+    ValveSnapshotRecord snapshot() const;
+
+    /**
+     * 从快照记录恢复状态
+     * 用于服务重启后的热启动，不访问硬件也不通知客户端
+     * @param record 快照记录
+     */
+    void restore(const ValveSnapshotRecord& record);
+
+    /**
+     * 用硬件状态校正恢复后的状态
+     * @param hardwareStatus 硬件当前状态
+     * @return 校正后的状态
+     */
+    ValveStatus reconcile(ValveStatus hardwareStatus);
+
+    /**
+     * 获取硬件当前状态
+     * @return 驱动层报告的状态
+     */
+    ValveStatus hardwareStatus() const;
+
+    /**
+     * 获取已下发命令的序号
+     * 命令通过联锁检查并下发到驱动层时加1，open()/close()前后不变说明命令被否决
+     * @return 命令序号
+     */
+    std::uint32_t commandSequence() const { return commandSeq_.load(std::memory_order_relaxed); }
+
+    /**
+     * 添加状态观察者
+     * 与客户端回调并存，供编排引擎等内部组件订阅状态变化
+     * 观察者应在阀门动作开始前注册，在不再有动作时移除
+     * @param observer 状态变化时调用的回调函数
+     * @return 用于移除该观察者的标识
+     */
+    std::size_t addStatusObserver(StatusCallback observer);
+
+    /**
+     * 移除状态观察者
+     * @param token addStatusObserver返回的标识
+     */
+    void removeStatusObserver(std::size_t token);
+
 private:
     /**
      * 处理状态变化
@@ -92,17 +248,46 @@ private:
      * @param status 新的阀门状态
      */
     void handleStatusChange(ValveStatus status);
+
+    /**
+     * 应用新状态
+     * 更新状态机和绑定的组件，不通知客户端
+     * @param status 新的阀门状态
+     */
+    void applyStatus(ValveStatus status);
     
     /**
      * 设置当前状态
      * 状态模式的核心方法
-     * @param newState 新的状态对象
+     * @param newState 新的状态对象，状态对象无数据，由所有控制器共享
      */
-    void setState(std::unique_ptr<ValveState> newState);
+    void setState(ValveState* newState);
 
-    std::unique_ptr<IValveDriver> driver_;      // 驱动层接口
-    std::unique_ptr<ValveState> currentState_;  // 当前状态对象
+    std::unique_ptr<IValveDriver> ownedDriver_; // 拥有所有权时的驱动层
+    IValveDriver* driver_;                      // 驱动层接口
+    ValveState* currentState_;                  // 当前状态对象(共享实例)
     StatusCallback statusCallback_;             // 状态变化回调函数
+    std::vector<std::pair<std::size_t, StatusCallback>> observers_;  // 内部状态观察者
+    std::size_t nextObserverToken_ = 1;         // 下一个观察者标识
+    std::shared_ptr<const ValveProfile> profile_;  // 当前参数配置，可与同类阀门共享
+    // 以下四项由完成线程写入，同时被快照线程读取，因此为原子变量
+    std::atomic<ValveStatus> status_{ValveStatus::UNKNOWN};         // 最近一次的状态
+    std::atomic<ValveStatus> lastConfirmed_{ValveStatus::UNKNOWN};  // 最后确认的终点状态
+    std::atomic<ValveCommand> inflight_{ValveCommand::NONE};        // 未完成的命令
+    std::atomic<std::uint32_t> commandSeq_{0};                      // 已下发命令的序号
+    FleetStateStore* fleetStore_ = nullptr;     // 绑定的舰队状态存储
+    std::uint32_t fleetIndex_ = 0;              // 在舰队状态存储中的槽位
+    InterlockEngine* interlock_ = nullptr;      // 接入的联锁规则引擎
+    std::uint32_t interlockValve_ = 0;          // 在联锁规则引擎中的编号
+    ValveJournal* journal_ = nullptr;           // 接入的事件日志
+    std::uint32_t journalValve_ = 0;            // 在事件日志中的编号
+    StatusNotifier* notifier_ = nullptr;        // 接入的状态通知分发器
+    std::uint32_t notifierValve_ = 0;           // 在状态通知分发器中的编号
+    StatusPoller* poller_ = nullptr;            // 接入的状态轮询器
+    std::uint32_t pollerValve_ = 0;             // 在状态轮询器中的编号
+    LatencyTracker* latency_ = nullptr;         // 接入的移动耗时统计
+    std::uint16_t latencyClass_ = 0;            // 在移动耗时统计中的类别编号
+    std::int64_t issuedAt_ = 0;                 // 未完成命令的下发时间，0表示未计时
 };
 
 /**
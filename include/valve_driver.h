@@ -1,6 +1,8 @@
 #pragma once  // 防止头文件重复包含
 #include "valve_types.h"  // 包含基本类型定义
 #include "valve_hal.h"    // 包含硬件抽象层接口
+#include <atomic>         // 原子变量支持
+#include <cstdint>        // 定宽整数类型
 #include <functional>     // 函数对象支持
 #include <memory>         // 智能指针支持
 
@@ -49,6 +51,19 @@ public:
      * @param callback 状态变化时调用的回调函数
      */
     virtual void setStatusCallback(StatusCallback callback) = 0;
+
+    /**
+     * 开启或关闭命令接受时间记录
+     * 不支持的驱动保留默认实现
+     * @param enabled 是否记录
+     */
+    virtual void setTimestamping(bool enabled) { (void)enabled; }
+
+    /**
+     * 获取硬件接受最近一次命令的时间
+     * @return 单调时钟纳秒，未记录时为0
+     */
+    virtual std::int64_t acceptedAt() const { return 0; }
 };
 
 /**
@@ -62,8 +77,16 @@ public:
     /**
      * 构造函数
      * @param hal 硬件抽象层接口的智能指针
+     * @throws std::invalid_argument hal为空(如createHAL遇到未知类型)
      */
     explicit ValveDriver(std::unique_ptr<IValveHAL> hal);
+
+    /**
+     * 构造函数
+     * 不接管硬件抽象层的所有权，用于在对象区中与硬件抽象层相邻存放
+     * @param hal 硬件抽象层接口，生命周期必须长于驱动层
+     */
+    explicit ValveDriver(IValveHAL& hal);
     ~ValveDriver() override = default;  // 虚析构函数
     
     // 实现IValveDriver接口的方法
@@ -72,11 +95,34 @@ public:
     void close() override;
     ValveStatus getStatus() const override;
     void setStatusCallback(StatusCallback callback) override;
+    void setTimestamping(bool enabled) override { timestamping_ = enabled; }
+    std::int64_t acceptedAt() const override { return acceptedAt_.load(std::memory_order_acquire); }
 
 private:
-    std::unique_ptr<IValveHAL> hal_;  // 硬件抽象层接口
+    /**
+     * 发送移动命令
+     * 先通知移动中状态，硬件拒绝命令时通知错误状态
+     * @param target 移动目标(打开/关闭)
+     */
+    void startMove(ValveMove target);
+
+    /**
+     * 记录命令接受时间
+     */
+    void markAccepted();
+
+    /**
+     * 更新当前状态并通知观察者
+     * @param status 新的阀门状态
+     */
+    void notifyStatus(ValveStatus status);
+
+    std::unique_ptr<IValveHAL> ownedHal_;  // 拥有所有权时的硬件抽象层
+    IValveHAL* hal_;                       // 硬件抽象层接口
     StatusCallback statusCallback_;    // 状态变化回调函数
     ValveStatus currentStatus_ = ValveStatus::UNKNOWN;  // 当前状态
+    bool timestamping_ = false;                  // 是否记录命令接受时间
+    std::atomic<std::int64_t> acceptedAt_{0};    // 硬件接受最近一次命令的时间
 };
 
 } // namespace valve 
\ No newline at end of file
@@ -1,7 +1,11 @@
 #pragma once  // 防止头文件重复包含
 #include "valve_types.h"  // 包含基本类型定义
+#include "valve_codec.h"  // 包含紧凑编码定义
+#include <cstddef>  // size_t定义
+#include <functional>  // 函数对象支持
 #include <memory>  // 智能指针支持
 #include <string>  // 字符串支持
+#include <vector>  // 动态数组支持
 
 namespace valve {  // 阀门控制系统命名空间
 
@@ -34,6 +38,74 @@ public:
      * @return 阀门当前状态
      */
     virtual ValveStatus getStatus() const = 0;
+
+    // 动作完成通知回调函数类型
+    using CompletionCallback = std::function<void(ValveStatus)>;
+
+    /**
+     * 设置动作完成回调
+     * 支持完成通知的硬件在移动结束时以最终状态调用该回调，
+     * 不支持的硬件保留默认实现，由上层自行查询状态
+     * @param callback 移动结束时调用的回调函数
+     * @return 硬件是否支持完成通知
+     */
+    virtual bool setCompletionCallback(CompletionCallback callback) {
+        (void)callback;  // 默认不支持完成通知
+        return false;
+    }
+};
+
+/**
+ * 批量硬件抽象层接口
+ * 面向总线或网关类硬件，一次调用读写多个阀门通道，
+ * 通道编号与舰队中的阀门索引一致
+ */
+class IBulkValveHAL {
+public:
+    virtual ~IBulkValveHAL() = default;  // 虚析构函数
+
+    /**
+     * 获取通道数量
+     * @return 可访问的阀门通道数
+     */
+    virtual std::size_t channelCount() const = 0;
+
+    /**
+     * 批量读取阀门状态
+     * @param first 起始通道
+     * @param count 通道数量
+     * @param out 输出状态数组，长度至少为count
+     */
+    virtual void readStatus(std::size_t first, std::size_t count, ValveStatus* out) const = 0;
+
+    /**
+     * 批量读取阀门状态位图
+     * 位图格式见valve_codec.h，总线直接提供位图的硬件应重写此方法，
+     * 默认实现读取状态数组后编码
+     * @param first 起始通道
+     * @param count 通道数量
+     * @param planes 输出位图，长度至少为statusBitmapWords(count)
+     */
+    virtual void readStatusBitmap(std::size_t first, std::size_t count, std::uint64_t* planes) const {
+        std::vector<ValveStatus> status(count);
+        readStatus(first, count, status.data());
+        encodeStatusBitmap(status.data(), count, planes);
+    }
+
+    /**
+     * 批量设置阀门参数
+     * 一次总线事务写入多个通道，不支持的硬件保留默认实现，由上层逐个设置
+     * @param first 起始通道
+     * @param count 通道数量
+     * @param params 参数数组，长度为count
+     * @return 硬件是否接受了全部参数
+     */
+    virtual bool setParameters(std::size_t first, std::size_t count, const ValveParameters* params) {
+        (void)first;  // 默认不支持批量设置
+        (void)count;
+        (void)params;
+        return false;
+    }
 };
 
 /**
@@ -0,0 +1,136 @@
+#pragma once  // 防止头文件重复包含
+#include "valve_types.h"  // 包含基本类型定义
+#include <cstddef>        // size_t定义
+#include <cstdint>        // 定宽整数类型
+#include <functional>     // 函数对象支持
+#include <mutex>          // 互斥锁支持
+#include <vector>         // 动态数组支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+/**
+ * 联锁规则引擎
+ * 保存阀门之间的安全约束，例如"V5打开时V6不得打开"
+ * 规则按其引用的阀门建立索引，状态变化和命令检查只评估涉及该阀门的规则，
+ * 代价为O(涉及该阀门的规则数)，运行期间不分配内存
+ *
+ * 使用方式：先添加全部规则并调用finalize()，再通过
+ * ValveController::setInterlock()接入控制器
+ *
+ * 判定约定：OPENED和MOVING视为"打开"(移动中的阀门至少部分打开)，
+ * 只有确认的CLOSED视为"关闭"；违反判定中UNKNOWN和ERROR既不算打开也不算关闭，
+ * 命令检查中命令以外的阀门处于UNKNOWN或ERROR时按"可能打开"处理，位置未确认时拒绝命令
+ */
+class InterlockEngine {
+public:
+    /**
+     * 规则类型
+     */
+    enum class RuleKind : std::uint8_t {
+        EXCLUSIVE_OPEN,   // a和b不得同时打开
+        REQUIRES_CLOSED,  // a打开期间b必须保持关闭
+        REQUIRES_OPEN     // a打开期间b必须保持打开
+    };
+
+    // 违反规则通知：规则编号、触发的阀门
+    using ViolationHandler = std::function<void(std::uint32_t rule, std::uint32_t valve)>;
+    // 命令否决通知：阀门、被否决的命令、阻止命令的规则编号
+    using VetoHandler = std::function<void(std::uint32_t valve, ValveMove move, std::uint32_t rule)>;
+
+    /**
+     * 构造函数
+     * @param valveCount 受管阀门数量，阀门编号范围为[0, valveCount)
+     */
+    explicit InterlockEngine(std::size_t valveCount);
+
+    /**
+     * 添加规则
+     * 必须在finalize()之前调用
+     * @param kind 规则类型
+     * @param a 规则的主阀门
+     * @param b 规则的约束阀门
+     * @return 规则编号
+     */
+    std::uint32_t addRule(RuleKind kind, std::uint32_t a, std::uint32_t b);
+
+    /**
+     * 建立阀门到规则的索引
+     * 之后的命令检查和状态更新只使用索引，不再分配内存；
+     * 按此前onStatusChange()记录的状态已违反的规则立即通知，valve为规则的主阀门，
+     * 需要收到这些通知时应先设置违反规则通知
+     */
+    void finalize();
+
+    /**
+     * 检查并登记命令
+     * 假设命令完成后评估所有涉及该阀门的规则，
+     * 允许时立即把阀门记为移动中，防止并发命令绕过检查
+     * @param valve 阀门编号
+     * @param move 待下发的命令
+     * @return 命令是否允许下发
+     */
+    bool authorize(std::uint32_t valve, ValveMove move);
+
+    /**
+     * 处理阀门状态变化
+     * 增量更新涉及该阀门的规则，尚未通知的违反会通知违反处理函数；
+     * authorize()登记的移动中过渡性违反不通知，阀门到达终点后仍违反时再通知
+     * @param valve 阀门编号
+     * @param status 新状态
+     */
+    void onStatusChange(std::uint32_t valve, ValveStatus status);
+
+    /**
+     * 设置违反规则通知
+     * 在引擎内部锁中调用，处理函数不得再调用本引擎
+     * @param handler 处理函数
+     */
+    void setViolationHandler(ViolationHandler handler) { violationHandler_ = std::move(handler); }
+
+    /**
+     * 设置命令否决通知
+     * 在引擎内部锁中调用，处理函数不得再调用本引擎
+     * @param handler 处理函数
+     */
+    void setVetoHandler(VetoHandler handler) { vetoHandler_ = std::move(handler); }
+
+    bool isViolated(std::uint32_t rule) const;
+    std::size_t violatedCount() const;
+    std::uint64_t vetoCount() const;
+    std::size_t ruleCount() const { return rules_.size(); }
+
+private:
+    /**
+     * 联锁规则
+     */
+    struct Rule {
+        RuleKind kind;   // 规则类型
+        bool violated;   // 当前是否处于违反状态(含移动中的过渡性违反)
+        bool reported;   // 当前的违反是否已通知
+        std::uint32_t a; // 主阀门
+        std::uint32_t b; // 约束阀门
+    };
+
+    /**
+     * 在指定阀门取假设状态的前提下评估规则
+     * @param rule 规则
+     * @param valve 取假设状态的阀门
+     * @param status 假设状态
+     * @param strict 为true时另一阀门处于UNKNOWN或ERROR按可能打开处理(命令检查)
+     * @return 规则是否满足
+     */
+    bool holds(const Rule& rule, std::uint32_t valve, std::uint8_t status, bool strict = false) const;
+
+    std::vector<std::uint8_t> status_;        // 各阀门当前状态
+    std::vector<Rule> rules_;                 // 所有规则
+    std::vector<std::uint32_t> ruleIndex_;    // 各阀门在ruleRefs_中的起始偏移(CSR)
+    std::vector<std::uint32_t> ruleRefs_;     // 按阀门分组的规则编号
+    std::size_t violated_ = 0;                // 处于违反状态的规则数
+    std::uint64_t vetoes_ = 0;                // 否决的命令数
+    bool finalized_ = false;                  // 是否已建立索引
+    ViolationHandler violationHandler_;       // 违反规则通知
+    VetoHandler vetoHandler_;                 // 命令否决通知
+    mutable std::mutex mutex_;                // 保证检查和登记的原子性
+};
+
+} // namespace valve
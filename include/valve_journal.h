@@ -0,0 +1,206 @@
+#pragma once  // 防止头文件重复包含
+#include "valve_types.h"       // 包含基本类型定义
+#include "valve_snapshot.h"    // 包含快照记录定义
+#include <atomic>              // 原子变量支持
+#include <chrono>              // 时间和计时支持
+#include <condition_variable>  // 条件变量支持
+#include <cstdint>             // 定宽整数类型
+#include <functional>          // 函数对象支持
+#include <mutex>               // 互斥锁支持
+#include <string>              // 字符串支持
+#include <thread>              // 线程支持
+#include <vector>              // 动态数组支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+/**
+ * 日志事件类型
+ */
+enum class JournalEventKind : std::uint8_t {
+    COMMAND = 1,  // 下发命令，value为ValveCommand
+    STATUS = 2,   // 状态变化，value为ValveStatus
+    VETO = 3      // 命令被联锁否决，value为ValveCommand
+};
+
+/**
+ * 日志记录
+ * 固定32字节，commit字段最后写入，等于lsn+1时表示记录完整
+ */
+struct JournalRecord {
+    std::int64_t timestamp;   // 事件时间(系统时钟纳秒)
+    std::uint32_t valve;      // 阀门编号
+    std::uint32_t sequence;   // 控制器命令序号
+    std::uint8_t kind;        // 事件类型(JournalEventKind)
+    std::uint8_t value;       // 命令或状态值
+    std::uint16_t reserved;   // 保留，写为0
+    std::uint32_t reserved2;  // 保留，写为0
+    std::uint64_t commit;     // 提交标记：lsn+1
+};
+static_assert(sizeof(JournalRecord) == 32, "journal record must stay 32 bytes");
+
+/**
+ * 日志配置
+ */
+struct JournalOptions {
+    std::size_t segmentCount = 8;                          // 环形段文件数
+    std::size_t recordsPerSegment = 1u << 18;              // 每段记录数(8MB)
+    std::chrono::milliseconds flushInterval{2};            // 组提交间隔
+};
+
+/**
+ * 内存映射事件溯源日志
+ * 所有命令和状态变化以定长二进制记录追加到环形段文件中：
+ * 写入方通过原子递增的LSN无锁地占用槽位并直接写入映射内存，
+ * 后台线程按组提交方式确认连续已写入的前缀、更新段索引并落盘，
+ * 段写满后为其建立按阀门排序的记录索引
+ * 环形写满后最旧的段被覆盖；未落盘的记录不会被覆盖，
+ * 写入方领先落盘位置一整个环形时等待组提交
+ * 仅支持POSIX平台
+ */
+class ValveJournal {
+public:
+    static constexpr std::uint64_t kInvalidLsn = UINT64_MAX;  // 日志未打开时append()的返回值
+
+    ValveJournal();
+    ~ValveJournal();
+
+    ValveJournal(const ValveJournal&) = delete;
+    ValveJournal& operator=(const ValveJournal&) = delete;
+
+    /**
+     * 打开或创建日志目录
+     * 已有日志时从最后一条完整记录之后继续追加
+     * @param directory 日志目录
+     * @param options 日志配置，重新打开时必须与创建时一致
+     * @return 是否打开成功
+     */
+    bool open(const std::string& directory, const JournalOptions& options = JournalOptions());
+
+    /**
+     * 关闭日志，落盘所有已写入的记录
+     * 不得与append()并发调用
+     */
+    void close();
+
+    bool isOpen() const { return open_.load(std::memory_order_acquire); }
+
+    /**
+     * 追加一条记录
+     * 无锁，可在任意线程调用；环形中全是未落盘记录时阻塞到组提交腾出槽位
+     * 日志未打开或已关闭时不写入
+     * @param kind 事件类型
+     * @param valve 阀门编号
+     * @param value 命令或状态值
+     * @param sequence 控制器命令序号
+     * @return 记录的LSN，日志未打开时为kInvalidLsn
+     */
+    std::uint64_t append(JournalEventKind kind, std::uint32_t valve, std::uint8_t value, std::uint32_t sequence);
+
+    /**
+     * 等待指定LSN落盘
+     * 多个等待者共享同一次组提交
+     * @param lsn 记录的LSN
+     */
+    void waitDurable(std::uint64_t lsn);
+
+    std::uint64_t nextLsn() const { return nextLsn_.load(std::memory_order_relaxed); }
+    std::uint64_t durableLsn() const { return durableLsn_.load(std::memory_order_acquire); }
+
+private:
+    struct Segment;
+
+    /**
+     * 确认连续已写入的前缀，更新段索引并落盘
+     * 只在后台线程或关闭时调用
+     */
+    void commit();
+
+    /**
+     * 为写满的段建立阀门索引
+     * 只在组提交中调用
+     */
+    void seal(Segment& segment, std::uint64_t first);
+
+    JournalRecord* slot(std::uint64_t lsn) const;
+
+    std::vector<Segment> segments_;           // 映射的段文件
+    std::size_t recordsPerSegment_ = 0;       // 每段记录数
+    std::chrono::milliseconds flushInterval_; // 组提交间隔
+    std::atomic<std::uint64_t> nextLsn_{0};   // 下一个分配的LSN
+    std::atomic<std::uint64_t> durableLsn_{0};// 此前的记录均已落盘
+    std::atomic<bool> open_{false};           // 段已映射，可以追加
+    std::thread flusher_;                     // 组提交线程
+    std::mutex mutex_;                        // 保护等待和停止标志
+    std::condition_variable wake_;            // 唤醒组提交线程
+    std::condition_variable durable_;         // 通知落盘进度
+    bool running_ = false;                    // 组提交线程是否运行
+    bool flushRequested_ = false;             // 是否有等待者请求立即提交
+};
+
+/**
+ * 日志读取器
+ * 以只读方式映射日志目录，按段索引跳过不相关的段；
+ * 段头中超出容量的记录数视为损坏，该段被忽略
+ */
+class JournalReader {
+public:
+    using Visitor = std::function<void(std::uint64_t lsn, const JournalRecord& record)>;
+
+    JournalReader();
+    ~JournalReader();
+
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+
+    /**
+     * 打开日志目录
+     * @param directory 日志目录
+     * @return 是否打开成功
+     */
+    bool open(const std::string& directory);
+
+    /**
+     * 按LSN顺序遍历所有记录
+     * @param visitor 访问函数
+     * @return 访问的记录数
+     */
+    std::size_t scan(const Visitor& visitor) const;
+
+    /**
+     * 查询时间范围内的记录
+     * @param from 起始时间(含)
+     * @param to 结束时间(不含)
+     * @param visitor 访问函数
+     * @return 访问的记录数
+     */
+    std::size_t queryTimeRange(std::int64_t from, std::int64_t to, const Visitor& visitor) const;
+
+    /**
+     * 查询单个阀门的记录
+     * @param valve 阀门编号
+     * @param visitor 访问函数
+     * @return 访问的记录数
+     */
+    std::size_t queryValve(std::uint32_t valve, const Visitor& visitor) const;
+
+private:
+    struct Segment;
+
+    std::size_t visit(const std::function<bool(const Segment&)>& segmentFilter,
+                      const std::function<bool(const JournalRecord&)>& recordFilter,
+                      const Visitor& visitor) const;
+
+    std::vector<Segment> segments_;  // 按firstLsn排序的段
+};
+
+/**
+ * 从日志重建控制器状态
+ * 按LSN顺序重放所有记录，得到每个阀门的状态、最后确认状态、
+ * 未完成命令和命令序号，可直接用ValveController::restore()恢复
+ * @param reader 已打开的日志读取器
+ * @param fleetSize 舰队阀门数量，编号超出范围的记录被忽略
+ * @return 各阀门的快照记录
+ */
+std::vector<ValveSnapshotRecord> replayJournal(const JournalReader& reader, std::size_t fleetSize);
+
+} // namespace valve
@@ -0,0 +1,63 @@
+#pragma once  // 防止头文件重复包含
+#include "valve_types.h"  // 包含基本类型定义
+#include <chrono>         // 时间和计时支持
+#include <memory>         // 智能指针支持
+#include <mutex>          // 互斥锁支持
+#include <string>         // 字符串支持
+#include <unordered_map>  // 哈希表支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+/**
+ * 阀门参数配置
+ * 参数及其派生值，在setup()时计算一次；
+ * 同一类阀门共享同一个只读配置对象
+ */
+struct ValveProfile {
+    ValveParameters params;              // 阀门参数
+    Position stroke;                     // 行程(打开位置减关闭位置)
+    std::chrono::nanoseconds travelTime; // 全行程预计时间
+};
+
+/**
+ * 由参数计算配置
+ * 参数必须已通过validateParameters校验
+ * @param params 阀门参数
+ * @return 阀门参数配置
+ */
+constexpr ValveProfile makeProfile(const ValveParameters& params) {
+    return ValveProfile{params, params.openPosition - params.closePosition,
+                        travelTime(params.closePosition, params.openPosition, params.moveSpeed)};
+}
+
+/**
+ * 阀门类别目录
+ * 按类别名保存共享的参数配置，十万个同类阀门只引用同一份配置
+ * 线程安全
+ */
+class ValveClassCatalog {
+public:
+    /**
+     * 定义或替换一个阀门类别
+     * 替换不影响已引用旧配置的控制器
+     * @param name 类别名
+     * @param params 阀门参数
+     * @return 共享的配置，参数无效时返回nullptr
+     */
+    std::shared_ptr<const ValveProfile> define(const std::string& name, const ValveParameters& params);
+
+    /**
+     * 查找阀门类别
+     * @param name 类别名
+     * @return 共享的配置，未定义时返回nullptr
+     */
+    std::shared_ptr<const ValveProfile> find(const std::string& name) const;
+
+    std::size_t size() const;
+
+private:
+    std::unordered_map<std::string, std::shared_ptr<const ValveProfile>> classes_;  // 类别名到配置
+    mutable std::mutex mutex_;                                                      // 保护类别表
+};
+
+} // namespace valve
@@ -0,0 +1,198 @@
+#pragma once  // 防止头文件重复包含
+#include "valve_types.h"       // 包含基本类型定义
+#include "valve_controller.h"  // 包含控制器接口
+#include <atomic>              // 原子变量支持
+#include <chrono>              // 时间和计时支持
+#include <condition_variable>  // 条件变量支持
+#include <cstdint>             // 定宽整数类型
+#include <functional>          // 函数对象支持
+#include <initializer_list>    // 初始化列表支持
+#include <mutex>               // 互斥锁支持
+#include <queue>               // 优先队列支持
+#include <utility>             // pair支持
+#include <vector>              // 动态数组支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+/**
+ * 配方步骤
+ * 描述对单个阀门的一次动作及其前置依赖
+ */
+struct RecipeStep {
+    std::uint32_t valve;                     // 目标阀门在引擎舰队中的索引
+    ValveMove action;                        // 执行的动作(打开/关闭)
+    std::vector<std::uint32_t> after;        // 必须先确认完成的步骤
+    std::chrono::milliseconds timeout;       // 从下发到确认的超时时间
+    std::function<bool()> condition;         // 执行前的条件，返回false时跳过该步骤
+};
+
+/**
+ * 阀门动作配方
+ * 由若干步骤组成的有向无环图，无依赖关系的分支可并行执行
+ * 例如："关闭V1和V2，两者都确认后打开V3，30秒超时"
+ */
+class Recipe {
+public:
+    /**
+     * 添加步骤
+     * @param valve 目标阀门索引
+     * @param action 执行的动作
+     * @param after 前置步骤编号
+     * @param timeout 动作超时时间
+     * @return 新步骤的编号
+     */
+    std::uint32_t addStep(std::uint32_t valve, ValveMove action,
+                          std::initializer_list<std::uint32_t> after = {},
+                          std::chrono::milliseconds timeout = std::chrono::seconds(30));
+
+    /**
+     * 添加前置依赖
+     * @param step 步骤编号
+     * @param dependency 必须先完成的步骤编号
+     */
+    void addDependency(std::uint32_t step, std::uint32_t dependency);
+
+    /**
+     * 设置步骤的执行条件
+     * @param step 步骤编号
+     * @param condition 下发前求值的条件
+     */
+    void setCondition(std::uint32_t step, std::function<bool()> condition);
+
+    /**
+     * 检查配方是否可执行
+     * 要求所有阀门索引和依赖编号有效且依赖关系无环
+     * @param fleetSize 引擎舰队中的阀门数量
+     * @return 配方是否有效
+     */
+    bool validate(std::size_t fleetSize) const;
+
+    const std::vector<RecipeStep>& steps() const { return steps_; }
+
+private:
+    std::vector<RecipeStep> steps_;  // 所有步骤
+};
+
+/**
+ * 步骤执行结果
+ */
+enum class StepOutcome {
+    PENDING,    // 等待前置步骤
+    RUNNING,    // 已下发，等待确认
+    CONFIRMED,  // 阀门已到达目标状态
+    SKIPPED,    // 条件不满足，未下发
+    TIMED_OUT,  // 超时未确认
+    FAILED,     // 阀门报告错误、到达相反状态或命令被联锁否决
+    CANCELLED   // 因其他步骤失败而取消
+};
+
+/**
+ * 单个步骤的计时报告
+ * 时间均为相对于配方开始的纳秒数
+ */
+struct StepReport {
+    StepOutcome outcome = StepOutcome::PENDING;  // 执行结果
+    std::int64_t readyAt = -1;                   // 前置步骤全部完成且分到空闲阀门的时间
+    std::int64_t issuedAt = -1;                  // 命令下发的时间
+    std::int64_t finishedAt = -1;                // 确认或失败的时间
+};
+
+/**
+ * 配方执行报告
+ */
+struct RecipeReport {
+    bool success = false;             // 是否所有步骤都已确认或跳过
+    std::vector<StepReport> steps;    // 各步骤报告
+    std::int64_t totalNs = 0;         // 总耗时
+    std::int64_t orchestrationNs = 0; // 编排开销：各步骤从分到空闲阀门到下发的耗时之和，不含排队等阀门的时间
+};
+
+/**
+ * 配方执行引擎
+ * 订阅舰队中各控制器的状态变化，在前置步骤确认后立即下发后续步骤，
+ * 不轮询阀门状态；同一阀门上的步骤按就绪顺序依次执行
+ * 步骤下发后只接受该阀门报告移动中之后的终点状态，并丢弃上一次执行遗留的完成事件
+ */
+class RecipeEngine {
+public:
+    /**
+     * 构造函数
+     * @param fleet 参与编排的控制器，配方中的阀门索引即为该数组下标
+     */
+    explicit RecipeEngine(std::vector<ValveController*> fleet);
+    ~RecipeEngine();
+
+    RecipeEngine(const RecipeEngine&) = delete;
+    RecipeEngine& operator=(const RecipeEngine&) = delete;
+
+    /**
+     * 执行配方并等待结束
+     * 任一步骤失败或超时时取消其余步骤并立即返回
+     * @param recipe 待执行的配方
+     * @return 执行报告，配方无效时success为false且steps为空
+     */
+    RecipeReport run(const Recipe& recipe);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * 处理阀门状态变化
+     * @param valve 阀门索引
+     * @param status 新状态
+     * @param run 事件到达时的执行编号
+     */
+    void onStatus(std::uint32_t valve, ValveStatus status, std::uint64_t run);
+
+    /**
+     * 步骤结束处理，释放后续步骤
+     * 调用时必须持有mutex_
+     */
+    void finishStep(std::uint32_t step, StepOutcome outcome);
+
+    /**
+     * 将就绪步骤放入下发队列，同一阀门忙时排队等待
+     * 调用时必须持有mutex_
+     */
+    void makeReady(std::uint32_t step);
+
+    /**
+     * 依次下发队列中的步骤
+     * 同一时刻只有一个线程负责下发，同步完成的回调只负责入队
+     */
+    void drain(std::unique_lock<std::mutex>& lock);
+
+    /**
+     * 标记失败并取消所有未结束的步骤
+     * 调用时必须持有mutex_
+     */
+    void abort();
+
+    std::int64_t elapsed() const;
+
+    std::vector<ValveController*> fleet_;   // 参与编排的控制器
+    std::vector<std::size_t> observerTokens_;  // 观察者标识
+
+    std::mutex mutex_;                      // 保护执行状态
+    std::condition_variable done_;          // 配方结束或截止时间变化时通知
+
+    // 当前配方的执行状态，只在run期间有效
+    const Recipe* recipe_ = nullptr;                      // 正在执行的配方
+    Clock::time_point start_;                             // 配方开始时间
+    std::vector<StepReport> reports_;                     // 各步骤报告
+    std::vector<std::uint32_t> waiting_;                  // 各步骤未完成的前置数量
+    std::vector<std::uint32_t> dependentIndex_;           // 后继步骤的CSR偏移
+    std::vector<std::uint32_t> dependents_;               // 后继步骤
+    std::vector<std::int64_t> activeStep_;                // 各阀门正在执行的步骤，-1表示空闲
+    std::vector<std::uint8_t> moving_;                    // 各阀门在当前步骤下发后是否已报告移动中
+    std::vector<std::vector<std::uint32_t>> valveQueue_;  // 各阀门排队的步骤
+    std::vector<std::uint32_t> issueQueue_;               // 待下发的步骤
+    using Deadline = std::pair<Clock::time_point, std::uint32_t>;  // 截止时间与步骤
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> deadlines_;  // 最早截止时间在堆顶
+    std::atomic<std::uint64_t> runId_{0};                 // 执行编号，每次run加1，观察者在加锁前读取
+    std::size_t remaining_ = 0;                           // 未结束的步骤数
+    bool draining_ = false;                               // 是否有线程正在下发
+    bool failed_ = false;                                 // 是否已失败
+};
+
+} // namespace valve
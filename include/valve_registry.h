@@ -0,0 +1,15 @@
+#pragma once  // 防止头文件重复包含
+#include "slot_map.h"         // 包含槽位表定义
+#include "valve_controller.h" // 包含控制器接口定义
+#include <memory>             // 智能指针支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+/**
+ * 阀门注册表
+ * 以ValveId管理控制器的所有权，阀门退役后旧标识可被检测出来；
+ * ValveId::index可同时用作FleetStateStore槽位、联锁和日志中的阀门编号
+ */
+using ValveRegistry = SlotMap<std::unique_ptr<ValveController>>;
+
+} // namespace valve
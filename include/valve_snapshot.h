@@ -0,0 +1,120 @@
+#pragma once  // 防止头文件重复包含
+#include "valve_types.h"       // 包含基本类型定义
+#include "valve_hal.h"         // 包含硬件抽象层接口
+#include <atomic>              // 原子变量支持
+#include <chrono>              // 时间和计时支持
+#include <condition_variable>  // 条件变量支持
+#include <cstdint>             // 定宽整数类型
+#include <mutex>               // 互斥锁支持
+#include <string>              // 字符串支持
+#include <thread>              // 线程支持
+#include <vector>              // 动态数组支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+class ValveController;  // 阀门控制器
+
+/**
+ * 单个阀门的快照记录
+ * 控制器与快照、日志重放之间交换状态的内存格式；
+ * 写入文件时压缩为命令字和状态位图，见ValveSnapshotHeader
+ */
+struct ValveSnapshotRecord {
+    std::uint8_t status;         // 控制器当前状态(ValveStatus)
+    std::uint8_t lastConfirmed;  // 最后确认的终点状态(ValveStatus)
+    std::uint8_t inflight;       // 未完成的命令(ValveCommand)
+    std::uint8_t reserved;       // 保留，写为0
+    std::uint32_t sequence;      // 已下发命令的序号
+};
+static_assert(sizeof(ValveSnapshotRecord) == 8, "snapshot record must stay 8 bytes");
+
+/**
+ * 快照文件头
+ * 文件布局：文件头 + count个32位命令字(ValveCommand和序号，按8字节对齐)
+ *         + 状态位图 + 最后确认状态位图，编码见valve_codec.h
+ * 序号在文件中只保留低30位
+ */
+struct ValveSnapshotHeader {
+    std::uint32_t magic;      // 文件标识"VSNP"
+    std::uint32_t version;    // 格式版本
+    std::uint64_t count;      // 记录数
+    std::int64_t savedAt;     // 写入时间(系统时钟纳秒)
+    std::uint32_t checksum;   // 记录区校验和
+    std::uint32_t reserved;   // 保留，写为0
+};
+static_assert(sizeof(ValveSnapshotHeader) == 32, "snapshot header must stay 32 bytes");
+
+/**
+ * 写入舰队快照
+ * 先写入临时文件再原子替换，写入过程中崩溃不会破坏旧快照
+ * @param path 快照文件路径
+ * @param fleet 控制器数组，记录顺序与数组下标一致
+ * @return 是否写入成功
+ */
+bool saveSnapshot(const std::string& path, const std::vector<ValveController*>& fleet);
+
+/**
+ * 读取快照并恢复舰队状态
+ * 一次遍历恢复所有控制器，记录数与舰队大小不一致时只恢复重叠部分
+ * @param path 快照文件路径
+ * @param fleet 控制器数组
+ * @return 恢复的控制器数量，文件无效时返回0
+ */
+std::size_t loadSnapshot(const std::string& path, const std::vector<ValveController*>& fleet);
+
+/**
+ * 用硬件状态校正整个舰队
+ * 提供批量硬件接口时一次读取所有通道状态，否则逐个经驱动层读取
+ * @param fleet 控制器数组
+ * @param bulk 批量硬件接口，可为nullptr
+ * @return 校正后处于明确终点状态(OPENED/CLOSED)的阀门数量
+ */
+std::size_t reconcileFleet(const std::vector<ValveController*>& fleet, const IBulkValveHAL* bulk);
+
+/**
+ * 周期性快照写入器
+ * 后台线程按固定间隔写入快照，停止时再写入一次，用于关机前保存
+ */
+class SnapshotScheduler {
+public:
+    /**
+     * 构造函数
+     * @param path 快照文件路径
+     * @param fleet 控制器数组
+     */
+    SnapshotScheduler(std::string path, std::vector<ValveController*> fleet);
+    ~SnapshotScheduler();
+
+    SnapshotScheduler(const SnapshotScheduler&) = delete;
+    SnapshotScheduler& operator=(const SnapshotScheduler&) = delete;
+
+    /**
+     * 启动后台写入
+     * @param interval 写入间隔
+     */
+    void start(std::chrono::milliseconds interval);
+
+    /**
+     * 停止后台写入并写入最后一次快照
+     */
+    void stop();
+
+    /**
+     * 立即写入一次快照
+     * @return 是否写入成功
+     */
+    bool saveNow();
+
+    std::uint64_t savedCount() const { return saved_.load(); }
+
+private:
+    std::string path_;                      // 快照文件路径
+    std::vector<ValveController*> fleet_;   // 控制器数组
+    std::thread worker_;                    // 后台写入线程
+    std::mutex mutex_;                      // 保护运行标志
+    std::condition_variable wake_;          // 停止时唤醒后台线程
+    bool running_ = false;                  // 后台线程是否运行
+    std::atomic<std::uint64_t> saved_{0};   // 成功写入次数
+};
+
+} // namespace valve
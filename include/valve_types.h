@@ -1,4 +1,6 @@
 #pragma once  // 防止头文件重复包含
+#include "valve_units.h"  // 包含定点数量纲类型
+#include <cstdint>  // 定宽整数类型
 
 namespace valve {  // 阀门控制系统命名空间
 
@@ -6,30 +8,73 @@ namespace valve {  // 阀门控制系统命名空间
  * 阀门参数结构体
  * 用于配置阀门的基本参数
  * 对应Coco模型中的ValveParameters
+ * 位置和速度使用带量纲的定点数，不能互相混用
  */
 struct ValveParameters {
-    int openPosition;   // 阀门完全打开时的位置值
-    int closePosition;  // 阀门完全关闭时的位置值
-    int moveSpeed;      // 阀门移动速度
+    Position openPosition;   // 阀门完全打开时的位置值
+    Position closePosition;  // 阀门完全关闭时的位置值
+    Speed moveSpeed;         // 阀门移动速度(位置单位/秒)
     // 其他可能的参数...
 };
 
+/**
+ * 参数校验结果
+ */
+enum class ParameterError : std::uint8_t {
+    NONE,                // 参数有效
+    ZERO_STROKE,         // 打开位置与关闭位置相同
+    NON_POSITIVE_SPEED,  // 速度不大于0
+    STROKE_OVERFLOW      // 行程超出位置类型的表示范围
+};
+
+/**
+ * 校验参数
+ * 可在编译期对常量参数集使用
+ * @param params 阀门参数
+ * @return 校验结果
+ */
+constexpr ParameterError validateParameters(const ValveParameters& params) {
+    const std::int64_t stroke = static_cast<std::int64_t>(params.openPosition.raw()) - params.closePosition.raw();
+    if (stroke == 0) {
+        return ParameterError::ZERO_STROKE;
+    }
+    if (params.moveSpeed.raw() <= 0) {
+        return ParameterError::NON_POSITIVE_SPEED;
+    }
+    if (stroke > INT32_MAX || stroke < -static_cast<std::int64_t>(INT32_MAX)) {
+        return ParameterError::STROKE_OVERFLOW;
+    }
+    return ParameterError::NONE;
+}
+
 /**
  * 阀门移动命令枚举
  * 定义了阀门可执行的基本动作
  * 对应Coco模型中的ValveHAL.Moves枚举
+ * 按字节存放，线路和存储格式见valve_codec.h
  */
-enum class ValveMove {
+enum class ValveMove : std::uint8_t {
     OPEN = 20,    // 打开阀门命令，值20对应Coco模型中的定义
     CLOSE = 101   // 关闭阀门命令，值101对应Coco模型中的定义
 };
 
+/**
+ * 控制器记录的命令枚举
+ * 与ValveMove不同，包含"无命令"，用于记录未完成的命令
+ */
+enum class ValveCommand : std::uint8_t {
+    NONE,   // 没有未完成的命令
+    OPEN,   // 打开命令未完成
+    CLOSE   // 关闭命令未完成
+};
+
 /**
  * 阀门状态枚举
  * 表示阀门当前的工作状态
  * 对应Coco模型中的ValveDriver.Status枚举
+ * 按字节存放，所有取值都可用3位表示
  */
-enum class ValveStatus {
+enum class ValveStatus : std::uint8_t {
     UNKNOWN,  // 未知状态，初始状态或状态不确定
     OPENED,   // 阀门已完全打开
     CLOSED,   // 阀门已完全关闭
@@ -37,4 +82,23 @@ enum class ValveStatus {
     ERROR     // 阀门发生错误
 };
 
+/**
+ * 阀门标识
+ * 由槽位索引和代数组成：索引可直接用作SoA数组和批量硬件接口的通道下标，
+ * 代数在阀门退役、槽位被复用时递增，使旧标识失效
+ * 有效标识的代数为奇数，默认构造的标识无效
+ */
+struct ValveId {
+    std::uint32_t index = 0;       // 槽位索引
+    std::uint32_t generation = 0;  // 槽位代数
+
+    bool operator==(const ValveId& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const ValveId& other) const { return !(*this == other); }
+
+    /**
+     * 打包为64位值，用于日志和线路传输
+     */
+    std::uint64_t packed() const { return (static_cast<std::uint64_t>(generation) << 32) | index; }
+};
+
 } // namespace valve 
\ No newline at end of file
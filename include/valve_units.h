@@ -0,0 +1,101 @@
+#pragma once  // 防止头文件重复包含
+#include <chrono>     // 时间和计时支持
+#include <cstdint>    // 定宽整数类型
+#include <stdexcept>  // 越界异常
+
+namespace valve {  // 阀门控制系统命名空间
+
+/**
+ * 带量纲的定点数
+ * 以32位整数存放，低FractionBits位为小数部分；
+ * 不同Tag的类型之间不能相互赋值或运算，避免位置和速度混用
+ * @tparam Tag 量纲标记
+ * @tparam FractionBits 小数位数
+ */
+template <typename Tag, int FractionBits>
+class Fixed {
+public:
+    using Raw = std::int32_t;
+    static constexpr int kFractionBits = FractionBits;
+    static constexpr Raw kOne = Raw(1) << FractionBits;  // 一个整数单位对应的原始值
+    static constexpr std::int64_t kMaxUnits = INT32_MAX >> FractionBits;                  // 可表示的最大整数单位
+    static constexpr std::int64_t kMinUnits = -(std::int64_t(1) << (31 - FractionBits));  // 可表示的最小整数单位
+
+    constexpr Fixed() = default;
+
+    /**
+     * 由整数单位构造
+     * 按64位整数换算，超出[kMinUnits, kMaxUnits]时抛出std::out_of_range，
+     * 常量表达式中越界则编译失败
+     * @param units 整数单位值
+     */
+    constexpr explicit Fixed(int units) : raw_(unitsToRaw(units)) {}
+
+    /**
+     * 检查整数单位值能否表示
+     * 来自配置等外部输入的值应先检查再构造
+     */
+    static constexpr bool representable(std::int64_t units) { return units >= kMinUnits && units <= kMaxUnits; }
+
+    /**
+     * 由原始定点值构造
+     * @param raw 原始值
+     */
+    static constexpr Fixed fromRaw(Raw raw) {
+        Fixed value;
+        value.raw_ = raw;
+        return value;
+    }
+
+    constexpr Raw raw() const { return raw_; }
+
+    /**
+     * 转换为整数单位，向零取整
+     */
+    constexpr int toInt() const { return raw_ / kOne; }
+
+    constexpr double toDouble() const { return static_cast<double>(raw_) / kOne; }
+
+    constexpr Fixed operator+(Fixed other) const { return fromRaw(raw_ + other.raw_); }
+    constexpr Fixed operator-(Fixed other) const { return fromRaw(raw_ - other.raw_); }
+    constexpr Fixed operator-() const { return fromRaw(-raw_); }
+    constexpr bool operator==(Fixed other) const { return raw_ == other.raw_; }
+    constexpr bool operator!=(Fixed other) const { return raw_ != other.raw_; }
+    constexpr bool operator<(Fixed other) const { return raw_ < other.raw_; }
+    constexpr bool operator<=(Fixed other) const { return raw_ <= other.raw_; }
+    constexpr bool operator>(Fixed other) const { return raw_ > other.raw_; }
+    constexpr bool operator>=(Fixed other) const { return raw_ >= other.raw_; }
+
+private:
+    static constexpr Raw unitsToRaw(std::int64_t units) {
+        if (!representable(units)) {
+            throw std::out_of_range("fixed-point value out of range");
+        }
+        return static_cast<Raw>(units * kOne);
+    }
+
+    Raw raw_ = 0;  // 原始定点值
+};
+
+struct PositionTag;  // 位置量纲
+struct SpeedTag;     // 速度量纲
+
+using Position = Fixed<PositionTag, 8>;  // 阀门位置，分辨率1/256个位置单位
+using Speed = Fixed<SpeedTag, 8>;        // 移动速度，单位为位置单位/秒，分辨率1/256
+
+/**
+ * 计算以指定速度走完指定行程所需的时间
+ * 按64位整数计算，不会溢出
+ * @param from 起点位置
+ * @param to 终点位置
+ * @param speed 移动速度，必须为正
+ * @return 行程时间
+ */
+constexpr std::chrono::nanoseconds travelTime(Position from, Position to, Speed speed) {
+    const std::int64_t distance = static_cast<std::int64_t>(to.raw()) - from.raw();
+    const std::int64_t magnitude = distance < 0 ? -distance : distance;
+    // 位置和速度的小数位数相同，比值即为秒数
+    return std::chrono::nanoseconds(magnitude * 1000000000 / speed.raw());
+}
+
+} // namespace valve
@@ -27,11 +27,13 @@ int main() {
                   << static_cast<int>(status) << std::endl;
     });
     
-    // 初始化阀门参数
-    ValveParameters params;
-    params.openPosition = 100;    // 设置打开位置
-    params.closePosition = 0;     // 设置关闭位置
-    params.moveSpeed = 10;        // 设置移动速度
+    // 初始化阀门参数，常量参数集在编译期校验
+    constexpr ValveParameters params{
+        Position(100),  // 设置打开位置
+        Position(0),    // 设置关闭位置
+        Speed(50)       // 设置移动速度，全行程2秒
+    };
+    static_assert(validateParameters(params) == ParameterError::NONE, "invalid valve parameters");
     controller->setup(params);    // 配置阀门参数
     
     // 测试阀门操作 - 打开阀门
@@ -0,0 +1,78 @@
+#include "../include/bus_simulator.h"  // 包含总线网关模拟器定义
+#include <algorithm>  // 复制支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+/**
+ * 设置单个通道的参数
+ * 每次调用计一次总线事务
+ */
+bool BusChannel::setParameters(const ValveParameters& params) {
+    if (validateParameters(params) != ParameterError::NONE) {
+        return false;  // 拒绝无效参数
+    }
+    bus_->params_[index_] = params;
+    ++bus_->parameterTransactions_;
+    return true;
+}
+
+/**
+ * 移动阀门
+ * 立即到达终点并同步通知
+ */
+bool BusChannel::move(ValveMove target) {
+    return moveTo(target, [this](ValveStatus status) {
+        if (callback_) {
+            callback_(status);  // 经回调通知驱动层
+        }
+    });
+}
+
+ValveStatus BusChannel::getStatus() const {
+    return bus_->status_[index_];
+}
+
+bool BusChannel::setCompletionCallback(CompletionCallback callback) {
+    callback_ = std::move(callback);
+    return true;
+}
+
+/**
+ * BusSimulator构造函数
+ * @param channels 通道数量
+ */
+BusSimulator::BusSimulator(std::size_t channels)
+    : status_(channels, ValveStatus::UNKNOWN), params_(channels) {
+}
+
+BusSimulator::~BusSimulator() = default;
+
+void BusSimulator::readStatus(std::size_t first, std::size_t count, ValveStatus* out) const {
+    std::copy(status_.begin() + static_cast<std::ptrdiff_t>(first),
+              status_.begin() + static_cast<std::ptrdiff_t>(first + count), out);
+}
+
+/**
+ * 批量设置阀门参数
+ * 有任何一组参数无效时整批拒绝
+ * @return 是否全部写入
+ */
+bool BusSimulator::setParameters(std::size_t first, std::size_t count, const ValveParameters* params) {
+    if (first + count > params_.size()) {
+        return false;  // 超出通道范围
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        if (validateParameters(params[i]) != ParameterError::NONE) {
+            return false;
+        }
+    }
+    std::copy(params, params + count, params_.begin() + static_cast<std::ptrdiff_t>(first));
+    ++parameterTransactions_;  // 整批一次事务
+    return true;
+}
+
+std::unique_ptr<IValveHAL> BusSimulator::channel(std::size_t index) {
+    return std::make_unique<BusChannel>(*this, index);
+}
+
+} // namespace valve
@@ -0,0 +1,507 @@
+#include "../include/fleet_loader.h"  // 包含舰队配置加载器定义
+#include <chrono>         // 时间和计时支持
+#include <cstdio>         // 格式化输出
+#include <cstring>        // 内存操作
+#include <thread>         // 线程支持
+#include <unordered_map>  // 哈希表支持
+
+#ifdef _WIN32
+#include <fstream>  // Windows下读入内存
+#else
+#include <fcntl.h>     // open
+#include <sys/mman.h>  // mmap
+#include <sys/stat.h>  // fstat
+#include <unistd.h>    // close
+#endif
+
+namespace valve {  // 阀门控制系统命名空间
+
+namespace {  // 内部实现细节
+
+constexpr std::uint32_t kFleetMagic = 0x544C4656;  // "VFLT"小端存放
+constexpr std::uint32_t kFleetVersion = 1;         // 当前格式版本
+constexpr std::int64_t kMaxWhole = (std::int64_t(1) << (31 - Position::kFractionBits)) - 1;  // 定点整数部分上限
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * 只读映射的文件
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) {
+            return;
+        }
+        buffer_.resize(static_cast<std::size_t>(in.tellg()));
+        in.seekg(0);
+        if (in.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()))) {
+            data_ = buffer_.data();
+            size_ = buffer_.size();
+            valid_ = true;
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) == 0) {
+            size_ = static_cast<std::size_t>(st.st_size);
+            if (size_ == 0) {
+                valid_ = true;  // 空文件
+            } else {
+                void* map = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (map != MAP_FAILED) {
+                    ::madvise(map, size_, MADV_SEQUENTIAL);  // 顺序读取
+                    data_ = static_cast<const char*>(map);
+                    valid_ = true;
+                }
+            }
+        }
+        ::close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (data_) {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool valid() const { return valid_; }
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;  // 文件内容
+    std::size_t size_ = 0;        // 文件长度
+    bool valid_ = false;          // 是否成功打开
+#ifdef _WIN32
+    std::vector<char> buffer_;    // 读入的文件内容
+#endif
+};
+
+/**
+ * 把[0, count)切分为threads段并行执行
+ * 当前线程执行最后一段
+ */
+template <typename Fn>
+void parallelFor(unsigned threads, std::size_t count, Fn&& fn) {
+    if (threads <= 1 || count < 2) {
+        fn(0u, std::size_t(0), count);
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (unsigned t = 0; t + 1 < threads; ++t) {
+        workers.emplace_back([&fn, t, threads, count] {
+            fn(t, count * t / threads, count * (t + 1) / threads);
+        });
+    }
+    fn(threads - 1, count * (threads - 1) / threads, count);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+/**
+ * 解析十进制定点数，最多取6位小数
+ */
+bool parseFixed(const char*& p, const char* end, std::int32_t& raw) {
+    bool negative = false;
+    if (p < end && *p == '-') {
+        negative = true;
+        ++p;
+    }
+    if (p >= end || !isDigit(*p)) {
+        return false;
+    }
+    std::int64_t whole = 0;
+    while (p < end && isDigit(*p)) {
+        whole = whole * 10 + (*p++ - '0');
+        if (whole > kMaxWhole) {
+            return false;  // 超出定点数范围
+        }
+    }
+    std::int64_t fraction = 0;
+    std::int64_t scale = 1;
+    if (p < end && *p == '.') {
+        ++p;
+        while (p < end && isDigit(*p)) {
+            if (scale < 1000000) {
+                fraction = fraction * 10 + (*p - '0');
+                scale *= 10;
+            }
+            ++p;
+        }
+    }
+    std::int64_t value = whole * Position::kOne + fraction * Position::kOne / scale;
+    raw = static_cast<std::int32_t>(negative ? -value : value);
+    return true;
+}
+
+bool parseZone(const char*& p, const char* end, std::uint16_t& zone) {
+    if (p >= end || !isDigit(*p)) {
+        return false;
+    }
+    std::uint32_t value = 0;
+    while (p < end && isDigit(*p)) {
+        value = value * 10 + static_cast<std::uint32_t>(*p++ - '0');
+        if (value > 0xFFFF) {
+            return false;
+        }
+    }
+    zone = static_cast<std::uint16_t>(value);
+    return true;
+}
+
+bool expect(const char*& p, const char* end, char c) {
+    if (p < end && *p == c) {
+        ++p;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * 解析一行"zone,open,close,speed"，行首行尾空白已去除
+ */
+bool parseLine(const char* p, const char* end, FleetEntry& entry) {
+    std::int32_t open = 0;
+    std::int32_t close = 0;
+    std::int32_t speed = 0;
+    if (!parseZone(p, end, entry.zone) || !expect(p, end, ',') || !parseFixed(p, end, open) ||
+        !expect(p, end, ',') || !parseFixed(p, end, close) || !expect(p, end, ',') ||
+        !parseFixed(p, end, speed)) {
+        return false;
+    }
+    if (p != end) {
+        return false;
+    }
+    entry.params = ValveParameters{Position::fromRaw(open), Position::fromRaw(close), Speed::fromRaw(speed)};
+    return validateParameters(entry.params) == ParameterError::NONE;
+}
+
+bool isBlank(char c) { return c == ' ' || c == '\t'; }
+
+/**
+ * 跳过文件开头的空行、注释和表头
+ * 第一个非空、非注释行不以数字开头时视为表头
+ * @return 第一个数据行的偏移
+ */
+std::size_t skipCsvHeader(const char* data, std::size_t size) {
+    std::size_t pos = 0;
+    while (pos < size) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+        std::size_t next = lineEnd ? static_cast<std::size_t>(lineEnd - data) + 1 : size;
+        std::size_t first = pos;
+        while (first < next && (isBlank(data[first]) || data[first] == '\r' || data[first] == '\n')) {
+            ++first;
+        }
+        if (first < next && data[first] != '#') {
+            return isDigit(data[first]) ? pos : next;  // 数据行或表头
+        }
+        pos = next;  // 空行或注释
+    }
+    return pos;
+}
+
+/**
+ * 解析CSV的一段，段的起止都在行首
+ * 数据行按段内顺序编号，rows返回段内数据行数，由调用方换算为全局通道编号
+ */
+void parseCsvRange(const char* begin, const char* end, std::vector<FleetEntry>& out, std::size_t& rejected,
+                   std::uint32_t& rows) {
+    while (begin < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(begin, '\n', static_cast<std::size_t>(end - begin)));
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+        const char* first = begin;
+        const char* last = lineEnd;
+        while (first < last && (isBlank(*first) || *first == '\r')) {
+            ++first;  // 允许行首空白
+        }
+        while (last > first && (isBlank(last[-1]) || last[-1] == '\r')) {
+            --last;  // 允许行尾空白，兼容CRLF
+        }
+        begin = lineEnd + 1;
+        if (first == last || *first == '#') {
+            continue;  // 空行和注释不占用通道
+        }
+        FleetEntry entry;
+        if (parseLine(first, last, entry)) {
+            entry.channel = rows;
+            out.push_back(entry);
+        } else {
+            ++rejected;  // 空出通道
+        }
+        ++rows;
+    }
+}
+
+/**
+ * 参数去重用的键
+ */
+struct ParameterKey {
+    std::int32_t open;
+    std::int32_t close;
+    std::int32_t speed;
+    bool operator==(const ParameterKey& other) const {
+        return open == other.open && close == other.close && speed == other.speed;
+    }
+};
+
+struct ParameterKeyHash {
+    std::size_t operator()(const ParameterKey& key) const {
+        std::uint64_t h = static_cast<std::uint32_t>(key.open);
+        h = h * 0x9E3779B97F4A7C15ull ^ static_cast<std::uint32_t>(key.close);
+        h = h * 0x9E3779B97F4A7C15ull ^ static_cast<std::uint32_t>(key.speed);
+        return static_cast<std::size_t>(h ^ (h >> 32));
+    }
+};
+
+} // namespace
+
+std::string LoadReport::toString() const {
+    char text[512];
+    std::snprintf(text, sizeof(text),
+                  "loaded %zu valves (%zu rejected, %zu profiles) from %s file with %u threads\n"
+                  "  map %.2f ms, parse %.2f ms, construct %.2f ms, configure %.2f ms (%s), total %.2f ms",
+                  valves, rejected, profiles, binary ? "binary" : "csv", threads, mapMs, parseMs, constructMs,
+                  configureMs, bulkConfigured ? "bulk" : "per valve", totalMs);
+    return text;
+}
+
+/**
+ * FleetLoader构造函数
+ * @param threads 线程数，0表示使用硬件并发数
+ */
+FleetLoader::FleetLoader(unsigned threads) : threads_(threads) {
+    if (threads_ == 0) {
+        threads_ = std::thread::hardware_concurrency();
+    }
+    if (threads_ == 0) {
+        threads_ = 1;  // 无法获取时单线程
+    }
+}
+
+/**
+ * 解析描述文件
+ * 二进制文件按记录数均分，CSV按字节均分后对齐到行首
+ */
+bool FleetLoader::parse(const std::string& path, std::vector<FleetEntry>& out, LoadReport& report) const {
+    auto start = Clock::now();
+    MappedFile file(path);
+    if (!file.valid()) {
+        return false;
+    }
+    report.mapMs = msSince(start);
+    report.threads = threads_;
+
+    start = Clock::now();
+    std::vector<std::vector<FleetEntry>> chunks(threads_);
+    std::vector<std::size_t> rejected(threads_, 0);
+    std::vector<std::uint32_t> rows(threads_, 0);  // 各段数据行数
+    FleetBinaryHeader header{};
+    if (file.size() >= sizeof(header)) {
+        std::memcpy(&header, file.data(), sizeof(header));
+    }
+    report.binary = header.magic == kFleetMagic;
+
+    if (report.binary) {
+        // 先用除法检查记录数，避免count * sizeof溢出后通过长度检查
+        const std::size_t available = (file.size() - sizeof(header)) / sizeof(FleetBinaryRecord);
+        if (header.version != kFleetVersion || header.count > available || header.count > UINT32_MAX ||
+            file.size() != sizeof(header) + header.count * sizeof(FleetBinaryRecord)) {
+            return false;  // 格式不符
+        }
+        const char* records = file.data() + sizeof(header);
+        parallelFor(threads_, static_cast<std::size_t>(header.count),
+                    [&](unsigned t, std::size_t first, std::size_t last) {
+            chunks[t].reserve(last - first);
+            for (std::size_t i = first; i < last; ++i) {
+                FleetBinaryRecord record;
+                std::memcpy(&record, records + i * sizeof(record), sizeof(record));
+                FleetEntry entry{record.zone, ValveParameters{Position::fromRaw(record.openPosition),
+                                                              Position::fromRaw(record.closePosition),
+                                                              Speed::fromRaw(record.moveSpeed)},
+                                 static_cast<std::uint32_t>(i)};
+                if (validateParameters(entry.params) == ParameterError::NONE) {
+                    chunks[t].push_back(entry);
+                } else {
+                    ++rejected[t];
+                }
+            }
+        });
+    } else {
+        const std::size_t header = skipCsvHeader(file.data(), file.size());
+        const char* data = file.data() + header;
+        const std::size_t size = file.size() - header;
+        parallelFor(threads_, size, [&](unsigned t, std::size_t first, std::size_t last) {
+            // 段边界移到下一行行首，跨边界的行由前一段处理
+            auto align = [data, size](std::size_t pos) {
+                while (pos > 0 && pos < size && data[pos - 1] != '\n') {
+                    ++pos;
+                }
+                return pos;
+            };
+            first = align(first);
+            last = align(last);
+            chunks[t].reserve((last - first) / 16);
+            parseCsvRange(data + first, data + last, chunks[t], rejected[t], rows[t]);
+        });
+    }
+
+    std::size_t total = 0;
+    for (unsigned t = 0; t < threads_; ++t) {
+        total += chunks[t].size();
+        report.rejected += rejected[t];
+    }
+    out.clear();
+    out.reserve(total);
+    std::uint32_t base = 0;  // 之前各段的CSV数据行数，二进制记录的编号已是全局的
+    for (unsigned t = 0; t < threads_; ++t) {
+        for (FleetEntry entry : chunks[t]) {
+            entry.channel += base;
+            out.push_back(entry);
+        }
+        base += rows[t];
+    }
+    report.valves = out.size();
+    report.parseMs = msSince(start);
+    return true;
+}
+
+/**
+ * 加载舰队
+ * 解析、去重、并行构造、下发参数四个阶段，每个阶段结束时报告进度
+ */
+std::unique_ptr<LoadedFleet> FleetLoader::load(const std::string& path, const HALFactory& halFactory,
+                                               IBulkValveHAL* bulk, LoadReport& report) const {
+    const auto begin = Clock::now();
+    std::vector<FleetEntry> entries;
+    if (!parse(path, entries, report)) {
+        return nullptr;
+    }
+    const std::size_t n = entries.size();
+    if (progress_) {
+        progress_("parse", n, n);
+    }
+
+    // 相同参数的阀门共享同一配置
+    auto start = Clock::now();
+    auto fleet = std::make_unique<LoadedFleet>(n);
+    std::vector<std::uint32_t> profileOf(n);
+    std::unordered_map<ParameterKey, std::uint32_t, ParameterKeyHash> interned;
+    for (std::size_t i = 0; i < n; ++i) {
+        const ValveParameters& p = entries[i].params;
+        ParameterKey key{p.openPosition.raw(), p.closePosition.raw(), p.moveSpeed.raw()};
+        auto it = interned.find(key);
+        if (it == interned.end()) {
+            it = interned.emplace(key, static_cast<std::uint32_t>(fleet->profiles.size())).first;
+            fleet->profiles.push_back(std::make_shared<const ValveProfile>(makeProfile(p)));
+        }
+        profileOf[i] = it->second;
+    }
+    report.profiles = fleet->profiles.size();
+
+    // 在对象区中并行构造控制器
+    fleet->fleet.resize(n);
+    fleet->zones.resize(n);
+    fleet->channels.resize(n);
+    parallelFor(threads_, n, [&](unsigned, std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            fleet->fleet[i] =
+                fleet->controllers.construct(i, std::make_unique<ValveDriver>(halFactory(entries[i].channel)));
+            fleet->zones[i] = entries[i].zone;
+            fleet->channels[i] = entries[i].channel;
+        }
+    });
+    report.constructMs = msSince(start);
+    if (progress_) {
+        progress_("construct", n, n);
+    }
+
+    // 优先批量下发全部参数，每段连续通道一次批量调用，被拒绝的行空出的通道不写入
+    start = Clock::now();
+    if (bulk && n > 0 && bulk->channelCount() > entries[n - 1].channel) {
+        std::vector<ValveParameters> params(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            params[i] = entries[i].params;
+        }
+        report.bulkConfigured = true;
+        for (std::size_t run = 0; run < n && report.bulkConfigured;) {
+            std::size_t end = run + 1;
+            while (end < n && entries[end].channel == entries[end - 1].channel + 1) {
+                ++end;
+            }
+            report.bulkConfigured = bulk->setParameters(entries[run].channel, end - run, params.data() + run);
+            run = end;
+        }
+    }
+    std::vector<std::size_t> failed(threads_, 0);
+    parallelFor(threads_, n, [&](unsigned t, std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            if (report.bulkConfigured) {
+                fleet->fleet[i]->attachProfile(fleet->profiles[profileOf[i]]);
+            } else if (!fleet->fleet[i]->setup(fleet->profiles[profileOf[i]])) {  // 逐个下发
+                ++failed[t];
+            }
+        }
+    });
+    // 下发失败的控制器仍保留在原下标上，但不计入成功加载的阀门
+    for (std::size_t count : failed) {
+        report.valves -= count;
+        report.rejected += count;
+    }
+    report.configureMs = msSince(start);
+    if (progress_) {
+        progress_("configure", n, n);
+    }
+
+    report.totalMs = msSince(begin);
+    return fleet;
+}
+
+/**
+ * 写入二进制舰队描述文件
+ */
+bool writeFleetBinary(const std::string& path, const std::vector<FleetEntry>& entries) {
+    for (std::size_t i = 1; i < entries.size(); ++i) {
+        if (entries[i].channel <= entries[i - 1].channel) {
+            return false;  // 通道编号必须严格递增
+        }
+    }
+    std::vector<FleetBinaryRecord> records(entries.empty() ? 0 : entries.back().channel + std::size_t(1),
+                                           FleetBinaryRecord{});  // 空出的通道为全零的无效记录
+    for (const FleetEntry& entry : entries) {
+        const ValveParameters& p = entry.params;
+        records[entry.channel] = FleetBinaryRecord{entry.zone, 0, p.openPosition.raw(), p.closePosition.raw(),
+                                                   p.moveSpeed.raw()};
+    }
+    std::FILE* out = std::fopen(path.c_str(), "wb");
+    if (!out) {
+        return false;
+    }
+    FleetBinaryHeader header{kFleetMagic, kFleetVersion, records.size()};
+    bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1;
+    ok = ok && std::fwrite(records.data(), sizeof(FleetBinaryRecord), records.size(), out) == records.size();
+    return std::fclose(out) == 0 && ok;
+}
+
+} // namespace valve
@@ -0,0 +1,345 @@
+#include "../include/fleet_state_store.h"  // 包含舰队状态存储定义
+#include "../include/valve_codec.h"        // 包含紧凑编码定义
+#include <chrono>  // 时间和计时支持
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define VALVE_HAVE_X86_SIMD 1  // x86-64平台总是具备SSE2
+#include <emmintrin.h>         // SSE2指令
+#if defined(__GNUC__)
+#include <immintrin.h>         // AVX2指令(按函数启用)
+#define VALVE_HAVE_AVX2 1      // GCC/Clang可按函数开启AVX2
+#define VALVE_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#endif
+#endif
+
+namespace valve {  // 阀门控制系统命名空间
+
+namespace {  // 内部实现细节
+
+using StatusCell = std::atomic<std::uint8_t>;           // 状态列元素
+using TimeCell = std::atomic<FleetStateStore::Timestamp>;  // 变化时间列元素
+
+constexpr auto kRelaxed = std::memory_order_relaxed;
+
+/**
+ * 状态掩码展开后的状态值列表
+ * 向量化比较时逐个状态比较再合并
+ */
+struct StatusSet {
+    std::uint8_t values[FleetStateStore::kStatusCount];  // 掩码中包含的状态值
+    std::size_t count = 0;                               // 状态值个数
+};
+
+StatusSet expandMask(std::uint8_t mask) {
+    StatusSet set;
+    for (std::uint8_t s = 0; s < FleetStateStore::kStatusCount; ++s) {
+        if (mask & (1u << s)) {
+            set.values[set.count++] = s;  // 收集掩码中的状态
+        }
+    }
+    return set;
+}
+
+int popcount32(std::uint32_t v) {
+#if defined(__GNUC__)
+    return __builtin_popcount(v);
+#else
+    v = v - ((v >> 1) & 0x55555555u);
+    v = (v & 0x33333333u) + ((v >> 2) & 0x33333333u);
+    return static_cast<int>((((v + (v >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+#endif
+}
+
+// ---- 标量实现 ----
+
+void histogramScalar(const StatusCell* status, std::size_t begin, std::size_t n,
+                     FleetStateStore::Histogram& counts) {
+    for (std::size_t i = begin; i < n; ++i) {
+        const std::uint8_t s = status[i].load(kRelaxed);
+        if (s < FleetStateStore::kStatusCount) {
+            ++counts[s];  // 逐个累加
+        }
+    }
+}
+
+std::size_t zoneScalar(const StatusCell* status, const std::uint16_t* zone, std::size_t begin,
+                       std::size_t n, std::uint16_t wanted, std::uint8_t mask) {
+    std::size_t count = 0;
+    for (std::size_t i = begin; i < n; ++i) {
+        count += (zone[i] == wanted) & ((mask >> status[i].load(kRelaxed)) & 1u);  // 无分支累加
+    }
+    return count;
+}
+
+std::size_t staleScalar(const TimeCell* ts, std::size_t begin, std::size_t n,
+                        FleetStateStore::Timestamp threshold) {
+    std::size_t count = 0;
+    for (std::size_t i = begin; i < n; ++i) {
+        count += ts[i].load(kRelaxed) < threshold;  // 早于阈值即为陈旧
+    }
+    return count;
+}
+
+// 向量化实现按整块加载原子列的存储：元素是与普通整数布局相同的无锁原子量，
+// x86上对齐的逐元素读取不会撕裂，每个元素读到的都是某次完整写入的值；
+// ThreadSanitizer不把向量加载视为原子读取，检测数据竞争时用setSimdLevel(SCALAR)
+
+#ifdef VALVE_HAVE_X86_SIMD
+// ---- SSE2实现 ----
+
+void histogramSse2(const StatusCell* status, std::size_t n, FleetStateStore::Histogram& counts) {
+    // 比较结果(0或-1)按字节累减到计数器中，每255轮用SAD横向求和一次以防溢出
+    std::size_t i = 0;
+    while (i + 16 <= n) {
+        __m128i acc[FleetStateStore::kStatusCount];
+        for (auto& a : acc) a = _mm_setzero_si128();
+        for (std::size_t round = 0; round < 255 && i + 16 <= n; ++round, i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(status + i));
+            for (std::size_t s = 0; s < FleetStateStore::kStatusCount; ++s) {
+                acc[s] = _mm_sub_epi8(acc[s], _mm_cmpeq_epi8(v, _mm_set1_epi8(static_cast<char>(s))));
+            }
+        }
+        for (std::size_t s = 0; s < FleetStateStore::kStatusCount; ++s) {
+            __m128i sums = _mm_sad_epu8(acc[s], _mm_setzero_si128());
+            counts[s] += static_cast<std::size_t>(_mm_cvtsi128_si32(sums) + _mm_extract_epi16(sums, 4));
+        }
+    }
+    histogramScalar(status, i, n, counts);  // 处理尾部
+}
+
+std::size_t zoneSse2(const StatusCell* status, const std::uint16_t* zone, std::size_t n,
+                     std::uint16_t wanted, std::uint8_t mask) {
+    const StatusSet set = expandMask(mask);
+    const __m128i zoneKey = _mm_set1_epi16(static_cast<short>(wanted));
+    std::size_t count = 0;
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(status + i));
+        __m128i match = _mm_setzero_si128();
+        for (std::size_t k = 0; k < set.count; ++k) {
+            match = _mm_or_si128(match, _mm_cmpeq_epi8(v, _mm_set1_epi8(static_cast<char>(set.values[k]))));
+        }
+        // 区域为16位，分两半比较后压缩成字节掩码
+        __m128i z0 = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(zone + i)), zoneKey);
+        __m128i z1 = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(zone + i + 8)), zoneKey);
+        __m128i zoneMatch = _mm_packs_epi16(z0, z1);
+        std::uint32_t bits = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_and_si128(match, zoneMatch)));
+        count += popcount32(bits);
+    }
+    return count + zoneScalar(status, zone, i, n, wanted, mask);  // 处理尾部
+}
+#endif
+
+#ifdef VALVE_HAVE_AVX2
+// ---- AVX2实现 ----
+
+VALVE_TARGET_AVX2
+void histogramAvx2(const StatusCell* status, std::size_t n, FleetStateStore::Histogram& counts) {
+    // 与SSE2实现相同的字节累加方案，每轮处理32个阀门
+    std::size_t i = 0;
+    while (i + 32 <= n) {
+        __m256i acc[FleetStateStore::kStatusCount];
+        for (auto& a : acc) a = _mm256_setzero_si256();
+        for (std::size_t round = 0; round < 255 && i + 32 <= n; ++round, i += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(status + i));
+            for (std::size_t s = 0; s < FleetStateStore::kStatusCount; ++s) {
+                acc[s] = _mm256_sub_epi8(acc[s], _mm256_cmpeq_epi8(v, _mm256_set1_epi8(static_cast<char>(s))));
+            }
+        }
+        for (std::size_t s = 0; s < FleetStateStore::kStatusCount; ++s) {
+            __m256i sums = _mm256_sad_epu8(acc[s], _mm256_setzero_si256());
+            counts[s] += static_cast<std::size_t>(_mm256_extract_epi64(sums, 0) + _mm256_extract_epi64(sums, 1) +
+                                                  _mm256_extract_epi64(sums, 2) + _mm256_extract_epi64(sums, 3));
+        }
+    }
+    histogramScalar(status, i, n, counts);  // 处理尾部
+}
+
+VALVE_TARGET_AVX2
+std::size_t zoneAvx2(const StatusCell* status, const std::uint16_t* zone, std::size_t n,
+                     std::uint16_t wanted, std::uint8_t mask) {
+    const StatusSet set = expandMask(mask);
+    const __m256i zoneKey = _mm256_set1_epi16(static_cast<short>(wanted));
+    std::size_t count = 0;
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(status + i));
+        __m256i match = _mm256_setzero_si256();
+        for (std::size_t k = 0; k < set.count; ++k) {
+            match = _mm256_or_si256(match, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(static_cast<char>(set.values[k]))));
+        }
+        __m256i z0 = _mm256_cmpeq_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(zone + i)), zoneKey);
+        __m256i z1 = _mm256_cmpeq_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(zone + i + 16)), zoneKey);
+        // packs按128位通道交错，需重排回原始顺序
+        __m256i zoneMatch = _mm256_permute4x64_epi64(_mm256_packs_epi16(z0, z1), 0xD8);
+        std::uint32_t bits = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(match, zoneMatch)));
+        count += _mm_popcnt_u32(bits);
+    }
+    return count + zoneScalar(status, zone, i, n, wanted, mask);  // 处理尾部
+}
+
+VALVE_TARGET_AVX2
+std::size_t staleAvx2(const TimeCell* ts, std::size_t n,
+                      FleetStateStore::Timestamp threshold) {
+    const __m256i key = _mm256_set1_epi64x(threshold);
+    std::size_t count = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ts + i));
+        __m256i older = _mm256_cmpgt_epi64(key, v);  // threshold > ts
+        count += _mm_popcnt_u32(static_cast<std::uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(older))));
+    }
+    return count + staleScalar(ts, i, n, threshold);  // 处理尾部
+}
+#endif
+
+} // namespace
+
+/**
+ * FleetStateStore构造函数
+ * 预留容量并选择当前CPU可用的最高指令集
+ * @param capacity 预留的阀门数量
+ */
+FleetStateStore::FleetStateStore(std::size_t capacity)
+    : simdLevel_(detectSimdLevel()) {
+    status_.reserve(capacity);
+    zone_.reserve(capacity);
+    position_.reserve(capacity);
+    target_.reserve(capacity);
+    lastChange_.reserve(capacity);
+}
+
+/**
+ * 登记一个新阀门
+ * 初始状态为UNKNOWN，与控制器初始状态一致
+ * @param zone 阀门所属区域编号
+ * @return 槽位索引
+ */
+std::uint32_t FleetStateStore::add(std::uint16_t zone) {
+    status_.push_back(static_cast<std::uint8_t>(ValveStatus::UNKNOWN));
+    zone_.push_back(zone);
+    position_.push_back(0);
+    target_.push_back(0);
+    lastChange_.push_back(now());
+    return static_cast<std::uint32_t>(status_.size() - 1);
+}
+
+FleetStateStore::Histogram FleetStateStore::statusHistogram() const {
+    Histogram counts{};
+    const std::size_t n = status_.size();
+    switch (simdLevel_) {
+#ifdef VALVE_HAVE_AVX2
+        case SimdLevel::AVX2:
+            histogramAvx2(status_.data(), n, counts);
+            return counts;
+#endif
+#ifdef VALVE_HAVE_X86_SIMD
+        case SimdLevel::SSE2:
+            histogramSse2(status_.data(), n, counts);
+            return counts;
+#endif
+        default:
+            histogramScalar(status_.data(), 0, n, counts);
+            return counts;
+    }
+}
+
+std::size_t FleetStateStore::countInZone(std::uint16_t zone, std::uint8_t statusMask) const {
+    const std::size_t n = status_.size();
+    switch (simdLevel_) {
+#ifdef VALVE_HAVE_AVX2
+        case SimdLevel::AVX2:
+            return zoneAvx2(status_.data(), zone_.data(), n, zone, statusMask);
+#endif
+#ifdef VALVE_HAVE_X86_SIMD
+        case SimdLevel::SSE2:
+            return zoneSse2(status_.data(), zone_.data(), n, zone, statusMask);
+#endif
+        default:
+            return zoneScalar(status_.data(), zone_.data(), 0, n, zone, statusMask);
+    }
+}
+
+std::size_t FleetStateStore::countStale(Timestamp now, Timestamp maxAge) const {
+    const Timestamp threshold = now - maxAge;  // 早于该时间即为陈旧
+    const std::size_t n = lastChange_.size();
+#ifdef VALVE_HAVE_AVX2
+    if (simdLevel_ == SimdLevel::AVX2) {
+        return staleAvx2(lastChange_.data(), n, threshold);
+    }
+#endif
+    // SSE2没有64位比较指令，使用标量循环
+    return staleScalar(lastChange_.data(), 0, n, threshold);
+}
+
+std::size_t FleetStateStore::collectStale(Timestamp now, Timestamp maxAge,
+                                          std::vector<std::uint32_t>& out) const {
+    const Timestamp threshold = now - maxAge;
+    const std::size_t before = out.size();
+    const std::size_t n = lastChange_.size();
+    for (std::size_t i = 0; i < n; ++i) {
+        if (lastChange_.load(i) < threshold) {
+            out.push_back(static_cast<std::uint32_t>(i));  // 记录陈旧阀门
+        }
+    }
+    return out.size() - before;
+}
+
+/**
+ * 导出全舰队状态位图
+ * @param planes 输出位图
+ */
+void FleetStateStore::exportStatusBitmap(std::vector<std::uint64_t>& planes) const {
+    const std::size_t n = status_.size();
+    std::vector<ValveStatus> status(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        status[i] = static_cast<ValveStatus>(status_.load(i));  // 先取快照再编码
+    }
+    planes.assign(statusBitmapWords(n), 0);
+    encodeStatusBitmap(status.data(), n, planes.data());
+}
+
+/**
+ * 导出区域状态位图
+ * @param zone 区域编号
+ * @param members 输出区域内阀门的槽位索引
+ * @param planes 输出位图
+ */
+void FleetStateStore::exportZoneStatusBitmap(std::uint16_t zone, std::vector<std::uint32_t>& members,
+                                             std::vector<std::uint64_t>& planes) const {
+    members.clear();
+    std::vector<ValveStatus> status;
+    for (std::size_t i = 0; i < zone_.size(); ++i) {
+        if (zone_[i] == zone) {
+            members.push_back(static_cast<std::uint32_t>(i));
+            status.push_back(static_cast<ValveStatus>(status_.load(i)));
+        }
+    }
+    planes.assign(statusBitmapWords(status.size()), 0);
+    encodeStatusBitmap(status.data(), status.size(), planes.data());
+}
+
+void FleetStateStore::setSimdLevel(SimdLevel level) {
+    const SimdLevel best = detectSimdLevel();
+    simdLevel_ = (static_cast<int>(level) > static_cast<int>(best)) ? best : level;  // 不超过CPU能力
+}
+
+FleetStateStore::SimdLevel FleetStateStore::detectSimdLevel() {
+#ifdef VALVE_HAVE_AVX2
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+        return SimdLevel::AVX2;
+    }
+#endif
+#ifdef VALVE_HAVE_X86_SIMD
+    return SimdLevel::SSE2;
+#else
+    return SimdLevel::SCALAR;
+#endif
+}
+
+FleetStateStore::Timestamp FleetStateStore::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace valve
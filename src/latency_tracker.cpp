@@ -0,0 +1,272 @@
+#include "../include/latency_tracker.h"  // 包含移动耗时统计定义
+#include <algorithm>  // 最值支持
+#include <cstdio>     // 格式化输出
+#include <utility>    // pair支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+namespace {
+
+std::atomic<std::uint64_t> nextTrackerId{1};  // 下一个实例编号
+
+const char* phaseName(LatencyPhase phase) {
+    switch (phase) {
+        case LatencyPhase::ACCEPT: return "accept";
+        case LatencyPhase::COMPLETION: return "completion";
+        case LatencyPhase::CALLBACK: return "callback";
+        case LatencyPhase::ERROR: return "error";
+    }
+    return "unknown";
+}
+
+} // namespace
+
+/**
+ * 单个线程的分片
+ * slots只由所属线程写入，读取者按acquire读取指针
+ */
+struct LatencyTracker::Shard {
+    std::array<std::atomic<LatencyHistogram*>, kMaxClasses * kSlotsPerClass> slots{};  // 各组合的直方图
+    std::vector<std::unique_ptr<LatencyHistogram>> owned;                             // 已分配的直方图
+};
+
+/**
+ * 实例的全部分片
+ * 由实例和各线程缓存的弱引用共享，实例先于线程销毁时线程退出不再归还
+ * 归还和取出都经过互斥锁，前一个线程的写入对复用该分片的线程可见
+ */
+struct LatencyTracker::ShardPool {
+    std::mutex mutex;                           // 保护以下字段
+    std::vector<std::unique_ptr<Shard>> shards; // 所有分片
+    std::vector<Shard*> unused;                 // 所属线程已退出的分片
+};
+
+void LatencySnapshot::merge(const LatencyHistogram& histogram) {
+    for (std::size_t i = 0; i < LatencyHistogram::kBuckets; ++i) {
+        buckets[i] += histogram.buckets_[i].load(std::memory_order_relaxed);
+    }
+    count += histogram.count_.load(std::memory_order_relaxed);
+    sum += histogram.sum_.load(std::memory_order_relaxed);
+    min = std::min(min, histogram.min_.load(std::memory_order_relaxed));
+    max = std::max(max, histogram.max_.load(std::memory_order_relaxed));
+}
+
+void LatencySnapshot::merge(const LatencySnapshot& other) {
+    for (std::size_t i = 0; i < LatencyHistogram::kBuckets; ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    sum += other.sum;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+}
+
+/**
+ * 分位数
+ * 按桶累计计数找到分位所在的桶；桶计数与样本数分别读取，以桶计数之和为准
+ */
+std::uint64_t LatencySnapshot::percentile(double quantile) const {
+    std::uint64_t total = 0;
+    for (std::uint64_t c : buckets) {
+        total += c;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    quantile = std::min(1.0, std::max(0.0, quantile));
+    std::uint64_t rank = static_cast<std::uint64_t>(quantile * static_cast<double>(total));
+    if (rank == 0) {
+        rank = 1;
+    }
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            std::uint64_t mid = LatencyHistogram::lowerBound(i) + LatencyHistogram::width(i) / 2;
+            return std::min(mid, max);
+        }
+    }
+    return max;
+}
+
+LatencyTracker::LatencyTracker() : id_(nextTrackerId.fetch_add(1)), shards_(std::make_shared<ShardPool>()) {
+}
+
+LatencyTracker::~LatencyTracker() = default;
+
+std::uint16_t LatencyTracker::defineClass(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::size_t i = 0; i < classes_.size(); ++i) {
+        if (classes_[i] == name) {
+            return static_cast<std::uint16_t>(i);
+        }
+    }
+    if (classes_.size() >= kMaxClasses) {
+        return kNoClass;  // 类别已满
+    }
+    classes_.push_back(name);
+    return static_cast<std::uint16_t>(classes_.size() - 1);
+}
+
+std::uint16_t LatencyTracker::findClass(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::size_t i = 0; i < classes_.size(); ++i) {
+        if (classes_[i] == name) {
+            return static_cast<std::uint16_t>(i);
+        }
+    }
+    return kNoClass;
+}
+
+std::size_t LatencyTracker::classCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return classes_.size();
+}
+
+/**
+ * 获取本线程的分片
+ * 线程缓存按实例编号查找，首次使用时优先复用已退出线程归还的分片，否则登记新分片；
+ * 线程退出时缓存析构，把分片归还仍存在的实例
+ */
+LatencyTracker::Shard& LatencyTracker::localShard() {
+    // 最近使用的实例用平凡类型保存，快速路径不经过线程局部对象的初始化检查
+    thread_local std::uint64_t lastId = 0;
+    thread_local Shard* lastShard = nullptr;
+    if (lastId == id_) {
+        return *lastShard;
+    }
+    struct Entry {
+        std::uint64_t id;                // 实例编号
+        Shard* shard;                    // 本线程在该实例中的分片
+        std::weak_ptr<ShardPool> pool;   // 该实例的分片池
+    };
+    struct Cache {
+        std::vector<Entry> entries;      // 本线程用过的实例及其分片
+        ~Cache() {
+            for (Entry& entry : entries) {
+                if (auto pool = entry.pool.lock()) {
+                    std::lock_guard<std::mutex> lock(pool->mutex);
+                    pool->unused.push_back(entry.shard);  // 归还，样本保留
+                }
+            }
+        }
+    };
+    thread_local Cache cache;
+    for (const Entry& entry : cache.entries) {
+        if (entry.id == id_) {
+            lastId = entry.id;
+            lastShard = entry.shard;
+            return *entry.shard;
+        }
+    }
+    Shard* shard;
+    {
+        std::lock_guard<std::mutex> lock(shards_->mutex);
+        if (!shards_->unused.empty()) {
+            shard = shards_->unused.back();
+            shards_->unused.pop_back();
+        } else {
+            shards_->shards.push_back(std::make_unique<Shard>());
+            shard = shards_->shards.back().get();
+        }
+    }
+    cache.entries.push_back(Entry{id_, shard, shards_});
+    lastId = id_;
+    lastShard = shard;
+    return *shard;
+}
+
+void LatencyTracker::record(std::uint16_t valveClass, ValveCommand command, LatencyPhase phase, std::uint64_t ns) {
+    if (valveClass >= kMaxClasses) {
+        return;
+    }
+    histogramOf(localShard(), slotOf(valveClass, command, phase)).record(ns);
+}
+
+void LatencyTracker::recordMove(std::uint16_t valveClass, ValveCommand command, std::uint64_t acceptNs,
+                                std::uint64_t completionNs, std::uint64_t callbackNs) {
+    if (valveClass >= kMaxClasses) {
+        return;
+    }
+    Shard& shard = localShard();
+    const std::size_t base = slotOf(valveClass, command, LatencyPhase::ACCEPT);
+    histogramOf(shard, base).record(acceptNs);
+    histogramOf(shard, base + 1).record(completionNs);
+    histogramOf(shard, base + 2).record(callbackNs);
+}
+
+/**
+ * 获取本线程某个组合的直方图
+ * 首次使用时分配并发布给读取者
+ */
+LatencyHistogram& LatencyTracker::histogramOf(Shard& shard, std::size_t slot) {
+    LatencyHistogram* histogram = shard.slots[slot].load(std::memory_order_relaxed);
+    if (!histogram) {
+        shard.owned.push_back(std::make_unique<LatencyHistogram>());
+        histogram = shard.owned.back().get();
+        shard.slots[slot].store(histogram, std::memory_order_release);  // 发布给读取者
+    }
+    return *histogram;
+}
+
+LatencySnapshot LatencyTracker::snapshot(std::uint16_t valveClass, ValveCommand command, LatencyPhase phase) const {
+    LatencySnapshot result;
+    if (valveClass >= kMaxClasses) {
+        return result;
+    }
+    const std::size_t slot = slotOf(valveClass, command, phase);
+    std::lock_guard<std::mutex> lock(shards_->mutex);
+    for (const auto& shard : shards_->shards) {
+        const LatencyHistogram* histogram = shard->slots[slot].load(std::memory_order_acquire);
+        if (histogram) {
+            result.merge(*histogram);
+        }
+    }
+    return result;
+}
+
+/**
+ * 导出文本
+ * 格式：valve_latency_ns{class="...",command="open",phase="accept",stat="p99"} 值
+ */
+std::string LatencyTracker::exportText() const {
+    std::vector<std::string> classes;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        classes = classes_;
+    }
+    static const ValveCommand kCommands[] = {ValveCommand::OPEN, ValveCommand::CLOSE};
+    static const LatencyPhase kPhases[] = {LatencyPhase::ACCEPT, LatencyPhase::COMPLETION, LatencyPhase::CALLBACK,
+                                           LatencyPhase::ERROR};
+    static const std::pair<const char*, double> kQuantiles[] = {
+        {"p50", 0.5}, {"p90", 0.9}, {"p99", 0.99}, {"p999", 0.999}};
+
+    std::string text;
+    char line[256];
+    for (std::size_t c = 0; c < classes.size(); ++c) {
+        for (ValveCommand command : kCommands) {
+            for (LatencyPhase phase : kPhases) {
+                LatencySnapshot s = snapshot(static_cast<std::uint16_t>(c), command, phase);
+                if (s.count == 0) {
+                    continue;
+                }
+                const char* direction = command == ValveCommand::OPEN ? "open" : "close";
+                auto emit = [&](const char* stat, double value) {
+                    std::snprintf(line, sizeof(line),
+                                  "valve_latency_ns{class=\"%s\",command=\"%s\",phase=\"%s\",stat=\"%s\"} %.0f\n",
+                                  classes[c].c_str(), direction, phaseName(phase), stat, value);
+                    text += line;
+                };
+                emit("count", static_cast<double>(s.count));
+                emit("mean", s.mean());
+                for (const auto& q : kQuantiles) {
+                    emit(q.first, static_cast<double>(s.percentile(q.second)));
+                }
+                emit("max", static_cast<double>(s.max));
+            }
+        }
+    }
+    return text;
+}
+
+} // namespace valve
@@ -0,0 +1,421 @@
+#include "../include/sharded_runtime.h"     // 包含分片运行时定义
+#include "../include/valve_controller.h"    // 包含控制器定义
+#include <algorithm>  // 堆操作支持
+#include <limits>     // 数值极限
+
+#ifdef __linux__
+#include <pthread.h>  // 线程绑定核心
+#include <sched.h>    // CPU集合
+#endif
+
+namespace valve {  // 阀门控制系统命名空间
+
+namespace {
+
+constexpr std::chrono::milliseconds kIdleWait(1);  // 空闲线程重新尝试窃取的间隔
+constexpr std::int64_t kNoDeadline = std::numeric_limits<std::int64_t>::max();  // 没有定时器
+
+/**
+ * 当前单调时钟时间(纳秒)
+ */
+std::int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * 未到期的定时器
+ */
+struct PendingTimer {
+    std::int64_t deadline;  // 到期时间(单调时钟纳秒)
+    ValveEvent event;       // 到期时提交的事件
+};
+
+/**
+ * 最小堆比较：到期早的在堆顶
+ */
+struct LaterDeadline {
+    bool operator()(const PendingTimer& a, const PendingTimer& b) const { return a.deadline > b.deadline; }
+};
+
+} // namespace
+
+/**
+ * 分片
+ * 独占缓存行，避免相邻分片的锁互相干扰
+ */
+struct alignas(64) ShardedRuntime::Shard {
+    std::mutex mutex;                 // 保护以下成员
+    std::vector<ValveEvent> pending;  // 待处理事件，按提交顺序
+    bool scheduled = false;           // 是否已在某个就绪队列中或正被处理
+};
+
+/**
+ * 工作线程
+ */
+struct alignas(64) ShardedRuntime::Worker {
+    std::size_t index = 0;                            // 线程编号
+    std::mutex mutex;                                 // 保护就绪队列、定时器和休眠标志
+    std::condition_variable wake;                     // 有新分片就绪或需要停止时通知
+    std::deque<std::size_t> ready;                    // 就绪分片，本线程从头部取，窃取者从尾部取
+    std::vector<PendingTimer> timers;                 // 定时器最小堆
+    std::atomic<std::int64_t> nextDeadline{kNoDeadline};  // 最早的定时器到期时间
+    bool sleeping = false;                            // 是否正在休眠
+    std::vector<ValveEvent> batch;                    // 正在处理的事件批，复用内存
+    std::thread thread;                               // 线程对象
+
+    std::atomic<std::uint64_t> processed{0};  // 处理的事件数
+    std::atomic<std::uint64_t> batches{0};    // 批处理次数
+    std::atomic<std::uint64_t> steals{0};     // 窃取的分片数
+    std::atomic<std::uint64_t> fired{0};      // 到期的定时器数
+};
+
+/**
+ * ShardedRuntime构造函数
+ * 分片数不超过阀门数，每个分片至少一个阀门
+ */
+ShardedRuntime::ShardedRuntime(std::vector<ValveController*> fleet, const RuntimeOptions& options)
+    : fleet_(std::move(fleet)), pinWorkers_(options.pinWorkers) {
+    workerCount_ = options.workers;
+    if (workerCount_ == 0) {
+        workerCount_ = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+    std::size_t shards = options.shards == 0 ? workerCount_ * 16 : options.shards;
+    shards = std::max<std::size_t>(1, std::min(shards, fleet_.size()));
+    shardSize_ = std::max<std::size_t>(1, (fleet_.size() + shards - 1) / shards);
+    shardCount_ = std::max<std::size_t>(1, (fleet_.size() + shardSize_ - 1) / shardSize_);
+
+    shards_.reset(new Shard[shardCount_]);
+    workers_.reset(new Worker[workerCount_]);
+    for (std::size_t i = 0; i < workerCount_; ++i) {
+        workers_[i].index = i;
+    }
+}
+
+ShardedRuntime::~ShardedRuntime() {
+    stop();
+}
+
+/**
+ * 启动工作线程
+ */
+void ShardedRuntime::start() {
+    if (running_.exchange(true)) {
+        return;  // 已启动
+    }
+    stopping_ = false;
+    for (std::size_t i = 0; i < workerCount_; ++i) {
+        workers_[i].thread = std::thread([this, i] { run(i); });
+#ifdef __linux__
+        if (pinWorkers_) {
+            unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(i % cores, &set);
+            pthread_setaffinity_np(workers_[i].thread.native_handle(), sizeof(set), &set);  // 失败时不绑定
+        }
+#endif
+    }
+}
+
+/**
+ * 停止工作线程
+ */
+void ShardedRuntime::stop() {
+    if (!running_.load()) {
+        return;
+    }
+    drain();  // 先处理完已提交的事件
+    stopping_ = true;
+    for (std::size_t i = 0; i < workerCount_; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(workers_[i].mutex);
+        }
+        workers_[i].wake.notify_all();
+    }
+    for (std::size_t i = 0; i < workerCount_; ++i) {
+        if (workers_[i].thread.joinable()) {
+            workers_[i].thread.join();
+        }
+        std::lock_guard<std::mutex> lock(workers_[i].mutex);
+        workers_[i].timers.clear();  // 丢弃未到期的定时器
+        workers_[i].nextDeadline = kNoDeadline;
+    }
+    running_ = false;
+}
+
+bool ShardedRuntime::command(std::uint32_t valve, ValveCommand command) {
+    if (command == ValveCommand::NONE) {
+        return false;
+    }
+    ValveEvent event{valve, ValveEventKind::COMMAND};
+    event.command = command;
+    return post(event);
+}
+
+bool ShardedRuntime::complete(std::uint32_t valve, ValveStatus status) {
+    ValveEvent event{valve, ValveEventKind::COMPLETION};
+    event.status = status;
+    return post(event);
+}
+
+/**
+ * 设置定时器
+ * 定时器由该阀门所在分片的归属线程管理
+ */
+bool ShardedRuntime::scheduleTimer(std::uint32_t valve, std::chrono::nanoseconds delay, std::uint64_t tag) {
+    if (valve >= fleet_.size() || stopping_.load()) {
+        return false;
+    }
+    ValveEvent event{valve, ValveEventKind::TIMER};
+    event.tag = tag;
+    PendingTimer timer{nowNs() + delay.count(), event};
+
+    Worker& worker = workers_[shardOf(valve) % workerCount_];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.timers.push_back(timer);
+        std::push_heap(worker.timers.begin(), worker.timers.end(), LaterDeadline());
+        worker.nextDeadline = worker.timers.front().deadline;
+    }
+    worker.wake.notify_one();  // 休眠中的线程需要按新的到期时间等待
+    return true;
+}
+
+/**
+ * 等待已提交的事件全部处理完
+ */
+void ShardedRuntime::drain() {
+    std::unique_lock<std::mutex> lock(drainMutex_);
+    drained_.wait(lock, [this] { return pending_.load(std::memory_order_acquire) == 0; });
+}
+
+RuntimeStats ShardedRuntime::stats() const {
+    RuntimeStats result;
+    for (std::size_t i = 0; i < workerCount_; ++i) {
+        result.processed.push_back(workers_[i].processed.load(std::memory_order_relaxed));
+        result.batches += workers_[i].batches.load(std::memory_order_relaxed);
+        result.steals += workers_[i].steals.load(std::memory_order_relaxed);
+        result.timers += workers_[i].fired.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+/**
+ * 把事件加入所属分片
+ * 分片原本空闲时交给归属线程调度
+ */
+bool ShardedRuntime::post(const ValveEvent& event) {
+    if (event.valve >= fleet_.size() || stopping_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    std::size_t index = shardOf(event.valve);
+    Shard& shard = shards_[index];
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    bool idle;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.pending.push_back(event);
+        idle = !shard.scheduled;
+        shard.scheduled = true;
+    }
+    if (idle) {
+        schedule(index);
+    }
+    return true;
+}
+
+/**
+ * 把分片放入归属线程的就绪队列
+ * 归属线程忙碌或已有积压时唤醒一个空闲线程来窃取
+ */
+void ShardedRuntime::schedule(std::size_t shard) {
+    Worker& worker = workers_[shard % workerCount_];
+    bool backlog;
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.ready.push_back(shard);
+        backlog = !worker.sleeping || worker.ready.size() > 1;
+    }
+    worker.wake.notify_one();
+    if (backlog && idleWorkers_.load(std::memory_order_relaxed) > 0) {
+        wakeIdle(worker.index);
+    }
+}
+
+/**
+ * 唤醒一个正在休眠的其他线程
+ */
+void ShardedRuntime::wakeIdle(std::size_t except) {
+    for (std::size_t i = 1; i < workerCount_; ++i) {
+        Worker& worker = workers_[(except + i) % workerCount_];
+        bool sleeping;
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            sleeping = worker.sleeping;
+        }
+        if (sleeping) {
+            worker.wake.notify_one();
+            return;
+        }
+    }
+}
+
+/**
+ * 工作线程主循环
+ * 依次处理到期定时器、本地就绪分片、窃取的分片，都没有时休眠
+ */
+void ShardedRuntime::run(std::size_t index) {
+    Worker& worker = workers_[index];
+    for (;;) {
+        fireTimers(worker);
+        std::size_t shard;
+        if (takeLocal(worker, shard) || steal(index, shard)) {
+            runShard(worker, shard);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(worker.mutex);
+        if (!worker.ready.empty()) {
+            continue;  // 检查期间有新分片就绪
+        }
+        if (stopping_.load()) {
+            break;
+        }
+        auto until = std::chrono::steady_clock::now() + kIdleWait;
+        std::int64_t deadline = worker.nextDeadline.load(std::memory_order_relaxed);
+        if (deadline != kNoDeadline) {
+            auto timerAt = std::chrono::steady_clock::time_point(std::chrono::nanoseconds(deadline));
+            until = std::min(until, timerAt);
+        }
+        worker.sleeping = true;
+        idleWorkers_.fetch_add(1, std::memory_order_relaxed);
+        worker.wake.wait_until(lock, until);  // 超时后重新尝试窃取
+        idleWorkers_.fetch_sub(1, std::memory_order_relaxed);
+        worker.sleeping = false;
+    }
+}
+
+bool ShardedRuntime::takeLocal(Worker& worker, std::size_t& shard) {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.ready.empty()) {
+        return false;
+    }
+    shard = worker.ready.front();
+    worker.ready.pop_front();
+    return true;
+}
+
+/**
+ * 从其他线程的就绪队列尾部窃取一个分片
+ * 整个分片一起迁移，分片内的事件顺序不变
+ */
+bool ShardedRuntime::steal(std::size_t thief, std::size_t& shard) {
+    for (std::size_t i = 1; i < workerCount_; ++i) {
+        Worker& victim = workers_[(thief + i) % workerCount_];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.ready.empty()) {
+            shard = victim.ready.back();
+            victim.ready.pop_back();
+            workers_[thief].steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * 处理一个分片当前积压的全部事件
+ * 处理期间新到的事件留在分片中，处理完后分片重新排到本线程就绪队列尾部
+ */
+void ShardedRuntime::runShard(Worker& worker, std::size_t index) {
+    Shard& shard = shards_[index];
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        worker.batch.swap(shard.pending);  // 分片得到上一批清空后的缓冲区
+    }
+    for (const ValveEvent& event : worker.batch) {
+        dispatch(event);
+    }
+    const std::uint64_t count = worker.batch.size();
+    worker.batch.clear();
+    worker.processed.fetch_add(count, std::memory_order_relaxed);
+    worker.batches.fetch_add(1, std::memory_order_relaxed);
+
+    bool more;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        more = !shard.pending.empty();
+        if (!more) {
+            shard.scheduled = false;
+        }
+    }
+    if (more) {
+        bool backlog;
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.ready.push_back(index);
+            backlog = worker.ready.size() > 1;
+        }
+        if (backlog && idleWorkers_.load(std::memory_order_relaxed) > 0) {
+            wakeIdle(worker.index);
+        }
+    }
+
+    if (pending_.fetch_sub(count, std::memory_order_acq_rel) == count) {
+        std::lock_guard<std::mutex> lock(drainMutex_);
+        drained_.notify_all();  // 已提交的事件全部处理完
+    }
+}
+
+/**
+ * 把到期的定时器转为事件提交到各自分片
+ */
+void ShardedRuntime::fireTimers(Worker& worker) {
+    if (worker.nextDeadline.load(std::memory_order_relaxed) > nowNs()) {
+        return;  // 常见路径：没有到期的定时器
+    }
+    std::vector<ValveEvent> due;
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        const std::int64_t now = nowNs();
+        while (!worker.timers.empty() && worker.timers.front().deadline <= now) {
+            std::pop_heap(worker.timers.begin(), worker.timers.end(), LaterDeadline());
+            due.push_back(worker.timers.back().event);
+            worker.timers.pop_back();
+        }
+        worker.nextDeadline = worker.timers.empty() ? kNoDeadline : worker.timers.front().deadline;
+    }
+    worker.fired.fetch_add(due.size(), std::memory_order_relaxed);
+    for (const ValveEvent& event : due) {
+        post(event);
+    }
+}
+
+/**
+ * 执行单个事件
+ */
+void ShardedRuntime::dispatch(const ValveEvent& event) {
+    ValveController* controller = fleet_[event.valve];
+    if (controller) {
+        switch (event.kind) {
+            case ValveEventKind::COMMAND:
+                if (event.command == ValveCommand::OPEN) {
+                    controller->open();
+                } else if (event.command == ValveCommand::CLOSE) {
+                    controller->close();
+                }
+                break;
+            case ValveEventKind::COMPLETION:
+                controller->reconcile(event.status);  // 以硬件状态为准
+                break;
+            case ValveEventKind::TIMER:
+                break;  // 只交给事件处理函数
+        }
+    }
+    if (handler_) {
+        handler_(event);
+    }
+}
+
+} // namespace valve
@@ -14,13 +14,17 @@ class SimulatorImpl : public IValveHAL {
 public:
     /**
      * 设置阀门参数
-     * 在模拟器中只是保存参数
+     * 校验参数并预先计算行程时间，移动时不再计算
      * @param params 阀门参数
-     * @return 设置是否成功，模拟器总是返回true
+     * @return 参数是否有效
      */
     bool setParameters(const ValveParameters& params) override {
+        if (validateParameters(params) != ParameterError::NONE) {
+            return false;  // 拒绝无效参数
+        }
         params_ = params;  // 保存参数
-        return true;       // 模拟器总是成功
+        travelTime_ = travelTime(params.closePosition, params.openPosition, params.moveSpeed);
+        return true;
     }
 
     /**
@@ -32,15 +36,20 @@ public:
      */
     bool move(ValveMove target) override {
         // 创建新线程模拟异步操作
-        std::thread([this, target]() {
+        std::thread([this, target, duration = travelTime_]() {
             currentStatus_ = ValveStatus::MOVING;  // 先设置为移动中
             
-            // 模拟移动延迟，等待2秒
-            std::this_thread::sleep_for(std::chrono::seconds(2));
+            // 模拟移动延迟，等待一个全行程时间
+            std::this_thread::sleep_for(duration);
             
             // 根据目标命令设置最终状态
             currentStatus_ = (target == ValveMove::OPEN) ? 
                            ValveStatus::OPENED : ValveStatus::CLOSED;
+
+            // 通知上层动作已完成
+            if (completionCallback_) {
+                completionCallback_(currentStatus_);
+            }
         }).detach();  // 分离线程，允许在后台运行
         
         return true;  // 模拟器总是成功启动操作
@@ -54,9 +63,22 @@ public:
         return currentStatus_;  // 返回当前状态
     }
 
+    /**
+     * 设置动作完成回调
+     * 模拟器在移动线程结束时调用该回调
+     * @param callback 移动结束时调用的回调函数
+     * @return 模拟器总是支持完成通知
+     */
+    bool setCompletionCallback(CompletionCallback callback) override {
+        completionCallback_ = std::move(callback);  // 保存回调函数
+        return true;
+    }
+
 private:
-    ValveParameters params_;  // 保存的阀门参数
+    ValveParameters params_{};  // 保存的阀门参数
+    std::chrono::nanoseconds travelTime_ = std::chrono::seconds(2);  // 全行程时间，未设置参数时为2秒
     ValveStatus currentStatus_ = ValveStatus::UNKNOWN;  // 当前状态，初始为未知
+    CompletionCallback completionCallback_;  // 动作完成回调函数
 };
 
 /**
@@ -0,0 +1,250 @@
+#include "../include/status_notifier.h"  // 包含状态通知分发器定义
+#include <algorithm>  // 查找支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+namespace {  // 内部实现细节
+
+std::int64_t monotonicNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * 待交付通知
+ * 覆盖只更新通知本身，入队时间保持首次入队时的值，交付期限不因覆盖推迟
+ */
+struct Pending {
+    StatusUpdate update;    // 最新状态
+    std::int64_t enqueued;  // 首次入队时间(单调时钟纳秒)
+};
+
+} // namespace
+
+/**
+ * 订阅者
+ * 待交付通知存放在定长环形缓冲中，按入队顺序交付；
+ * 按阀门去重：position记录每个阀门所在的环形槽位(加1)，0表示未排队，
+ * 取出一批只清除这一批阀门的位置，其余通知的槽位不变
+ */
+struct StatusNotifier::Subscriber {
+    std::size_t id = 0;                       // 订阅者标识
+    BatchCallback callback;                   // 批量通知回调
+    SubscriberOptions options;                // 订阅配置
+    std::mutex mutex;                         // 保护以下所有字段
+    std::condition_variable wake;             // 唤醒交付线程
+    std::condition_variable idle;             // 通知队列已清空
+    std::vector<Pending> ring;                // 待交付通知环形缓冲，容量为options.capacity
+    std::size_t head = 0;                     // 最早的待交付通知所在槽位
+    std::size_t count = 0;                    // 待交付通知数
+    std::vector<std::uint32_t> position;      // 阀门所在槽位(加1)，按阀门数预先分配
+    std::size_t flushers = 0;                 // 正在等待清空的调用者数
+    bool delivering = false;                  // 是否正在执行回调
+    bool running = true;                      // 交付线程是否运行
+    SubscriberStats stats;                    // 统计数据
+    std::thread worker;                       // 交付线程
+
+    void run();
+    void stop();
+};
+
+/**
+ * 交付线程主循环
+ * 有通知时等到批次已满、最长等待时间已到或有调用者请求清空，
+ * 然后在锁外调用回调
+ */
+void StatusNotifier::Subscriber::run() {
+    std::vector<StatusUpdate> batch;
+    batch.reserve(options.maxBatch);
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return !running || count > 0; });
+        if (!running) {
+            break;
+        }
+        // 期限以最早入队的通知为准，其后入队的通知期限不早于它
+        auto deadline = std::chrono::steady_clock::time_point(std::chrono::nanoseconds(ring[head].enqueued)) +
+                        options.maxLatency;
+        wake.wait_until(lock, deadline, [this] {
+            return !running || flushers > 0 || count >= options.maxBatch;
+        });
+        if (!running) {
+            break;
+        }
+
+        // 从环形头部取出一批，代价与批次大小成正比
+        const std::size_t n = std::min(count, options.maxBatch);
+        batch.clear();
+        for (std::size_t i = 0; i < n; ++i) {
+            const StatusUpdate& update = ring[head].update;
+            position[update.valve] = 0;
+            batch.push_back(update);
+            head = (head + 1 == ring.size()) ? 0 : head + 1;
+        }
+        count -= n;
+
+        delivering = true;
+        lock.unlock();
+        callback(batch);
+        lock.lock();
+        delivering = false;
+        stats.delivered += n;
+        ++stats.batches;
+        if (count == 0) {
+            idle.notify_all();
+        }
+    }
+    idle.notify_all();  // 停止时释放等待清空的调用者
+}
+
+void StatusNotifier::Subscriber::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+/**
+ * StatusNotifier构造函数
+ * @param valveCount 阀门数量
+ */
+StatusNotifier::StatusNotifier(std::size_t valveCount) : valveCount_(valveCount) {
+}
+
+/**
+ * StatusNotifier析构函数
+ * 停止所有交付线程，未交付的通知被丢弃
+ */
+StatusNotifier::~StatusNotifier() {
+    for (auto& subscriber : subscribers_) {
+        subscriber->stop();
+    }
+}
+
+/**
+ * 添加订阅者
+ * @param callback 批量通知回调
+ * @param options 订阅配置
+ * @return 订阅者标识
+ */
+std::size_t StatusNotifier::subscribe(BatchCallback callback, const SubscriberOptions& options) {
+    auto subscriber = std::make_unique<Subscriber>();
+    subscriber->callback = std::move(callback);
+    subscriber->options = options;
+    if (subscriber->options.maxBatch == 0) {
+        subscriber->options.maxBatch = 1;  // 至少逐条交付
+    }
+    if (subscriber->options.capacity == 0) {
+        subscriber->options.capacity = 1;
+    }
+    subscriber->ring.resize(subscriber->options.capacity);
+    subscriber->position.assign(valveCount_, 0);
+    Subscriber* raw = subscriber.get();
+    raw->worker = std::thread([raw] { raw->run(); });
+
+    std::unique_lock<std::shared_mutex> lock(subscribersMutex_);
+    raw->id = nextId_++;
+    subscribers_.push_back(std::move(subscriber));
+    return raw->id;
+}
+
+/**
+ * 移除订阅者
+ * 不能在该订阅者自己的回调中调用
+ * @param id subscribe返回的标识
+ */
+void StatusNotifier::unsubscribe(std::size_t id) {
+    std::unique_ptr<Subscriber> removed;
+    {
+        std::unique_lock<std::shared_mutex> lock(subscribersMutex_);
+        auto it = std::find_if(subscribers_.begin(), subscribers_.end(),
+                               [id](const std::unique_ptr<Subscriber>& s) { return s->id == id; });
+        if (it == subscribers_.end()) {
+            return;
+        }
+        removed = std::move(*it);
+        subscribers_.erase(it);
+    }
+    removed->stop();  // 在列表锁外等待交付线程退出
+}
+
+/**
+ * 发布状态变化
+ * 同一阀门已在队列中时只更新其状态，入队时间不变；队列满或阀门编号超出范围时丢弃
+ * @param valve 阀门编号
+ * @param status 新的阀门状态
+ */
+void StatusNotifier::publish(std::uint32_t valve, ValveStatus status) {
+    const std::int64_t now = monotonicNs();
+    std::shared_lock<std::shared_mutex> listLock(subscribersMutex_);
+    for (auto& subscriber : subscribers_) {
+        Subscriber& s = *subscriber;
+        bool notify = false;
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            ++s.stats.published;
+            std::uint32_t at = (valve < s.position.size()) ? s.position[valve] : 0;
+            if (at != 0) {
+                s.ring[at - 1].update.status = status;  // 只保留最新状态，入队时间不变
+                s.ring[at - 1].update.timestamp = now;
+                ++s.stats.coalesced;
+            } else if (s.count >= s.ring.size() || valve >= s.position.size()) {
+                ++s.stats.dropped;  // 订阅者跟不上或编号超出范围，丢弃
+            } else {
+                std::size_t slot = s.head + s.count;
+                if (slot >= s.ring.size()) {
+                    slot -= s.ring.size();
+                }
+                s.ring[slot] = Pending{StatusUpdate{valve, status, now}, now};
+                s.position[valve] = static_cast<std::uint32_t>(slot + 1);
+                ++s.count;
+                if (s.count == 1) {
+                    notify = true;  // 开始计时
+                } else if (s.count == s.options.maxBatch) {
+                    notify = true;  // 批次已满
+                }
+            }
+        }
+        if (notify) {
+            s.wake.notify_one();
+        }
+    }
+}
+
+/**
+ * 等待所有已发布的通知交付完成
+ * 不能在订阅者回调中调用
+ */
+void StatusNotifier::flush() {
+    std::shared_lock<std::shared_mutex> listLock(subscribersMutex_);
+    for (auto& subscriber : subscribers_) {
+        Subscriber& s = *subscriber;
+        std::unique_lock<std::mutex> lock(s.mutex);
+        ++s.flushers;
+        s.wake.notify_one();
+        s.idle.wait(lock, [&s] { return !s.running || (s.count == 0 && !s.delivering); });
+        --s.flushers;
+    }
+}
+
+/**
+ * 获取订阅者统计
+ * @param id 订阅者标识
+ * @return 统计数据
+ */
+SubscriberStats StatusNotifier::stats(std::size_t id) const {
+    std::shared_lock<std::shared_mutex> listLock(subscribersMutex_);
+    for (const auto& subscriber : subscribers_) {
+        if (subscriber->id == id) {
+            std::lock_guard<std::mutex> lock(subscriber->mutex);
+            return subscriber->stats;
+        }
+    }
+    return SubscriberStats();
+}
+
+} // namespace valve
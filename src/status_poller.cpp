@@ -0,0 +1,275 @@
+#include "../include/status_poller.h"  // 包含状态轮询器定义
+#include <algorithm>  // 排序和堆操作支持
+#include <utility>    // pair支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+namespace {
+
+/**
+ * 当前单调时钟时间(纳秒)
+ */
+std::int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * 最小堆比较：轮询时间早的在堆顶
+ */
+struct LaterPoll {
+    template <typename Due>
+    bool operator()(const Due& a, const Due& b) const { return a.at > b.at; }
+};
+
+} // namespace
+
+/**
+ * StatusPoller构造函数
+ * @param handler 完成处理函数
+ * @param options 轮询配置
+ */
+StatusPoller::StatusPoller(CompletionHandler handler, const PollerOptions& options)
+    : handler_(std::move(handler)), options_(options) {
+}
+
+StatusPoller::~StatusPoller() {
+    stop();
+}
+
+void StatusPoller::addValve(std::uint32_t valve, const IValveHAL& hal) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (valve >= valves_.size()) {
+        valves_.resize(valve + 1);
+    }
+    valves_[valve].hal = &hal;
+}
+
+void StatusPoller::setBulkSource(const IBulkValveHAL& bus, std::uint32_t firstValve) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bulk_ = &bus;
+    bulkFirst_ = firstValve;
+}
+
+/**
+ * 开始跟踪一次移动
+ * 第一次轮询安排在预计完成时刻之前maxBackoff处(不晚于最长间隔)
+ */
+void StatusPoller::expect(std::uint32_t valve, ValveMove target, std::chrono::nanoseconds travelTime) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (valve >= valves_.size()) {
+        valves_.resize(valve + 1);
+    }
+    Tracked& tracked = valves_[valve];
+    if (!tracked.active) {
+        ++inflight_;
+    }
+    tracked.active = true;
+    ++tracked.generation;  // 旧的轮询计划失效
+    tracked.started = nowNs();
+    tracked.travel = travelTime.count() > 0 ? travelTime.count() : options_.defaultTravel.count();
+    tracked.interval = std::chrono::duration_cast<std::chrono::nanoseconds>(options_.minInterval).count();
+    tracked.expected = (target == ValveMove::OPEN) ? ValveStatus::OPENED : ValveStatus::CLOSED;
+    schedule(valve, tracked, tracked.started);
+    if (plan_.front().valve == valve) {
+        wake_.notify_one();  // 新计划最早，轮询线程需要提前醒来
+    }
+}
+
+void StatusPoller::cancel(std::uint32_t valve) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (valve < valves_.size() && valves_[valve].active) {
+        valves_[valve].active = false;
+        ++valves_[valve].generation;
+        --inflight_;
+    }
+}
+
+void StatusPoller::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (thread_.joinable()) {
+        return;  // 已启动
+    }
+    stopping_ = false;
+    thread_ = std::thread([this] { run(); });
+}
+
+void StatusPoller::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+std::size_t StatusPoller::inflight() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return inflight_;
+}
+
+PollerStats StatusPoller::stats() const {
+    PollerStats result;
+    result.transactions = transactions_.load(std::memory_order_relaxed);
+    result.channelsRead = channelsRead_.load(std::memory_order_relaxed);
+    result.completions = completions_.load(std::memory_order_relaxed);
+    result.timeouts = timeouts_.load(std::memory_order_relaxed);
+    return result;
+}
+
+/**
+ * 安排下一次轮询
+ * 预计完成前先等到预计完成时刻之前maxBackoff处(每次不超过最长间隔)，
+ * 再以逐次减半的间隔逼近预计完成时刻；超过预计时间后从最短间隔开始每次加倍，
+ * 直到最长退避间隔。提前或逾期不超过maxBackoff的完成都能在很短时间内检测到
+ * 调用者须持有mutex_
+ */
+void StatusPoller::schedule(std::uint32_t valve, Tracked& tracked, std::int64_t now) {
+    const std::int64_t maxInterval = std::chrono::duration_cast<std::chrono::nanoseconds>(options_.maxInterval).count();
+    const std::int64_t maxBackoff = std::chrono::duration_cast<std::chrono::nanoseconds>(options_.maxBackoff).count();
+    const std::int64_t remaining = tracked.started + tracked.travel - now;
+    const std::int64_t minInterval = std::chrono::duration_cast<std::chrono::nanoseconds>(options_.minInterval).count();
+    std::int64_t delay;
+    if (remaining > maxBackoff) {
+        delay = std::min(remaining - maxBackoff, maxInterval);  // 先等到预计完成前maxBackoff
+    } else if (remaining > 0) {
+        delay = std::max(remaining / 2, std::min(remaining, minInterval));  // 逐次减半逼近预计完成时刻
+    } else {
+        delay = tracked.interval;
+        tracked.interval = std::min(tracked.interval * 2, maxBackoff);  // 指数退避
+    }
+    plan_.push_back(Due{now + delay, valve, tracked.generation});
+    std::push_heap(plan_.begin(), plan_.end(), LaterPoll());
+}
+
+bool StatusPoller::inBulk(std::uint32_t valve) const {
+    return bulk_ && valve >= bulkFirst_ && valve - bulkFirst_ < bulk_->channelCount();
+}
+
+/**
+ * 读取一组阀门的状态
+ * valves须按编号升序；批量数据源覆盖的阀门按相邻通道合并读取，
+ * 其余阀门逐个读取，没有硬件的阀门结果为UNKNOWN
+ * @param valves 阀门编号
+ * @param hals 与valves一一对应的单阀门硬件
+ * @param out 与valves一一对应的状态
+ */
+void StatusPoller::read(const std::vector<std::uint32_t>& valves, const std::vector<const IValveHAL*>& hals,
+                        std::vector<ValveStatus>& out) {
+    out.assign(valves.size(), ValveStatus::UNKNOWN);
+    std::vector<ValveStatus> span;
+    std::size_t i = 0;
+    while (i < valves.size()) {
+        if (!inBulk(valves[i])) {
+            const IValveHAL* hal = hals[i];
+            if (hal) {
+                out[i] = hal->getStatus();
+                transactions_.fetch_add(1, std::memory_order_relaxed);
+                channelsRead_.fetch_add(1, std::memory_order_relaxed);
+            }
+            ++i;
+            continue;
+        }
+        // 合并相距不超过mergeGap的通道为一次批量读取
+        std::size_t last = i;
+        while (last + 1 < valves.size() && inBulk(valves[last + 1]) &&
+               valves[last + 1] - valves[last] <= options_.mergeGap) {
+            ++last;
+        }
+        const std::uint32_t first = valves[i];
+        const std::size_t count = valves[last] - first + 1;
+        span.resize(count);
+        bulk_->readStatus(first - bulkFirst_, count, span.data());
+        transactions_.fetch_add(1, std::memory_order_relaxed);
+        channelsRead_.fetch_add(count, std::memory_order_relaxed);
+        for (; i <= last; ++i) {
+            out[i] = span[valves[i] - first];
+        }
+    }
+}
+
+/**
+ * 轮询线程主循环
+ * 取出所有到期的计划，释放锁后读取状态，再按结果结束跟踪或安排下一次轮询
+ */
+void StatusPoller::run() {
+    std::vector<std::uint32_t> due;
+    std::vector<std::uint32_t> generations;
+    std::vector<const IValveHAL*> hals;
+    std::vector<ValveStatus> statuses;
+    std::vector<std::pair<std::uint32_t, ValveStatus>> finished;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        if (plan_.empty()) {
+            wake_.wait(lock);
+            continue;
+        }
+        std::int64_t now = nowNs();
+        if (plan_.front().at > now) {
+            wake_.wait_until(lock, std::chrono::steady_clock::time_point(std::chrono::nanoseconds(plan_.front().at)));
+            continue;
+        }
+
+        due.clear();
+        while (!plan_.empty() && plan_.front().at <= now) {
+            std::pop_heap(plan_.begin(), plan_.end(), LaterPoll());
+            Due entry = plan_.back();
+            plan_.pop_back();
+            const Tracked& tracked = valves_[entry.valve];
+            if (tracked.active && tracked.generation == entry.generation) {
+                due.push_back(entry.valve);  // 跳过已完成或被替换的计划
+            }
+        }
+        if (due.empty()) {
+            continue;
+        }
+        std::sort(due.begin(), due.end());
+        due.erase(std::unique(due.begin(), due.end()), due.end());
+        generations.clear();
+        hals.clear();
+        for (std::uint32_t valve : due) {
+            generations.push_back(valves_[valve].generation);
+            hals.push_back(valves_[valve].hal);
+        }
+
+        lock.unlock();
+        read(due, hals, statuses);  // 读取总线时不阻塞expect()
+        lock.lock();
+
+        now = nowNs();
+        finished.clear();
+        for (std::size_t i = 0; i < due.size(); ++i) {
+            Tracked& tracked = valves_[due[i]];
+            if (!tracked.active || tracked.generation != generations[i]) {
+                continue;
+            }
+            const ValveStatus status = statuses[i];
+            if (status == tracked.expected || status == ValveStatus::ERROR) {
+                finished.emplace_back(due[i], status);
+                completions_.fetch_add(1, std::memory_order_relaxed);
+            } else if (options_.timeoutFactor > 0 &&
+                       now - tracked.started > static_cast<std::int64_t>(tracked.travel * options_.timeoutFactor)) {
+                finished.emplace_back(due[i], ValveStatus::ERROR);  // 超时按错误结束
+                timeouts_.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                schedule(due[i], tracked, now);
+                continue;
+            }
+            tracked.active = false;
+            --inflight_;
+        }
+
+        if (!finished.empty() && handler_) {
+            lock.unlock();
+            for (const auto& entry : finished) {
+                handler_(entry.first, entry.second);
+            }
+            lock.lock();
+        }
+    }
+}
+
+} // namespace valve
@@ -0,0 +1,106 @@
+#include "../include/valve_codec.h"  // 包含紧凑编码定义
+#include <cstring>  // 内存操作
+
+namespace valve {  // 阀门控制系统命名空间
+
+namespace {  // 内部实现细节
+
+constexpr std::uint64_t kLowBits = 0x0101010101010101ull;   // 每个字节的最低位
+constexpr std::uint64_t kGather = 0x0102040810204080ull;    // 把8个字节的最低位收集到最高字节
+
+/**
+ * 字节展开表：第i个字节等于输入的第i位
+ */
+struct SpreadTable {
+    std::uint64_t value[256];
+    constexpr SpreadTable() : value() {
+        for (unsigned b = 0; b < 256; ++b) {
+            std::uint64_t x = 0;
+            for (unsigned i = 0; i < 8; ++i) {
+                x |= static_cast<std::uint64_t>((b >> i) & 1u) << (8 * i);
+            }
+            value[b] = x;
+        }
+    }
+};
+constexpr SpreadTable kSpread;
+
+/**
+ * 按小端顺序读取8个状态字节，与主机字节序无关
+ */
+inline std::uint64_t load8(const ValveStatus* status, std::size_t n) {
+    std::uint8_t bytes[8] = {};
+    std::memcpy(bytes, status, n);
+    std::uint64_t x = 0;
+    for (unsigned i = 0; i < 8; ++i) {
+        x |= static_cast<std::uint64_t>(bytes[i]) << (8 * i);
+    }
+    return x;
+}
+
+inline void store8(std::uint64_t x, ValveStatus* status, std::size_t n) {
+    std::uint8_t bytes[8];
+    for (unsigned i = 0; i < 8; ++i) {
+        bytes[i] = static_cast<std::uint8_t>(x >> (8 * i));
+    }
+    std::memcpy(status, bytes, n);
+}
+
+} // namespace
+
+/**
+ * 批量编码状态位图
+ * @param status 状态数组
+ * @param count 阀门数量
+ * @param planes 输出位图
+ */
+void encodeStatusBitmap(const ValveStatus* status, std::size_t count, std::uint64_t* planes) {
+    const std::size_t words = statusPlaneWords(count);
+    for (std::size_t w = 0; w < words; ++w) {
+        std::uint64_t plane[kStatusBits] = {};
+        for (unsigned g = 0; g < 8; ++g) {
+            const std::size_t first = w * 64 + g * 8;
+            if (first >= count) {
+                break;
+            }
+            const std::size_t n = count - first < 8 ? count - first : 8;
+            const std::uint64_t x = load8(status + first, n);
+            for (unsigned p = 0; p < kStatusBits; ++p) {
+                const std::uint64_t bits = (((x >> p) & kLowBits) * kGather) >> 56;
+                plane[p] |= bits << (8 * g);
+            }
+        }
+        for (unsigned p = 0; p < kStatusBits; ++p) {
+            planes[p * words + w] = plane[p];
+        }
+    }
+}
+
+/**
+ * 批量解码状态位图
+ * @param planes 位图
+ * @param count 阀门数量
+ * @param status 输出状态数组
+ */
+void decodeStatusBitmap(const std::uint64_t* planes, std::size_t count, ValveStatus* status) {
+    const std::size_t words = statusPlaneWords(count);
+    for (std::size_t w = 0; w < words; ++w) {
+        const std::uint64_t p0 = planes[w];
+        const std::uint64_t p1 = planes[words + w];
+        const std::uint64_t p2 = planes[2 * words + w];
+        for (unsigned g = 0; g < 8; ++g) {
+            const std::size_t first = w * 64 + g * 8;
+            if (first >= count) {
+                break;
+            }
+            const std::size_t n = count - first < 8 ? count - first : 8;
+            const unsigned shift = 8 * g;
+            const std::uint64_t x = kSpread.value[(p0 >> shift) & 0xFF] |
+                                    (kSpread.value[(p1 >> shift) & 0xFF] << 1) |
+                                    (kSpread.value[(p2 >> shift) & 0xFF] << 2);
+            store8(x, status + first, n);
+        }
+    }
+}
+
+} // namespace valve
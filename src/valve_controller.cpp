@@ -1,5 +1,13 @@
 #include "../include/valve_controller.h"  // 包含控制器接口定义
-#include <iostream>  // 标准输入输出流
+#include "../include/fleet_state_store.h"  // 包含舰队状态存储定义
+#include "../include/valve_interlock.h"    // 包含联锁规则引擎定义
+#include "../include/valve_journal.h"      // 包含事件日志定义
+#include "../include/valve_snapshot.h"     // 包含快照记录定义
+#include "../include/status_notifier.h"    // 包含状态通知分发器定义
+#include "../include/status_poller.h"      // 包含状态轮询器定义
+#include "../include/latency_tracker.h"    // 包含移动耗时统计定义
+#include <iostream>   // 标准输入输出流
+#include <stdexcept>  // 标准异常
 
 namespace valve {  // 阀门控制系统命名空间
 
@@ -55,13 +63,41 @@ public:
     bool isClosed() const override { return false; }  // 移动中状态不是关闭的
 };
 
+// 状态对象不含数据，所有控制器共享同一组实例，状态转换不再分配内存
+namespace {
+UnknownState kUnknownState;  // 未知状态实例
+OpenedState kOpenedState;    // 已打开状态实例
+ClosedState kClosedState;    // 已关闭状态实例
+MovingState kMovingState;    // 移动中状态实例
+
+/**
+ * 取得要接管的驱动层，不能在委托构造中直接解引用空指针
+ */
+IValveDriver& requireDriver(const std::unique_ptr<IValveDriver>& driver) {
+    if (!driver) {
+        throw std::invalid_argument("ValveController: driver must not be null");
+    }
+    return *driver;
+}
+} // namespace
+
 /**
  * ValveController构造函数
  * 初始化控制器，设置初始状态和回调
- * @param driver 驱动层接口的智能指针
+ * @param driver 驱动层接口的智能指针，为空时抛出std::invalid_argument
  */
 ValveController::ValveController(std::unique_ptr<IValveDriver> driver)
-    : driver_(std::move(driver)), currentState_(std::make_unique<UnknownState>()) {
+    : ValveController(requireDriver(driver)) {
+    ownedDriver_ = std::move(driver);  // 接管驱动层的所有权
+}
+
+/**
+ * ValveController构造函数
+ * 不接管驱动层的所有权，用于在对象区中与驱动层相邻存放
+ * @param driver 驱动层接口，生命周期必须长于控制器
+ */
+ValveController::ValveController(IValveDriver& driver)
+    : driver_(&driver), currentState_(&kUnknownState) {
     // 设置驱动层状态回调，使用lambda捕获this指针
     driver_->setStatusCallback([this](ValveStatus status) {
         handleStatusChange(status);  // 处理状态变化
@@ -75,7 +111,24 @@ ValveController::ValveController(std::unique_ptr<IValveDriver> driver)
  * @return 设置是否成功
  */
 bool ValveController::setup(const ValveParameters& params) {
-    return driver_->setup(params);  // 委托给驱动层处理
+    if (validateParameters(params) != ParameterError::NONE) {
+        return false;  // 无效参数不下发
+    }
+    return setup(std::make_shared<const ValveProfile>(makeProfile(params)));
+}
+
+/**
+ * 以共享配置初始化控制器
+ * 硬件接受参数后才替换当前配置
+ * @param profile 阀门参数配置
+ * @return 设置是否成功
+ */
+bool ValveController::setup(std::shared_ptr<const ValveProfile> profile) {
+    if (!profile || !driver_->setup(profile->params)) {  // 委托给驱动层处理
+        return false;
+    }
+    profile_ = std::move(profile);  // 保存配置，用于换算目标位置
+    return true;
 }
 
 /**
@@ -84,10 +137,33 @@ bool ValveController::setup(const ValveParameters& params) {
  * 实现R1需求(基本控制功能)
  */
 void ValveController::open() {
+    if (interlock_ && !interlock_->authorize(interlockValve_, ValveMove::OPEN)) {
+        if (journal_) {
+            journal_->append(JournalEventKind::VETO, journalValve_,
+                             static_cast<std::uint8_t>(ValveCommand::OPEN), commandSeq_);
+        }
+        return;  // 联锁否决，命令不下发
+    }
+    if (latency_) {
+        issuedAt_ = LatencyTracker::now();  // 记录命令下发时间
+    }
     if (currentState_) {
         currentState_->open();  // 通知当前状态对象
     }
+    if (fleetStore_ && profile_) {
+        fleetStore_->setTarget(fleetIndex_, profile_->params.openPosition.toInt());  // 同步目标位置
+    }
+    const std::uint32_t seq = ++commandSeq_;  // 记录命令序号
+    inflight_ = ValveCommand::OPEN;           // 记录未完成命令
+    if (journal_) {
+        journal_->append(JournalEventKind::COMMAND, journalValve_,
+                         static_cast<std::uint8_t>(ValveCommand::OPEN), commandSeq_);
+    }
     driver_->open();  // 发送打开命令到驱动层
+    // 硬件拒绝(ERROR)或同步完成时命令已结束，回调中发出的新命令已自行登记，都不再轮询
+    if (poller_ && inflight_ == ValveCommand::OPEN && commandSeq_ == seq) {
+        poller_->expect(pollerValve_, ValveMove::OPEN, expectedTravelTime());  // 按行程时间安排轮询
+    }
 }
 
 /**
@@ -96,10 +172,33 @@ void ValveController::open() {
  * 实现R1需求(基本控制功能)
  */
 void ValveController::close() {
+    if (interlock_ && !interlock_->authorize(interlockValve_, ValveMove::CLOSE)) {
+        if (journal_) {
+            journal_->append(JournalEventKind::VETO, journalValve_,
+                             static_cast<std::uint8_t>(ValveCommand::CLOSE), commandSeq_);
+        }
+        return;  // 联锁否决，命令不下发
+    }
+    if (latency_) {
+        issuedAt_ = LatencyTracker::now();  // 记录命令下发时间
+    }
     if (currentState_) {
         currentState_->close();  // 通知当前状态对象
     }
+    if (fleetStore_ && profile_) {
+        fleetStore_->setTarget(fleetIndex_, profile_->params.closePosition.toInt());  // 同步目标位置
+    }
+    const std::uint32_t seq = ++commandSeq_;  // 记录命令序号
+    inflight_ = ValveCommand::CLOSE;          // 记录未完成命令
+    if (journal_) {
+        journal_->append(JournalEventKind::COMMAND, journalValve_,
+                         static_cast<std::uint8_t>(ValveCommand::CLOSE), commandSeq_);
+    }
     driver_->close();  // 发送关闭命令到驱动层
+    // 同open()：命令已结束或已被回调中的新命令取代时不登记
+    if (poller_ && inflight_ == ValveCommand::CLOSE && commandSeq_ == seq) {
+        poller_->expect(pollerValve_, ValveMove::CLOSE, expectedTravelTime());  // 按行程时间安排轮询
+    }
 }
 
 /**
@@ -131,33 +230,248 @@ void ValveController::setStatusCallback(StatusCallback callback) {
     statusCallback_ = std::move(callback);  // 保存回调函数
 }
 
+/**
+ * 绑定舰队状态存储
+ * 绑定时立即写入当前状态，使存储与控制器保持一致
+ * @param store 舰队状态存储，传入nullptr解除绑定
+ * @param index 本阀门在存储中的槽位索引
+ */
+void ValveController::bindFleetStore(FleetStateStore* store, std::uint32_t index) {
+    fleetStore_ = store;
+    fleetIndex_ = index;
+    if (fleetStore_) {
+        // 与handleStatusChange一致，直接写入最近状态，运行中与出错不会记为未知
+        fleetStore_->setStatus(fleetIndex_, status_, FleetStateStore::now());
+    }
+}
+
+/**
+ * 接入联锁规则引擎
+ * @param engine 联锁规则引擎，传入nullptr解除接入
+ * @param valve 本阀门在引擎中的编号
+ */
+void ValveController::setInterlock(InterlockEngine* engine, std::uint32_t valve) {
+    interlock_ = engine;
+    interlockValve_ = valve;
+}
+
+/**
+ * 接入事件日志
+ * @param journal 事件日志，传入nullptr解除接入
+ * @param valve 本阀门在日志中的编号
+ */
+void ValveController::setJournal(ValveJournal* journal, std::uint32_t valve) {
+    journal_ = journal;
+    journalValve_ = valve;
+}
+
+/**
+ * 接入状态通知分发器
+ * @param notifier 状态通知分发器，传入nullptr解除接入
+ * @param valve 本阀门在分发器中的编号
+ */
+void ValveController::setNotifier(StatusNotifier* notifier, std::uint32_t valve) {
+    notifier_ = notifier;
+    notifierValve_ = valve;
+}
+
+/**
+ * 接入状态轮询器
+ * @param poller 状态轮询器，传入nullptr解除接入
+ * @param valve 本阀门在轮询器中的编号
+ */
+void ValveController::setPoller(StatusPoller* poller, std::uint32_t valve) {
+    poller_ = poller;
+    pollerValve_ = valve;
+}
+
+/**
+ * 接入移动耗时统计
+ * 同时开启驱动层的命令接受时间记录
+ * @param tracker 移动耗时统计，传入nullptr解除接入
+ * @param valveClass 本阀门在统计中的类别编号
+ */
+void ValveController::setLatencyTracker(LatencyTracker* tracker, std::uint16_t valveClass) {
+    latency_ = tracker;
+    latencyClass_ = valveClass;
+    issuedAt_ = 0;
+    driver_->setTimestamping(tracker != nullptr);
+}
+
+/**
+ * 添加状态观察者
+ * @param observer 状态变化时调用的回调函数
+ * @return 用于移除该观察者的标识
+ */
+std::size_t ValveController::addStatusObserver(StatusCallback observer) {
+    std::size_t token = nextObserverToken_++;
+    observers_.emplace_back(token, std::move(observer));  // 保存观察者
+    return token;
+}
+
+/**
+ * 移除状态观察者
+ * @param token addStatusObserver返回的标识
+ */
+void ValveController::removeStatusObserver(std::size_t token) {
+    for (auto it = observers_.begin(); it != observers_.end(); ++it) {
+        if (it->first == token) {
+            observers_.erase(it);  // 找到后移除
+            return;
+        }
+    }
+}
+
 /**
  * 处理状态变化
- * 根据新状态更新内部状态机
- * 状态模式的核心方法
+ * 更新内部状态后通知客户端和内部观察者
  * @param status 新的阀门状态
  */
 void ValveController::handleStatusChange(ValveStatus status) {
-    // 状态转换逻辑 - 根据新状态创建对应的状态对象
+    // 命令结束时计时，inflight_会在applyStatus中清除
+    const ValveCommand finished = inflight_;
+    const bool timed = latency_ && issuedAt_ != 0 && finished != ValveCommand::NONE &&
+                       (status == ValveStatus::OPENED || status == ValveStatus::CLOSED || status == ValveStatus::ERROR);
+    const std::int64_t completedAt = timed ? LatencyTracker::now() : 0;
+
+    applyStatus(status);  // 更新状态机及绑定的组件
+    if (journal_) {
+        journal_->append(JournalEventKind::STATUS, journalValve_, static_cast<std::uint8_t>(status), commandSeq_);
+    }
+
+    // 如果设置了回调函数，通知外部状态变化
+    if (statusCallback_) {
+        statusCallback_(status);  // 调用回调函数
+    }
+
+    if (timed && status == ValveStatus::ERROR) {
+        // 失败的移动单独统计，不混入正常移动的分布
+        latency_->record(latencyClass_, finished, LatencyPhase::ERROR, completedAt - issuedAt_);
+        issuedAt_ = 0;
+    } else if (timed) {
+        std::int64_t acceptedAt = driver_->acceptedAt();
+        if (acceptedAt < issuedAt_ || acceptedAt > completedAt) {
+            acceptedAt = completedAt;  // 驱动未记录接受时间，或记录的是更早的命令
+        }
+        const std::int64_t callbackNs = statusCallback_ ? LatencyTracker::now() - completedAt : 0;  // 没有回调时不读时钟
+        latency_->recordMove(latencyClass_, finished, acceptedAt - issuedAt_, completedAt - acceptedAt, callbackNs);
+        issuedAt_ = 0;
+    }
+
+    // 通知内部观察者
+    for (auto& observer : observers_) {
+        observer.second(status);
+    }
+
+    // 发布到异步订阅者，不等待交付
+    if (notifier_) {
+        notifier_->publish(notifierValve_, status);
+    }
+}
+
+/**
+ * 应用新状态
+ * 根据新状态更新内部状态机、命令记录和绑定的组件，不通知客户端
+ * 状态模式的核心方法
+ * @param status 新的阀门状态
+ */
+void ValveController::applyStatus(ValveStatus status) {
+    // 先更新联锁状态，保证回调中发出的命令基于最新状态检查
+    if (interlock_) {
+        interlock_->onStatusChange(interlockValve_, status);
+    }
+
+    // 状态转换逻辑 - 根据新状态切换到对应的共享状态对象
     switch (status) {
         case ValveStatus::OPENED:
-            setState(std::make_unique<OpenedState>());  // 切换到已打开状态
+            setState(&kOpenedState);  // 切换到已打开状态
             break;
         case ValveStatus::CLOSED:
-            setState(std::make_unique<ClosedState>());  // 切换到已关闭状态
+            setState(&kClosedState);  // 切换到已关闭状态
             break;
         case ValveStatus::MOVING:
-            setState(std::make_unique<MovingState>());  // 切换到移动中状态
+            setState(&kMovingState);  // 切换到移动中状态
             break;
         default:
-            setState(std::make_unique<UnknownState>());  // 切换到未知状态
+            setState(&kUnknownState);  // 切换到未知状态
             break;
     }
-    
-    // 如果设置了回调函数，通知外部状态变化
-    if (statusCallback_) {
-        statusCallback_(status);  // 调用回调函数
+
+    // 记录状态，到达终点或出错时命令结束
+    status_ = status;
+    if (status == ValveStatus::OPENED || status == ValveStatus::CLOSED) {
+        lastConfirmed_ = status;
+        inflight_ = ValveCommand::NONE;
+    } else if (status == ValveStatus::ERROR) {
+        inflight_ = ValveCommand::NONE;
     }
+
+    // 同步舰队状态存储，到达终点时位置即为对应的端点位置
+    if (fleetStore_) {
+        fleetStore_->setStatus(fleetIndex_, status, FleetStateStore::now());
+        if (profile_ && status == ValveStatus::OPENED) {
+            fleetStore_->setPosition(fleetIndex_, profile_->params.openPosition.toInt());
+        } else if (profile_ && status == ValveStatus::CLOSED) {
+            fleetStore_->setPosition(fleetIndex_, profile_->params.closePosition.toInt());
+        }
+    }
+}
+
+/**
+ * 生成快照记录
+ * 可在后台快照线程中与完成线程并发调用，每个字段各自原子读取；
+ * 阀门静止时记录一致，运行中各字段可能取自相邻的不同时刻
+ * @return 快照记录
+ */
+ValveSnapshotRecord ValveController::snapshot() const {
+    ValveSnapshotRecord record{};
+    record.status = static_cast<std::uint8_t>(status_.load(std::memory_order_relaxed));
+    record.lastConfirmed = static_cast<std::uint8_t>(lastConfirmed_.load(std::memory_order_relaxed));
+    record.inflight = static_cast<std::uint8_t>(inflight_.load(std::memory_order_relaxed));
+    record.sequence = commandSeq_.load(std::memory_order_relaxed);
+    return record;
+}
+
+/**
+ * 从快照记录恢复状态
+ * 只恢复控制器内部状态，不访问硬件，也不通知客户端
+ * @param record 快照记录
+ */
+void ValveController::restore(const ValveSnapshotRecord& record) {
+    commandSeq_ = record.sequence;
+    applyStatus(static_cast<ValveStatus>(record.status));
+    lastConfirmed_ = static_cast<ValveStatus>(record.lastConfirmed);  // applyStatus可能已覆盖
+    inflight_ = static_cast<ValveCommand>(record.inflight);
+}
+
+/**
+ * 用硬件状态校正恢复后的状态
+ * 硬件报告明确状态时以硬件为准并通知客户端；
+ * 硬件无法报告位置(UNKNOWN)且没有未完成命令时沿用快照中最后确认的状态，
+ * 有未完成命令时其结果未知，置为UNKNOWN
+ * @param hardwareStatus 硬件当前状态
+ * @return 校正后的状态
+ */
+ValveStatus ValveController::reconcile(ValveStatus hardwareStatus) {
+    if (hardwareStatus != ValveStatus::UNKNOWN) {
+        handleStatusChange(hardwareStatus);  // 硬件状态可信
+        return status_;
+    }
+    if (inflight_ == ValveCommand::NONE) {
+        applyStatus(lastConfirmed_);  // 位置自上次确认后未变
+    } else {
+        applyStatus(ValveStatus::UNKNOWN);  // 命令结果未知
+        inflight_ = ValveCommand::NONE;
+    }
+    return status_;
+}
+
+/**
+ * 获取硬件当前状态
+ * @return 驱动层报告的状态
+ */
+ValveStatus ValveController::hardwareStatus() const {
+    return driver_->getStatus();  // 委托给驱动层处理
 }
 
 /**
@@ -165,11 +479,11 @@ void ValveController::handleStatusChange(ValveStatus status) {
  * 处理状态转换的辅助方法
  * @param newState 新的状态对象
  */
-void ValveController::setState(std::unique_ptr<ValveState> newState) {
+void ValveController::setState(ValveState* newState) {
     if (currentState_) {
         currentState_->exit();  // 调用旧状态的退出方法
     }
-    currentState_ = std::move(newState);  // 更新当前状态
+    currentState_ = newState;  // 更新当前状态
     if (currentState_) {
         currentState_->enter();  // 调用新状态的进入方法
     }
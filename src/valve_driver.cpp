@@ -1,15 +1,49 @@
 #include "../include/valve_driver.h"  // 包含驱动层接口定义
+#include "../include/latency_tracker.h"  // 统一的单调时钟
+#include <stdexcept>                     // 标准异常
 
 namespace valve {  // 阀门控制系统命名空间
 
+namespace {  // 内部实现细节
+
+/**
+ * 取得要接管的硬件抽象层
+ * ValveHALFactory::createHAL对未知类型返回nullptr，不能在委托构造中直接解引用
+ */
+IValveHAL& requireHal(const std::unique_ptr<IValveHAL>& hal) {
+    if (!hal) {
+        throw std::invalid_argument("ValveDriver: hal must not be null");
+    }
+    return *hal;
+}
+
+} // namespace
+
 /**
  * ValveDriver构造函数
  * 初始化驱动层，建立与硬件抽象层的桥接
- * @param hal 硬件抽象层接口的智能指针
+ * @param hal 硬件抽象层接口的智能指针，为空时抛出std::invalid_argument
  */
 ValveDriver::ValveDriver(std::unique_ptr<IValveHAL> hal)
-    : hal_(std::move(hal)) {
-    // 初始化时不设置回调，需要外部调用setStatusCallback
+    : ValveDriver(requireHal(hal)) {
+    ownedHal_ = std::move(hal);  // 接管硬件抽象层的所有权
+}
+
+/**
+ * ValveDriver构造函数
+ * 不接管硬件抽象层的所有权，用于在对象区中与硬件抽象层相邻存放
+ * @param hal 硬件抽象层接口，生命周期必须长于驱动层
+ */
+ValveDriver::ValveDriver(IValveHAL& hal)
+    : hal_(&hal) {
+    // 订阅硬件的完成通知，将移动结果转发给上层
+    // 客户端回调需要外部调用setStatusCallback设置
+    hal_->setCompletionCallback([this](ValveStatus status) {
+        if (timestamping_) {
+            markAccepted();  // 同步完成的硬件在move返回前完成，接受时间即完成时间
+        }
+        notifyStatus(status);
+    });
 }
 
 /**
@@ -28,8 +62,7 @@ bool ValveDriver::setup(const ValveParameters& params) {
  * 实现R1需求(基本控制功能)
  */
 void ValveDriver::open() {
-    hal_->move(ValveMove::OPEN);  // 发送打开命令
-    currentStatus_ = ValveStatus::MOVING;  // 更新当前状态为移动中
+    startMove(ValveMove::OPEN);  // 发送打开命令
 }
 
 /**
@@ -38,8 +71,7 @@ void ValveDriver::open() {
  * 实现R1需求(基本控制功能)
  */
 void ValveDriver::close() {
-    hal_->move(ValveMove::CLOSE);  // 发送关闭命令
-    currentStatus_ = ValveStatus::MOVING;  // 更新当前状态为移动中
+    startMove(ValveMove::CLOSE);  // 发送关闭命令
 }
 
 /**
@@ -60,4 +92,42 @@ void ValveDriver::setStatusCallback(StatusCallback callback) {
     statusCallback_ = std::move(callback);  // 保存回调函数
 }
 
+/**
+ * 发送移动命令
+ * 移动中状态必须在命令下发前通知，
+ * 否则同步完成的硬件会先报告最终状态
+ * @param target 移动目标(打开/关闭)
+ */
+void ValveDriver::startMove(ValveMove target) {
+    if (timestamping_) {
+        acceptedAt_.store(0, std::memory_order_relaxed);
+    }
+    notifyStatus(ValveStatus::MOVING);  // 更新当前状态为移动中
+    if (!hal_->move(target)) {
+        notifyStatus(ValveStatus::ERROR);  // 硬件拒绝命令
+    } else if (timestamping_) {
+        markAccepted();
+    }
+}
+
+/**
+ * 记录命令接受时间
+ * 只记录本次命令的第一次，完成回调与move返回的先后不确定
+ */
+void ValveDriver::markAccepted() {
+    std::int64_t unset = 0;
+    acceptedAt_.compare_exchange_strong(unset, LatencyTracker::now(), std::memory_order_acq_rel);
+}
+
+/**
+ * 更新当前状态并通知观察者
+ * @param status 新的阀门状态
+ */
+void ValveDriver::notifyStatus(ValveStatus status) {
+    currentStatus_ = status;  // 记录当前状态
+    if (statusCallback_) {
+        statusCallback_(status);  // 调用回调函数
+    }
+}
+
 } // namespace valve 
\ No newline at end of file
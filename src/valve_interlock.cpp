@@ -0,0 +1,181 @@
+#include "../include/valve_interlock.h"  // 包含联锁引擎定义
+#include <cassert>  // 断言支持
+
+namespace valve {  // 阀门控制系统命名空间
+
+namespace {  // 内部实现细节
+
+constexpr std::uint8_t kOpened = static_cast<std::uint8_t>(ValveStatus::OPENED);
+constexpr std::uint8_t kClosed = static_cast<std::uint8_t>(ValveStatus::CLOSED);
+constexpr std::uint8_t kMoving = static_cast<std::uint8_t>(ValveStatus::MOVING);
+
+bool openLike(std::uint8_t status) {
+    return status == kOpened || status == kMoving;  // 移动中至少部分打开
+}
+
+bool possiblyOpen(std::uint8_t status) {
+    return status != kClosed;  // 未确认关闭，包括UNKNOWN和ERROR
+}
+
+} // namespace
+
+/**
+ * InterlockEngine构造函数
+ * 所有阀门初始为UNKNOWN，与控制器初始状态一致
+ * @param valveCount 受管阀门数量
+ */
+InterlockEngine::InterlockEngine(std::size_t valveCount)
+    : status_(valveCount, static_cast<std::uint8_t>(ValveStatus::UNKNOWN)) {
+}
+
+/**
+ * 添加规则
+ * @param kind 规则类型
+ * @param a 规则的主阀门
+ * @param b 规则的约束阀门
+ * @return 规则编号
+ */
+std::uint32_t InterlockEngine::addRule(RuleKind kind, std::uint32_t a, std::uint32_t b) {
+    assert(!finalized_ && "rules must be added before finalize()");
+    assert(a < status_.size() && b < status_.size() && a != b);
+    rules_.push_back(Rule{kind, false, false, a, b});
+    return static_cast<std::uint32_t>(rules_.size() - 1);
+}
+
+/**
+ * 建立阀门到规则的CSR索引
+ * 每条规则同时登记在两个阀门之下
+ */
+void InterlockEngine::finalize() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::size_t n = status_.size();
+    ruleIndex_.assign(n + 1, 0);
+    for (const Rule& rule : rules_) {
+        ++ruleIndex_[rule.a + 1];
+        ++ruleIndex_[rule.b + 1];
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        ruleIndex_[i + 1] += ruleIndex_[i];
+    }
+    ruleRefs_.assign(ruleIndex_[n], 0);
+    std::vector<std::uint32_t> fill(ruleIndex_.begin(), ruleIndex_.end() - 1);
+    for (std::size_t r = 0; r < rules_.size(); ++r) {
+        ruleRefs_[fill[rules_[r].a]++] = static_cast<std::uint32_t>(r);
+        ruleRefs_[fill[rules_[r].b]++] = static_cast<std::uint32_t>(r);
+    }
+
+    // 按当前状态计算初始违反情况，启动时已存在的违反同样通知
+    violated_ = 0;
+    for (std::size_t r = 0; r < rules_.size(); ++r) {
+        Rule& rule = rules_[r];
+        rule.violated = !holds(rule, rule.a, status_[rule.a]);
+        rule.reported = rule.violated;
+        violated_ += rule.violated;
+        if (rule.violated && violationHandler_) {
+            violationHandler_(static_cast<std::uint32_t>(r), rule.a);
+        }
+    }
+    finalized_ = true;
+}
+
+bool InterlockEngine::holds(const Rule& rule, std::uint32_t valve, std::uint8_t status, bool strict) const {
+    std::uint8_t a = (rule.a == valve) ? status : status_[rule.a];
+    std::uint8_t b = (rule.b == valve) ? status : status_[rule.b];
+    // 命令检查时另一阀门位置未确认即按打开处理，规则失效时拒绝命令而不是放行
+    bool aOpen = (strict && rule.a != valve) ? possiblyOpen(a) : openLike(a);
+    bool bOpen = (strict && rule.b != valve) ? possiblyOpen(b) : openLike(b);
+    switch (rule.kind) {
+        case RuleKind::EXCLUSIVE_OPEN:
+            return !(aOpen && bOpen);
+        case RuleKind::REQUIRES_CLOSED:
+            return !aOpen || b == kClosed;
+        case RuleKind::REQUIRES_OPEN:
+            return !aOpen || b == kOpened;
+    }
+    return true;
+}
+
+/**
+ * 检查并登记命令
+ * 以命令完成后的状态作为假设状态评估规则，其他阀门位置未确认时按可能打开处理
+ * @param valve 阀门编号
+ * @param move 待下发的命令
+ * @return 命令是否允许下发
+ */
+bool InterlockEngine::authorize(std::uint32_t valve, ValveMove move) {
+    assert(finalized_ && "finalize() must be called before use");
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::uint8_t target = (move == ValveMove::OPEN) ? kOpened : kClosed;
+    for (std::uint32_t i = ruleIndex_[valve]; i < ruleIndex_[valve + 1]; ++i) {
+        std::uint32_t r = ruleRefs_[i];
+        if (!holds(rules_[r], valve, target, true)) {
+            ++vetoes_;
+            if (vetoHandler_) {
+                vetoHandler_(valve, move, r);  // 通知否决原因
+            }
+            return false;
+        }
+    }
+
+    // 允许下发：阀门即将开始移动，立即登记以阻止并发的冲突命令
+    // 移动过程中的过渡性违反只更新规则状态，不触发违反通知，
+    // 到达终点后仍违反时由onStatusChange()通知
+    status_[valve] = kMoving;
+    for (std::uint32_t i = ruleIndex_[valve]; i < ruleIndex_[valve + 1]; ++i) {
+        Rule& rule = rules_[ruleRefs_[i]];
+        bool violated = !holds(rule, valve, kMoving);
+        violated_ += static_cast<std::size_t>(violated) - static_cast<std::size_t>(rule.violated);
+        rule.violated = violated;
+    }
+    return true;
+}
+
+/**
+ * 处理阀门状态变化
+ * 只重新评估涉及该阀门的规则；规则在authorize()中已记为违反时，
+ * 移动中不通知，到达终点(含出错)后仍违反且未通知过则通知，
+ * 例如关闭失败后阀门仍停在OPENED
+ * @param valve 阀门编号
+ * @param status 新状态
+ */
+void InterlockEngine::onStatusChange(std::uint32_t valve, ValveStatus status) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::uint8_t value = static_cast<std::uint8_t>(status);
+    status_[valve] = value;
+    if (!finalized_) {
+        return;  // 索引尚未建立，只记录状态，finalize()时统一评估
+    }
+    for (std::uint32_t i = ruleIndex_[valve]; i < ruleIndex_[valve + 1]; ++i) {
+        std::uint32_t r = ruleRefs_[i];
+        Rule& rule = rules_[r];
+        bool violated = !holds(rule, valve, value);
+        bool transitional = rule.violated && value == kMoving;  // authorize()登记的移动
+        violated_ += static_cast<std::size_t>(violated) - static_cast<std::size_t>(rule.violated);
+        rule.violated = violated;
+        if (!violated) {
+            rule.reported = false;
+        } else if (!rule.reported && !transitional) {
+            rule.reported = true;
+            if (violationHandler_) {
+                violationHandler_(r, valve);  // 通知尚未通知的违反
+            }
+        }
+    }
+}
+
+bool InterlockEngine::isViolated(std::uint32_t rule) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rules_[rule].violated;
+}
+
+std::size_t InterlockEngine::violatedCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return violated_;
+}
+
+std::uint64_t InterlockEngine::vetoCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return vetoes_;
+}
+
+} // namespace valve
@@ -0,0 +1,567 @@
+#include "../include/valve_journal.h"  // 包含事件日志定义
+#include <algorithm>   // 排序支持
+#include <cstdio>      // 格式化文件名
+#include <cstring>     // 内存操作
+#include <filesystem>  // 目录操作
+
+#ifndef _WIN32
+#include <fcntl.h>     // open
+#include <sys/mman.h>  // mmap
+#include <sys/stat.h>  // fstat
+#include <unistd.h>    // close, ftruncate
+#endif
+
+namespace valve {  // 阀门控制系统命名空间
+
+namespace {  // 内部实现细节
+
+constexpr std::uint32_t kSegmentMagic = 0x4C4A5356;  // "VSJL"小端存放
+constexpr std::uint32_t kSegmentVersion = 2;         // 当前格式版本：段尾增加阀门索引
+constexpr std::size_t kHeaderSize = 4096;            // 段头占一页，记录区按页对齐
+
+/**
+ * 段文件头
+ * 由组提交线程维护：记录区内容由写入方直接写入，
+ * 段头只覆盖已确认的连续前缀，读取方据此建立查询范围
+ */
+struct SegmentHeader {
+    std::uint32_t magic;                    // 文件标识
+    std::uint32_t version;                  // 格式版本
+    std::uint64_t firstLsn;                 // 本段第一条记录的LSN
+    std::uint64_t capacity;                 // 记录容量
+    std::uint64_t indexedCount;             // 已确认并建立索引的记录数
+    std::int64_t minTimestamp;              // 已确认记录的最早时间
+    std::int64_t maxTimestamp;              // 已确认记录的最晚时间
+    std::uint32_t minValve;                 // 已确认记录的最小阀门编号
+    std::uint32_t maxValve;                 // 已确认记录的最大阀门编号
+    std::uint64_t valveIndexCount;          // 阀门索引条目数，段写满前为0
+    std::uint64_t reserved[2];              // 保留
+};
+static_assert(sizeof(SegmentHeader) <= kHeaderSize, "segment header must fit in one page");
+
+/**
+ * 阀门索引条目
+ * 段写满后按(阀门, 段内偏移)排序存放在记录区之后，
+ * 同一阀门的条目连续且按LSN顺序排列
+ */
+struct ValveIndexEntry {
+    std::uint32_t valve;   // 阀门编号
+    std::uint32_t offset;  // 段内记录偏移
+};
+static_assert(sizeof(ValveIndexEntry) == 8, "valve index entry must stay 8 bytes");
+
+/**
+ * 段文件长度：段头、记录区和阀门索引
+ */
+std::size_t segmentBytes(std::size_t records) {
+    return kHeaderSize + records * (sizeof(JournalRecord) + sizeof(ValveIndexEntry));
+}
+
+std::string segmentPath(const std::string& directory, std::size_t index) {
+    char name[48];
+    std::snprintf(name, sizeof(name), "segment-%02zu.vjl", index);
+    return (std::filesystem::path(directory) / name).string();
+}
+
+std::uint64_t loadCommit(const JournalRecord* record) {
+#if defined(__GNUC__)
+    return __atomic_load_n(&record->commit, __ATOMIC_ACQUIRE);
+#else
+    return record->commit;
+#endif
+}
+
+void storeCommit(JournalRecord* record, std::uint64_t value) {
+#if defined(__GNUC__)
+    __atomic_store_n(&record->commit, value, __ATOMIC_RELEASE);
+#else
+    record->commit = value;
+#endif
+}
+
+std::int64_t wallClockNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+/**
+ * 映射的段文件
+ */
+struct ValveJournal::Segment {
+    int fd = -1;                  // 文件描述符
+    std::uint8_t* base = nullptr; // 映射起始地址
+    std::size_t size = 0;         // 映射长度
+
+    SegmentHeader* header() const { return reinterpret_cast<SegmentHeader*>(base); }
+    JournalRecord* records() const { return reinterpret_cast<JournalRecord*>(base + kHeaderSize); }
+    ValveIndexEntry* index() const {
+        return reinterpret_cast<ValveIndexEntry*>(base + kHeaderSize + header()->capacity * sizeof(JournalRecord));
+    }
+};
+
+struct JournalReader::Segment {
+    const std::uint8_t* base = nullptr;  // 映射起始地址
+    std::size_t size = 0;                // 映射长度
+    std::uint64_t count = 0;             // 可读记录数：段头indexedCount
+    std::uint64_t indexCount = 0;        // 可用的阀门索引条目数
+
+    const SegmentHeader* header() const { return reinterpret_cast<const SegmentHeader*>(base); }
+    const JournalRecord* records() const { return reinterpret_cast<const JournalRecord*>(base + kHeaderSize); }
+    const ValveIndexEntry* index() const {
+        return reinterpret_cast<const ValveIndexEntry*>(base + kHeaderSize + header()->capacity * sizeof(JournalRecord));
+    }
+};
+
+ValveJournal::ValveJournal() : flushInterval_(2) {}
+
+ValveJournal::~ValveJournal() {
+    close();
+}
+
+/**
+ * 打开或创建日志目录
+ * 恢复时以LSN最大的段为准，从其中最后一条连续完整记录之后继续
+ * @param directory 日志目录
+ * @param options 日志配置
+ * @return 是否打开成功
+ */
+bool ValveJournal::open(const std::string& directory, const JournalOptions& options) {
+#ifdef _WIN32
+    (void)directory;
+    (void)options;
+    return false;  // 仅支持POSIX平台
+#else
+    close();
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error || options.segmentCount == 0 || options.recordsPerSegment == 0 ||
+        options.recordsPerSegment > UINT32_MAX) {
+        return false;  // 索引条目以32位存放段内偏移
+    }
+
+    recordsPerSegment_ = options.recordsPerSegment;
+    flushInterval_ = options.flushInterval;
+    const std::size_t size = segmentBytes(recordsPerSegment_);
+
+    for (std::size_t i = 0; i < options.segmentCount; ++i) {
+        Segment segment;
+        segment.fd = ::open(segmentPath(directory, i).c_str(), O_RDWR | O_CREAT, 0644);
+        struct stat st;
+        if (segment.fd < 0 || ::fstat(segment.fd, &st) != 0 ||
+            (st.st_size != 0 && static_cast<std::size_t>(st.st_size) != size) ||
+            (st.st_size == 0 && ::ftruncate(segment.fd, static_cast<off_t>(size)) != 0)) {
+            if (segment.fd >= 0) ::close(segment.fd);
+            close();
+            return false;  // 无法创建或与已有配置不一致
+        }
+        void* map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, segment.fd, 0);
+        if (map == MAP_FAILED) {
+            ::close(segment.fd);
+            close();
+            return false;
+        }
+        segment.base = static_cast<std::uint8_t*>(map);
+        segment.size = size;
+        segments_.push_back(segment);
+    }
+
+    // 找到最新的段，确定续写位置；记录数超出容量的段头视为损坏
+    const Segment* latest = nullptr;
+    for (const Segment& segment : segments_) {
+        const SegmentHeader* h = segment.header();
+        if (h->magic == kSegmentMagic && h->version == kSegmentVersion && h->capacity == recordsPerSegment_ &&
+            h->indexedCount <= recordsPerSegment_ && (!latest || h->firstLsn > latest->header()->firstLsn)) {
+            latest = &segment;
+        }
+    }
+    std::uint64_t durable = 0;
+    std::uint64_t next = 0;
+    if (latest) {
+        const SegmentHeader* h = latest->header();
+        durable = h->firstLsn + h->indexedCount;
+        std::uint64_t count = h->indexedCount;
+        // 崩溃前已写入页缓存但尚未确认的记录同样有效，交给首次组提交建立索引
+        while (count < recordsPerSegment_ && loadCommit(&latest->records()[count]) == h->firstLsn + count + 1) {
+            ++count;
+        }
+        next = h->firstLsn + count;
+    }
+    nextLsn_.store(next);
+    durableLsn_.store(durable);
+    open_.store(true, std::memory_order_release);
+
+    running_ = true;
+    flusher_ = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (running_) {
+            wake_.wait_for(lock, flushInterval_, [this] { return !running_ || flushRequested_; });
+            flushRequested_ = false;
+            lock.unlock();
+            commit();
+            lock.lock();
+        }
+    });
+    return true;
+#endif
+}
+
+/**
+ * 关闭日志
+ * 停止组提交线程，最后提交一次后解除映射
+ */
+void ValveJournal::close() {
+    open_.store(false, std::memory_order_release);  // 之后的append()不再写入
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    wake_.notify_all();
+    if (flusher_.joinable()) {
+        flusher_.join();
+    }
+#ifndef _WIN32
+    if (!segments_.empty()) {
+        commit();
+    }
+    for (Segment& segment : segments_) {
+        ::munmap(segment.base, segment.size);
+        ::close(segment.fd);
+    }
+#endif
+    segments_.clear();
+}
+
+JournalRecord* ValveJournal::slot(std::uint64_t lsn) const {
+    const Segment& segment = segments_[(lsn / recordsPerSegment_) % segments_.size()];
+    return segment.records() + (lsn % recordsPerSegment_);
+}
+
+/**
+ * 追加一条记录
+ * 原子递增LSN占用槽位，写入字段后以release语义写入提交标记；
+ * 槽位上一代的记录尚未落盘时(领先落盘位置一整个环形)先等待组提交，
+ * 否则会覆盖未落盘的记录，组提交也将停在该槽位
+ * @return 记录的LSN
+ */
+std::uint64_t ValveJournal::append(JournalEventKind kind, std::uint32_t valve, std::uint8_t value,
+                                   std::uint32_t sequence) {
+    if (!open_.load(std::memory_order_acquire)) {
+        return kInvalidLsn;  // 未打开或已关闭，没有可写入的段
+    }
+    const std::uint64_t lsn = nextLsn_.fetch_add(1, std::memory_order_relaxed);
+    const std::uint64_t capacity = recordsPerSegment_ * segments_.size();
+    if (lsn - durableLsn_.load(std::memory_order_acquire) >= capacity) {
+        waitDurable(lsn - capacity);  // 环形已满，等待上一代记录落盘
+    }
+    JournalRecord* record = slot(lsn);
+    record->timestamp = wallClockNs();
+    record->valve = valve;
+    record->sequence = sequence;
+    record->kind = static_cast<std::uint8_t>(kind);
+    record->value = value;
+    record->reserved = 0;
+    record->reserved2 = 0;
+    storeCommit(record, lsn + 1);  // 最后写入，标记记录完整
+    return lsn;
+}
+
+/**
+ * 等待指定LSN落盘
+ * @param lsn 记录的LSN
+ */
+void ValveJournal::waitDurable(std::uint64_t lsn) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_ && durableLsn_.load(std::memory_order_acquire) <= lsn) {
+        flushRequested_ = true;
+        wake_.notify_all();
+        durable_.wait_for(lock, flushInterval_);
+    }
+}
+
+/**
+ * 组提交
+ * 从上次落盘位置起确认连续完整的记录，更新所在段的段头索引，
+ * 然后一次性同步所有涉及的页
+ */
+void ValveJournal::commit() {
+#ifndef _WIN32
+    std::uint64_t lsn = durableLsn_.load(std::memory_order_relaxed);
+    const std::uint64_t start = lsn;
+    const std::uint64_t end = nextLsn_.load(std::memory_order_acquire);
+    std::vector<std::uint64_t> full;  // 本次写满的段的firstLsn
+    while (lsn < end) {
+        const JournalRecord* record = slot(lsn);
+        if (loadCommit(record) != lsn + 1) {
+            break;  // 该槽位尚未写完，后续记录等下次提交
+        }
+        Segment& segment = segments_[(lsn / recordsPerSegment_) % segments_.size()];
+        SegmentHeader* h = segment.header();
+        const std::uint64_t first = lsn - lsn % recordsPerSegment_;
+        if (h->magic != kSegmentMagic || h->firstLsn != first) {
+            // 环形复用该段，重置段头
+            std::memset(h, 0, sizeof(SegmentHeader));
+            h->magic = kSegmentMagic;
+            h->version = kSegmentVersion;
+            h->firstLsn = first;
+            h->capacity = recordsPerSegment_;
+            h->minTimestamp = record->timestamp;
+            h->maxTimestamp = record->timestamp;
+            h->minValve = record->valve;
+            h->maxValve = record->valve;
+        }
+        h->minTimestamp = std::min(h->minTimestamp, record->timestamp);
+        h->maxTimestamp = std::max(h->maxTimestamp, record->timestamp);
+        h->minValve = std::min(h->minValve, record->valve);
+        h->maxValve = std::max(h->maxValve, record->valve);
+        h->indexedCount = lsn - first + 1;
+        if (h->indexedCount == recordsPerSegment_) {
+            full.push_back(first);
+        }
+        ++lsn;
+    }
+    if (lsn == start) {
+        return;  // 没有新记录
+    }
+
+    // 按段同步记录区和段头
+    const long page = ::sysconf(_SC_PAGESIZE);
+    for (std::uint64_t from = start; from < lsn;) {
+        const std::uint64_t segmentEnd = from - from % recordsPerSegment_ + recordsPerSegment_;
+        const std::uint64_t to = std::min(lsn, segmentEnd);
+        Segment& segment = segments_[(from / recordsPerSegment_) % segments_.size()];
+        std::size_t begin = kHeaderSize + (from % recordsPerSegment_) * sizeof(JournalRecord);
+        std::size_t finish = kHeaderSize + ((to - 1) % recordsPerSegment_ + 1) * sizeof(JournalRecord);
+        begin -= begin % static_cast<std::size_t>(page);
+        ::msync(segment.base + begin, finish - begin, MS_SYNC);
+        ::msync(segment.base, kHeaderSize, MS_SYNC);
+        from = to;
+    }
+
+    durableLsn_.store(lsn, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        durable_.notify_all();
+    }
+
+    // 落盘通知之后再为写满的段建立阀门索引，不延迟等待者
+    for (std::uint64_t first : full) {
+        seal(segments_[(first / recordsPerSegment_) % segments_.size()], first);
+    }
+#endif
+}
+
+/**
+ * 为写满的段建立阀门索引
+ * 按(阀门, 段内偏移)排序后写入记录区之后，落盘后才在段头登记条目数，
+ * 中途崩溃的段按未建立索引处理；同一次提交中段已被下一代复用时跳过
+ * @param segment 写满的段
+ * @param first 段的firstLsn
+ */
+void ValveJournal::seal(Segment& segment, std::uint64_t first) {
+#ifndef _WIN32
+    SegmentHeader* h = segment.header();
+    if (h->firstLsn != first || h->indexedCount != recordsPerSegment_) {
+        return;
+    }
+    const JournalRecord* records = segment.records();
+    std::vector<std::uint64_t> keys(recordsPerSegment_);
+    for (std::size_t i = 0; i < recordsPerSegment_; ++i) {
+        keys[i] = (static_cast<std::uint64_t>(records[i].valve) << 32) | i;
+    }
+    std::sort(keys.begin(), keys.end());
+    ValveIndexEntry* index = segment.index();
+    for (std::size_t i = 0; i < recordsPerSegment_; ++i) {
+        index[i] = ValveIndexEntry{static_cast<std::uint32_t>(keys[i] >> 32), static_cast<std::uint32_t>(keys[i])};
+    }
+    const std::size_t begin = kHeaderSize + recordsPerSegment_ * sizeof(JournalRecord);
+    const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t aligned = begin - begin % page;
+    ::msync(segment.base + aligned, segment.size - aligned, MS_SYNC);
+    h->valveIndexCount = recordsPerSegment_;
+    ::msync(segment.base, kHeaderSize, MS_SYNC);
+#else
+    (void)segment;
+    (void)first;
+#endif
+}
+
+JournalReader::JournalReader() = default;
+
+JournalReader::~JournalReader() {
+#ifndef _WIN32
+    for (Segment& segment : segments_) {
+        ::munmap(const_cast<std::uint8_t*>(segment.base), segment.size);
+    }
+#endif
+}
+
+/**
+ * 打开日志目录
+ * 只读映射所有有效段并按firstLsn排序
+ * @param directory 日志目录
+ * @return 是否找到有效段
+ */
+bool JournalReader::open(const std::string& directory) {
+#ifdef _WIN32
+    (void)directory;
+    return false;  // 仅支持POSIX平台
+#else
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        if (entry.path().extension() != ".vjl") {
+            continue;
+        }
+        int fd = ::open(entry.path().c_str(), O_RDONLY);
+        struct stat st;
+        if (fd < 0 || ::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < kHeaderSize) {
+            if (fd >= 0) ::close(fd);
+            continue;
+        }
+        const std::size_t size = static_cast<std::size_t>(st.st_size);
+        void* map = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) {
+            continue;
+        }
+        Segment segment;
+        segment.base = static_cast<const std::uint8_t*>(map);
+        segment.size = size;
+        const SegmentHeader* h = segment.header();
+        constexpr std::size_t perRecord = sizeof(JournalRecord) + sizeof(ValveIndexEntry);
+        if (h->magic != kSegmentMagic || h->version != kSegmentVersion || (size - kHeaderSize) % perRecord != 0 ||
+            h->capacity != (size - kHeaderSize) / perRecord || h->indexedCount > h->capacity ||
+            h->valveIndexCount > h->capacity) {
+            ::munmap(map, size);
+            continue;  // 尚未使用、无效或截断的段，记录数超出容量的段头视为损坏
+        }
+        // 段头此后可能被写入方更新，只使用打开时校验过的计数
+        segment.count = h->indexedCount;
+        segment.indexCount = h->valveIndexCount == h->indexedCount ? h->valveIndexCount : 0;
+        segments_.push_back(segment);
+    }
+    std::sort(segments_.begin(), segments_.end(), [](const Segment& a, const Segment& b) {
+        return a.header()->firstLsn < b.header()->firstLsn;
+    });
+    return !segments_.empty();
+#endif
+}
+
+std::size_t JournalReader::visit(const std::function<bool(const Segment&)>& segmentFilter,
+                                 const std::function<bool(const JournalRecord&)>& recordFilter,
+                                 const Visitor& visitor) const {
+    std::size_t visited = 0;
+    for (const Segment& segment : segments_) {
+        if (!segmentFilter(segment)) {
+            continue;  // 段索引表明没有匹配记录
+        }
+        const SegmentHeader* h = segment.header();
+        const JournalRecord* records = segment.records();
+        for (std::uint64_t i = 0; i < segment.count; ++i) {
+            const std::uint64_t lsn = h->firstLsn + i;
+            if (records[i].commit != lsn + 1) {
+                continue;  // 已被更新一代的记录覆盖
+            }
+            if (recordFilter(records[i])) {
+                visitor(lsn, records[i]);
+                ++visited;
+            }
+        }
+    }
+    return visited;
+}
+
+std::size_t JournalReader::scan(const Visitor& visitor) const {
+    return visit([](const Segment&) { return true; }, [](const JournalRecord&) { return true; }, visitor);
+}
+
+std::size_t JournalReader::queryTimeRange(std::int64_t from, std::int64_t to, const Visitor& visitor) const {
+    return visit(
+        [from, to](const Segment& segment) {
+            return segment.header()->maxTimestamp >= from && segment.header()->minTimestamp < to;
+        },
+        [from, to](const JournalRecord& record) { return record.timestamp >= from && record.timestamp < to; },
+        visitor);
+}
+
+/**
+ * 查询单个阀门的记录
+ * 按段头的阀门范围跳过不相关的段；已写满并建立索引的段二分查找阀门的条目，
+ * 只访问该阀门的记录，尚未写满的段逐条扫描
+ */
+std::size_t JournalReader::queryValve(std::uint32_t valve, const Visitor& visitor) const {
+    std::size_t visited = 0;
+    for (const Segment& segment : segments_) {
+        const SegmentHeader* h = segment.header();
+        if (segment.count == 0 || valve < h->minValve || valve > h->maxValve) {
+            continue;  // 段头表明没有该阀门的记录
+        }
+        const JournalRecord* records = segment.records();
+        auto emit = [&](std::uint64_t i) {
+            const std::uint64_t lsn = h->firstLsn + i;
+            if (records[i].commit == lsn + 1 && records[i].valve == valve) {  // 跳过已被覆盖的记录
+                visitor(lsn, records[i]);
+                ++visited;
+            }
+        };
+        if (segment.indexCount == 0) {
+            for (std::uint64_t i = 0; i < segment.count; ++i) {
+                emit(i);
+            }
+            continue;
+        }
+        const ValveIndexEntry* begin = segment.index();
+        const ValveIndexEntry* end = begin + segment.indexCount;
+        const ValveIndexEntry* entry = std::lower_bound(
+            begin, end, valve, [](const ValveIndexEntry& e, std::uint32_t v) { return e.valve < v; });
+        for (; entry != end && entry->valve == valve; ++entry) {
+            if (entry->offset < segment.count) {  // 损坏的条目不越界
+                emit(entry->offset);
+            }
+        }
+    }
+    return visited;
+}
+
+/**
+ * 从日志重建控制器状态
+ * 状态更新规则与ValveController一致
+ * @param reader 已打开的日志读取器
+ * @param fleetSize 舰队阀门数量
+ * @return 各阀门的快照记录
+ */
+std::vector<ValveSnapshotRecord> replayJournal(const JournalReader& reader, std::size_t fleetSize) {
+    const std::uint8_t unknown = static_cast<std::uint8_t>(ValveStatus::UNKNOWN);
+    const std::uint8_t none = static_cast<std::uint8_t>(ValveCommand::NONE);
+    std::vector<ValveSnapshotRecord> state(fleetSize, ValveSnapshotRecord{unknown, unknown, none, 0, 0});
+
+    reader.scan([&](std::uint64_t, const JournalRecord& record) {
+        if (record.valve >= fleetSize) {
+            return;  // 超出舰队范围
+        }
+        ValveSnapshotRecord& valve = state[record.valve];
+        switch (static_cast<JournalEventKind>(record.kind)) {
+            case JournalEventKind::COMMAND:
+                valve.inflight = record.value;
+                valve.sequence = record.sequence;
+                break;
+            case JournalEventKind::STATUS: {
+                ValveStatus status = static_cast<ValveStatus>(record.value);
+                valve.status = record.value;
+                if (status == ValveStatus::OPENED || status == ValveStatus::CLOSED) {
+                    valve.lastConfirmed = record.value;
+                    valve.inflight = none;
+                } else if (status == ValveStatus::ERROR) {
+                    valve.inflight = none;
+                }
+                break;
+            }
+            default:
+                break;  // 否决记录不改变状态
+        }
+    });
+    return state;
+}
+
+} // namespace valve
@@ -0,0 +1,33 @@
+#include "../include/valve_profile.h"  // 包含阀门参数配置定义
+
+namespace valve {  // 阀门控制系统命名空间
+
+/**
+ * 定义或替换一个阀门类别
+ * @param name 类别名
+ * @param params 阀门参数
+ * @return 共享的配置，参数无效时返回nullptr
+ */
+std::shared_ptr<const ValveProfile> ValveClassCatalog::define(const std::string& name,
+                                                              const ValveParameters& params) {
+    if (validateParameters(params) != ParameterError::NONE) {
+        return nullptr;  // 无效参数不进入目录
+    }
+    auto profile = std::make_shared<const ValveProfile>(makeProfile(params));
+    std::lock_guard<std::mutex> lock(mutex_);
+    classes_[name] = profile;
+    return profile;
+}
+
+std::shared_ptr<const ValveProfile> ValveClassCatalog::find(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = classes_.find(name);
+    return it == classes_.end() ? nullptr : it->second;
+}
+
+std::size_t ValveClassCatalog::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return classes_.size();
+}
+
+} // namespace valve
@@ -0,0 +1,353 @@
+#include "../include/valve_recipe.h"  // 包含配方引擎定义
+
+namespace valve {  // 阀门控制系统命名空间
+
+/**
+ * 添加步骤
+ * @param valve 目标阀门索引
+ * @param action 执行的动作
+ * @param after 前置步骤编号
+ * @param timeout 动作超时时间
+ * @return 新步骤的编号
+ */
+std::uint32_t Recipe::addStep(std::uint32_t valve, ValveMove action,
+                              std::initializer_list<std::uint32_t> after,
+                              std::chrono::milliseconds timeout) {
+    steps_.push_back(RecipeStep{valve, action, after, timeout, nullptr});
+    return static_cast<std::uint32_t>(steps_.size() - 1);
+}
+
+/**
+ * 添加前置依赖
+ * @param step 步骤编号
+ * @param dependency 必须先完成的步骤编号
+ */
+void Recipe::addDependency(std::uint32_t step, std::uint32_t dependency) {
+    steps_[step].after.push_back(dependency);
+}
+
+/**
+ * 设置步骤的执行条件
+ * @param step 步骤编号
+ * @param condition 下发前求值的条件
+ */
+void Recipe::setCondition(std::uint32_t step, std::function<bool()> condition) {
+    steps_[step].condition = std::move(condition);
+}
+
+/**
+ * 检查配方是否可执行
+ * 使用拓扑排序检测依赖环
+ * @param fleetSize 引擎舰队中的阀门数量
+ * @return 配方是否有效
+ */
+bool Recipe::validate(std::size_t fleetSize) const {
+    const std::size_t n = steps_.size();
+    std::vector<std::uint32_t> indegree(n, 0);
+    std::vector<std::vector<std::uint32_t>> next(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (steps_[i].valve >= fleetSize) {
+            return false;  // 阀门索引越界
+        }
+        for (std::uint32_t dep : steps_[i].after) {
+            if (dep >= n || dep == i) {
+                return false;  // 依赖编号无效
+            }
+            next[dep].push_back(static_cast<std::uint32_t>(i));
+            ++indegree[i];
+        }
+    }
+
+    std::vector<std::uint32_t> ready;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (indegree[i] == 0) {
+            ready.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+    std::size_t visited = 0;
+    while (!ready.empty()) {
+        std::uint32_t step = ready.back();
+        ready.pop_back();
+        ++visited;
+        for (std::uint32_t succ : next[step]) {
+            if (--indegree[succ] == 0) {
+                ready.push_back(succ);
+            }
+        }
+    }
+    return visited == n;  // 有环时无法访问全部步骤
+}
+
+/**
+ * RecipeEngine构造函数
+ * 为舰队中的每个控制器注册状态观察者
+ * @param fleet 参与编排的控制器
+ */
+RecipeEngine::RecipeEngine(std::vector<ValveController*> fleet)
+    : fleet_(std::move(fleet)) {
+    observerTokens_.reserve(fleet_.size());
+    for (std::size_t i = 0; i < fleet_.size(); ++i) {
+        std::uint32_t valve = static_cast<std::uint32_t>(i);
+        observerTokens_.push_back(fleet_[i]->addStatusObserver([this, valve](ValveStatus status) {
+            onStatus(valve, status, runId_.load(std::memory_order_acquire));  // 在等锁之前标记所属执行
+        }));
+    }
+    activeStep_.assign(fleet_.size(), -1);
+    moving_.assign(fleet_.size(), 0);
+    valveQueue_.resize(fleet_.size());
+}
+
+/**
+ * RecipeEngine析构函数
+ * 移除注册的状态观察者
+ */
+RecipeEngine::~RecipeEngine() {
+    for (std::size_t i = 0; i < fleet_.size(); ++i) {
+        fleet_[i]->removeStatusObserver(observerTokens_[i]);
+    }
+}
+
+/**
+ * 执行配方并等待结束
+ * 调用线程下发无依赖的步骤后只负责超时检测，
+ * 后续步骤由完成回调所在线程直接下发
+ * @param recipe 待执行的配方
+ * @return 执行报告
+ */
+RecipeReport RecipeEngine::run(const Recipe& recipe) {
+    RecipeReport report;
+    if (!recipe.validate(fleet_.size())) {
+        return report;  // 配方无效
+    }
+
+    const auto& steps = recipe.steps();
+    const std::size_t n = steps.size();
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // 建立后继步骤的CSR索引
+    dependentIndex_.assign(n + 1, 0);
+    for (const auto& step : steps) {
+        for (std::uint32_t dep : step.after) {
+            ++dependentIndex_[dep + 1];
+        }
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        dependentIndex_[i + 1] += dependentIndex_[i];
+    }
+    dependents_.assign(dependentIndex_[n], 0);
+    std::vector<std::uint32_t> fill(dependentIndex_.begin(), dependentIndex_.end() - 1);
+    waiting_.assign(n, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::uint32_t dep : steps[i].after) {
+            dependents_[fill[dep]++] = static_cast<std::uint32_t>(i);
+        }
+        waiting_[i] = static_cast<std::uint32_t>(steps[i].after.size());
+    }
+
+    recipe_ = &recipe;
+    reports_.assign(n, StepReport{});
+    issueQueue_.clear();
+    issueQueue_.reserve(n);
+    deadlines_ = decltype(deadlines_)();
+    remaining_ = n;
+    failed_ = false;
+    runId_.fetch_add(1, std::memory_order_acq_rel);  // 之前执行遗留的完成事件不再匹配
+    start_ = Clock::now();
+
+    // 下发所有无依赖的步骤
+    for (std::size_t i = 0; i < n; ++i) {
+        if (waiting_[i] == 0) {
+            makeReady(static_cast<std::uint32_t>(i));
+        }
+    }
+    drain(lock);
+
+    // 等待结束，期间按最早截止时间检测超时
+    while (remaining_ > 0 && !failed_) {
+        if (deadlines_.empty()) {
+            done_.wait(lock);
+            continue;
+        }
+        Deadline next = deadlines_.top();
+        if (done_.wait_until(lock, next.first) == std::cv_status::timeout || Clock::now() >= next.first) {
+            Clock::time_point now = Clock::now();
+            while (!deadlines_.empty() && deadlines_.top().first <= now) {
+                std::uint32_t step = deadlines_.top().second;
+                deadlines_.pop();
+                if (reports_[step].outcome == StepOutcome::RUNNING) {
+                    finishStep(step, StepOutcome::TIMED_OUT);  // 超时未确认
+                }
+            }
+        }
+    }
+
+    // 等待其他线程的下发循环退出后再清理状态
+    done_.wait(lock, [this] { return !draining_; });
+
+    report.success = !failed_;
+    report.totalNs = elapsed();
+    for (const auto& step : reports_) {
+        if (step.issuedAt >= 0) {
+            report.orchestrationNs += step.issuedAt - step.readyAt;
+        }
+    }
+    report.steps = std::move(reports_);
+
+    recipe_ = nullptr;
+    activeStep_.assign(fleet_.size(), -1);
+    for (auto& queue : valveQueue_) {
+        queue.clear();
+    }
+    return report;
+}
+
+/**
+ * 处理阀门状态变化
+ * 步骤下发后阀门先报告移动中，之后到达目标状态即确认步骤，
+ * 报告错误或到达相反状态即失败；移动中之前的终点状态属于更早的命令，忽略
+ * @param valve 阀门索引
+ * @param status 新状态
+ * @param run 事件到达时的执行编号
+ */
+void RecipeEngine::onStatus(std::uint32_t valve, ValveStatus status, std::uint64_t run) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!recipe_ || failed_ || run != runId_.load(std::memory_order_relaxed) || activeStep_[valve] < 0) {
+        return;  // 没有等待该阀门的步骤，或事件属于之前的执行
+    }
+    std::uint32_t step = static_cast<std::uint32_t>(activeStep_[valve]);
+    if (reports_[step].outcome != StepOutcome::RUNNING) {
+        return;  // 步骤尚未下发
+    }
+
+    ValveStatus expected = (recipe_->steps()[step].action == ValveMove::OPEN)
+                               ? ValveStatus::OPENED : ValveStatus::CLOSED;
+    if (status == ValveStatus::MOVING) {
+        moving_[valve] = 1;  // 本步骤的命令已被驱动层接受
+        return;
+    } else if (status == ValveStatus::ERROR) {
+        finishStep(step, StepOutcome::FAILED);
+    } else if (!moving_[valve]) {
+        return;  // 更早命令的完成
+    } else if (status == expected) {
+        finishStep(step, StepOutcome::CONFIRMED);
+    } else if (status == ValveStatus::OPENED || status == ValveStatus::CLOSED) {
+        finishStep(step, StepOutcome::FAILED);  // 到达相反状态，不必等到超时
+    } else {
+        return;  // 未知等中间状态
+    }
+    drain(lock);
+}
+
+void RecipeEngine::finishStep(std::uint32_t step, StepOutcome outcome) {
+    reports_[step].outcome = outcome;
+    reports_[step].finishedAt = elapsed();
+    --remaining_;
+
+    // 释放阀门，启动该阀门上排队的下一个步骤
+    std::uint32_t valve = recipe_->steps()[step].valve;
+    activeStep_[valve] = -1;
+    auto& queue = valveQueue_[valve];
+    if (!queue.empty()) {
+        std::uint32_t next = queue.front();
+        queue.erase(queue.begin());
+        activeStep_[valve] = next;
+        reports_[next].readyAt = elapsed();  // 排队等阀门的时间不计入编排开销
+        issueQueue_.push_back(next);
+    }
+
+    if (outcome != StepOutcome::CONFIRMED && outcome != StepOutcome::SKIPPED) {
+        abort();
+        return;
+    }
+
+    for (std::uint32_t i = dependentIndex_[step]; i < dependentIndex_[step + 1]; ++i) {
+        std::uint32_t succ = dependents_[i];
+        if (--waiting_[succ] == 0) {
+            makeReady(succ);
+        }
+    }
+    if (remaining_ == 0) {
+        done_.notify_all();  // 所有步骤已结束
+    }
+}
+
+void RecipeEngine::makeReady(std::uint32_t step) {
+    std::uint32_t valve = recipe_->steps()[step].valve;
+    if (activeStep_[valve] >= 0) {
+        valveQueue_[valve].push_back(step);  // 阀门忙，排队等待
+        return;
+    }
+    activeStep_[valve] = step;
+    reports_[step].readyAt = elapsed();
+    issueQueue_.push_back(step);
+}
+
+void RecipeEngine::drain(std::unique_lock<std::mutex>& lock) {
+    if (draining_) {
+        return;  // 其他线程正在下发，由它处理新入队的步骤
+    }
+    draining_ = true;
+    while (!issueQueue_.empty() && !failed_) {
+        std::uint32_t step = issueQueue_.back();
+        issueQueue_.pop_back();
+        const RecipeStep& spec = recipe_->steps()[step];
+
+        // 条件和控制器调用都在锁外执行，允许同步完成的回调重入
+        lock.unlock();
+        bool runStep = !spec.condition || spec.condition();
+        lock.lock();
+        if (failed_) {
+            break;
+        }
+        if (!runStep) {
+            finishStep(step, StepOutcome::SKIPPED);
+            continue;
+        }
+
+        reports_[step].outcome = StepOutcome::RUNNING;
+        reports_[step].issuedAt = elapsed();
+        moving_[spec.valve] = 0;
+        Clock::time_point deadline = Clock::now() + spec.timeout;
+        bool earliest = deadlines_.empty() || deadline < deadlines_.top().first;
+        deadlines_.emplace(deadline, step);
+        if (earliest) {
+            done_.notify_all();  // 唤醒执行线程更新等待时间
+        }
+
+        ValveController* controller = fleet_[spec.valve];
+        lock.unlock();
+        const std::uint32_t sequence = controller->commandSequence();
+        if (spec.action == ValveMove::OPEN) {
+            controller->open();
+        } else {
+            controller->close();
+        }
+        const bool vetoed = controller->commandSequence() == sequence;  // 联锁否决的命令不增加序号
+        lock.lock();
+        if (vetoed && !failed_ && reports_[step].outcome == StepOutcome::RUNNING) {
+            finishStep(step, StepOutcome::FAILED);  // 不会有状态变化，立即失败
+        }
+    }
+    draining_ = false;
+    done_.notify_all();
+}
+
+void RecipeEngine::abort() {
+    failed_ = true;
+    std::int64_t now = elapsed();
+    for (auto& step : reports_) {
+        if (step.outcome == StepOutcome::PENDING || step.outcome == StepOutcome::RUNNING) {
+            step.outcome = StepOutcome::CANCELLED;
+            step.finishedAt = now;
+        }
+    }
+    remaining_ = 0;
+    issueQueue_.clear();
+    done_.notify_all();
+}
+
+std::int64_t RecipeEngine::elapsed() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_).count();
+}
+
+} // namespace valve
@@ -0,0 +1,302 @@
+#include "../include/valve_snapshot.h"    // 包含快照定义
+#include "../include/valve_controller.h"  // 包含控制器接口定义
+#include "../include/valve_codec.h"       // 包含紧凑编码定义
+#include <cstdio>   // rename支持
+#include <cstring>  // 内存操作
+
+#ifdef _WIN32
+#include <fstream>  // Windows下使用文件流读写
+#else
+#include <fcntl.h>     // open
+#include <sys/mman.h>  // mmap
+#include <sys/stat.h>  // fstat
+#include <unistd.h>    // close, ftruncate
+#endif
+
+namespace valve {  // 阀门控制系统命名空间
+
+namespace {  // 内部实现细节
+
+constexpr std::uint32_t kSnapshotMagic = 0x504E5356;  // "VSNP"小端存放
+constexpr std::uint32_t kSnapshotVersion = 2;         // 当前格式版本：命令字加状态位图
+
+/**
+ * 记录区布局
+ * count个命令字(按8字节对齐)，随后是状态位图和最后确认状态位图
+ */
+struct Layout {
+    std::size_t commandBytes;  // 命令字区长度
+    std::size_t bitmapWords;   // 每个位图的字数
+    std::size_t payload;       // 记录区总长度，8字节的整数倍
+
+    explicit Layout(std::size_t count)
+        : commandBytes((count * sizeof(std::uint32_t) + 7) / 8 * 8),
+          bitmapWords(statusBitmapWords(count)),
+          payload(commandBytes + 2 * bitmapWords * sizeof(std::uint64_t)) {}
+};
+
+/**
+ * 计算记录区校验和
+ * 按8字节字处理，百万级阀门也只需很少时间
+ */
+std::uint32_t checksum(const std::uint8_t* data, std::size_t bytes) {
+    std::uint64_t h = 0x9E3779B97F4A7C15ull;
+    for (std::size_t i = 0; i + 8 <= bytes; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        h = (h ^ word) * 0x100000001B3ull;
+        h ^= h >> 29;
+    }
+    return static_cast<std::uint32_t>(h ^ (h >> 32));
+}
+
+/**
+ * 填充文件头和记录区
+ */
+void fill(std::uint8_t* base, const std::vector<ValveController*>& fleet) {
+    const std::size_t n = fleet.size();
+    const Layout layout(n);
+    std::uint8_t* payload = base + sizeof(ValveSnapshotHeader);
+    std::vector<std::uint32_t> commands(layout.commandBytes / sizeof(std::uint32_t), 0);
+    std::vector<ValveStatus> status(n);
+    std::vector<ValveStatus> confirmed(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        ValveSnapshotRecord record = fleet[i]->snapshot();
+        commands[i] = encodeCommand(static_cast<ValveCommand>(record.inflight), record.sequence);
+        status[i] = static_cast<ValveStatus>(record.status);
+        confirmed[i] = static_cast<ValveStatus>(record.lastConfirmed);
+    }
+    std::memcpy(payload, commands.data(), layout.commandBytes);
+    std::vector<std::uint64_t> planes(2 * layout.bitmapWords);
+    encodeStatusBitmap(status.data(), n, planes.data());
+    encodeStatusBitmap(confirmed.data(), n, planes.data() + layout.bitmapWords);
+    std::memcpy(payload + layout.commandBytes, planes.data(), planes.size() * sizeof(std::uint64_t));
+
+    ValveSnapshotHeader header{};
+    header.magic = kSnapshotMagic;
+    header.version = kSnapshotVersion;
+    header.count = n;
+    header.savedAt = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    header.checksum = checksum(payload, layout.payload);
+    std::memcpy(base, &header, sizeof(header));
+}
+
+/**
+ * 校验并恢复
+ */
+std::size_t restore(const std::uint8_t* base, std::size_t size, const std::vector<ValveController*>& fleet) {
+    if (size < sizeof(ValveSnapshotHeader)) {
+        return 0;  // 文件过短
+    }
+    ValveSnapshotHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (header.magic != kSnapshotMagic || header.version != kSnapshotVersion) {
+        return 0;  // 格式不符
+    }
+    // 每个阀门至少占一个命令字，先按文件长度限制记录数，避免计算布局时溢出
+    if (header.count > (size - sizeof(header)) / sizeof(std::uint32_t)) {
+        return 0;  // 记录数与长度不符
+    }
+    const Layout layout(static_cast<std::size_t>(header.count));
+    if (size != sizeof(header) + layout.payload) {
+        return 0;  // 长度不符
+    }
+    const std::uint8_t* payload = base + sizeof(header);
+    if (checksum(payload, layout.payload) != header.checksum) {
+        return 0;  // 内容损坏
+    }
+
+    std::vector<std::uint32_t> commands(header.count);
+    std::memcpy(commands.data(), payload, header.count * sizeof(std::uint32_t));
+    std::vector<std::uint64_t> planes(2 * layout.bitmapWords);
+    std::memcpy(planes.data(), payload + layout.commandBytes, planes.size() * sizeof(std::uint64_t));
+    std::vector<ValveStatus> status(header.count);
+    std::vector<ValveStatus> confirmed(header.count);
+    decodeStatusBitmap(planes.data(), header.count, status.data());
+    decodeStatusBitmap(planes.data() + layout.bitmapWords, header.count, confirmed.data());
+
+    const std::size_t n = header.count < fleet.size() ? header.count : fleet.size();
+    for (std::size_t i = 0; i < n; ++i) {
+        ValveSnapshotRecord record{};
+        record.status = static_cast<std::uint8_t>(status[i]);
+        record.lastConfirmed = static_cast<std::uint8_t>(confirmed[i]);
+        record.inflight = static_cast<std::uint8_t>(commandOf(commands[i]));
+        record.sequence = sequenceOf(commands[i]);
+        fleet[i]->restore(record);
+    }
+    return n;
+}
+
+} // namespace
+
+/**
+ * 写入舰队快照
+ * POSIX平台通过mmap直接在页缓存中填充记录
+ * @param path 快照文件路径
+ * @param fleet 控制器数组
+ * @return 是否写入成功
+ */
+bool saveSnapshot(const std::string& path, const std::vector<ValveController*>& fleet) {
+    const std::string temp = path + ".tmp";
+    const std::size_t size = sizeof(ValveSnapshotHeader) + Layout(fleet.size()).payload;
+
+#ifdef _WIN32
+    std::vector<std::uint8_t> buffer(size);
+    fill(buffer.data(), fleet);
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(size))) {
+            return false;
+        }
+    }
+    std::remove(path.c_str());  // Windows下rename不覆盖已有文件
+#else
+    int fd = ::open(temp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        ::close(fd);
+        return false;
+    }
+    void* map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    fill(static_cast<std::uint8_t*>(map), fleet);
+    bool synced = ::msync(map, size, MS_SYNC) == 0;  // 落盘后再替换旧文件
+    ::munmap(map, size);
+    ::close(fd);
+    if (!synced) {
+        return false;
+    }
+#endif
+    return std::rename(temp.c_str(), path.c_str()) == 0;  // 原子替换
+}
+
+/**
+ * 读取快照并恢复舰队状态
+ * @param path 快照文件路径
+ * @param fleet 控制器数组
+ * @return 恢复的控制器数量
+ */
+std::size_t loadSnapshot(const std::string& path, const std::vector<ValveController*>& fleet) {
+#ifdef _WIN32
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return 0;
+    }
+    std::vector<std::uint8_t> buffer(static_cast<std::size_t>(in.tellg()));
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()))) {
+        return 0;
+    }
+    return restore(buffer.data(), buffer.size(), fleet);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return 0;
+    }
+    const std::size_t size = static_cast<std::size_t>(st.st_size);
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        return 0;
+    }
+    ::madvise(map, size, MADV_SEQUENTIAL);  // 顺序读取
+    std::size_t restored = restore(static_cast<const std::uint8_t*>(map), size, fleet);
+    ::munmap(map, size);
+    return restored;
+#endif
+}
+
+/**
+ * 用硬件状态校正整个舰队
+ * @param fleet 控制器数组
+ * @param bulk 批量硬件接口，可为nullptr
+ * @return 处于明确终点状态的阀门数量
+ */
+std::size_t reconcileFleet(const std::vector<ValveController*>& fleet, const IBulkValveHAL* bulk) {
+    std::vector<ValveStatus> hardware(fleet.size(), ValveStatus::UNKNOWN);
+    if (bulk) {
+        std::size_t count = fleet.size() < bulk->channelCount() ? fleet.size() : bulk->channelCount();
+        bulk->readStatus(0, count, hardware.data());  // 一次批量读取
+    } else {
+        for (std::size_t i = 0; i < fleet.size(); ++i) {
+            hardware[i] = fleet[i]->hardwareStatus();  // 逐个读取
+        }
+    }
+
+    std::size_t settled = 0;
+    for (std::size_t i = 0; i < fleet.size(); ++i) {
+        ValveStatus status = fleet[i]->reconcile(hardware[i]);
+        settled += (status == ValveStatus::OPENED || status == ValveStatus::CLOSED);
+    }
+    return settled;
+}
+
+/**
+ * SnapshotScheduler构造函数
+ * @param path 快照文件路径
+ * @param fleet 控制器数组
+ */
+SnapshotScheduler::SnapshotScheduler(std::string path, std::vector<ValveController*> fleet)
+    : path_(std::move(path)), fleet_(std::move(fleet)) {
+}
+
+/**
+ * SnapshotScheduler析构函数
+ * 停止后台线程并写入最后一次快照
+ */
+SnapshotScheduler::~SnapshotScheduler() {
+    stop();
+}
+
+void SnapshotScheduler::start(std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        return;  // 已在运行
+    }
+    running_ = true;
+    worker_ = std::thread([this, interval]() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (running_) {
+            if (wake_.wait_for(lock, interval, [this] { return !running_; })) {
+                break;  // 收到停止请求
+            }
+            lock.unlock();
+            saveNow();
+            lock.lock();
+        }
+    });
+}
+
+void SnapshotScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    wake_.notify_all();
+    worker_.join();
+    saveNow();  // 关机前保存最终状态
+}
+
+bool SnapshotScheduler::saveNow() {
+    bool ok = saveSnapshot(path_, fleet_);
+    if (ok) {
+        ++saved_;
+    }
+    return ok;
+}
+
+} // namespace valve